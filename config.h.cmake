@@ -50,9 +50,18 @@
 /* Define to 1 if you have the <curses.h> header file. */
 #cmakedefine HAVE_CURSES_H 1
 
+/* Define to 1 if you have the `fork' function. */
+#cmakedefine HAVE_FORK 1
+
 /* Define to 1 if you have the `gettimeofday' function. */
 #cmakedefine HAVE_GETTIMEOFDAY 1
 
+/* Define to 1 if you have the `clock_gettime' function. */
+#cmakedefine HAVE_CLOCK_GETTIME 1
+
+/* Define to 1 if you have the `getrusage' function. */
+#cmakedefine HAVE_GETRUSAGE 1
+
 /* Define to 1 if you have the <glib.h> header file. */
 #cmakedefine HAVE_GLIB_H 1
 
@@ -65,6 +74,12 @@
 /* Define to 1 if you have the <ncurses/term.h> header file. */
 #cmakedefine HAVE_NCURSES_TERM_H 1
 
+/* Define to 1 if you have the `select' function. */
+#cmakedefine HAVE_SELECT 1
+
+/* Define to 1 if you have the <sys/mman.h> header file. */
+#cmakedefine HAVE_SYS_MMAN_H 1
+
 /* Define to 1 if you have the <sys/times.h> header file. */
 #cmakedefine HAVE_SYS_TIMES_H 1
 
@@ -118,15 +133,35 @@
 
 #cmakedefine CONFIG_DISABLE_MONTE_CARLO 1
 
+/* Define to 1 to allocate all engine memory from fixed pools. */
+#cmakedefine CONFIG_FIXED_MEMORY 1
+
 #cmakedefine FIXED_BOARD_SIZE ${FIXED_BOARD_SIZE}
 
+/* Define to 1 to count the accesses to the engine tables, see
+ * engine/placement.c. Host builds only.
+ */
+#cmakedefine PROFILE_PLACEMENT 1
+
 #ifdef ESP_PLATFORM
 #include "esp_attr.h"
 #ifdef CONFIG_USE_ESP_RANDOM
 #include "esp_random.h"
 #endif
 #undef HAVE_TIMES
+#undef HAVE_SYS_MMAN_H
+#undef HAVE_FORK
+#undef HAVE_SELECT
+#undef HAVE_GETRUSAGE
 #define _EMBEDDED_BSS EXT_RAM_BSS_ATTR
+/* The tables measured hottest per byte, see engine/placement.c. */
+#ifdef CONFIG_HOT_TABLES_INTERNAL
+#define _EMBEDDED_HOT
+#define _EMBEDDED_HOT_CONST DRAM_ATTR
+#else
+#define _EMBEDDED_HOT EXT_RAM_BSS_ATTR
+#define _EMBEDDED_HOT_CONST
+#endif
 #ifdef CONFIG_USE_TCM
 #define _EMBEDDED_TCM TCM_IRAM_ATTR
 #else
@@ -134,7 +169,14 @@
 #endif
 #define DEFAULT_LEVEL 0
 #else
+#ifdef PROFILE_PLACEMENT
+#define _EMBEDDED_BSS __attribute__((section("gg_psram")))
+#define _EMBEDDED_HOT_CONST __attribute__((section("gg_dram")))
+#else
 #define _EMBEDDED_BSS
+#define _EMBEDDED_HOT_CONST
+#endif
+#define _EMBEDDED_HOT
 #define _EMBEDDED_TCM
 /* Default level (strength). Up to 10 supported */
 #define DEFAULT_LEVEL 0
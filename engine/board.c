@@ -138,8 +138,8 @@ struct vertex_stack_entry {
 
 
 /* Main array of string information. */
-static struct string_data _EMBEDDED_BSS_SMALL string[MAX_STRINGS];
-static struct string_liberties_data _EMBEDDED_BSS string_libs[MAX_STRINGS];
+static struct string_data _EMBEDDED_HOT string[MAX_STRINGS];
+static struct string_liberties_data _EMBEDDED_HOT string_libs[MAX_STRINGS];
 static struct string_neighbors_data _EMBEDDED_BSS string_neighbors[MAX_STRINGS];
 
 /* Stacks and stack pointers. */
@@ -153,13 +153,13 @@ static struct vertex_stack_entry *vertex_stack_pointer;
 /* Index into list of strings. The index is only valid if there is a
  * stone at the vertex.
  */
-static int _EMBEDDED_BSS_SMALL string_number[BOARDMAX];
+static int _EMBEDDED_HOT string_number[BOARDMAX];
 
 
 /* The stones in a string are linked together in a cyclic list. 
  * These are the coordinates to the next stone in the string.
  */
-static int _EMBEDDED_BSS next_stone[BOARDMAX];
+static int _EMBEDDED_HOT next_stone[BOARDMAX];
 
 
 /* ---------------------------------------------------------------- */
@@ -658,6 +658,12 @@ do_trymove(int pos, int color, int ignore_ko)
 {
   /* 1. The color must be BLACK or WHITE. */
   gg_assert(color == BLACK || color == WHITE);
+
+  /* The hook may leave the search by a longjmp(), so it must come
+   * before anything is changed.
+   */
+  if (trymove_hook)
+    trymove_hook();
  
   if (pos != PASS_MOVE) {
     /* 2. Unless pass, the move must be inside the board. */
@@ -665,6 +671,7 @@ do_trymove(int pos, int color, int ignore_ko)
     
     /* Update the reading tree shadow. */
     shadow[pos] = 1;
+    shadow_stamp[pos] = ++shadow_clock;
 
     /* 3. The location must be empty. */
     if (board[pos] != EMPTY)
@@ -915,6 +922,7 @@ replay_move_history(int n)
   board_ko_pos = initial_board_ko_pos;
   white_captured = initial_white_captured;
   black_captured = initial_black_captured;
+  hashdata_recalc(&board_hash, board, board_ko_pos);
   new_position();
 
   for (k = 0; k < n; k++)
@@ -1782,7 +1790,7 @@ struct board_cache_entry {
 
 
 /* approxlib() cache. */
-static struct board_cache_entry _EMBEDDED_BSS approxlib_cache[BOARDMAX][2];
+static struct board_cache_entry _EMBEDDED_HOT approxlib_cache[BOARDMAX][2];
 
 
 /* Clears approxlib() cache. This function should be called only once
@@ -2074,7 +2082,7 @@ slow_approxlib(int pos, int color, int maxlib, int *libs)
 
 
 /* accuratelib() cache. */
-static struct board_cache_entry _EMBEDDED_BSS accuratelib_cache[BOARDMAX][2];
+static struct board_cache_entry _EMBEDDED_HOT accuratelib_cache[BOARDMAX][2];
 
 
 /* Clears accuratelib() cache. This function should be called only once
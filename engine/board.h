@@ -209,6 +209,8 @@ extern int          handicap;     /* used internally in chinese scoring */
 extern int          movenum;      /* movenumber - used for debug output */
 		    
 extern signed char  shadow[BOARDMAX];      /* reading tree shadow */
+extern unsigned int shadow_stamp[BOARDMAX]; /* shadow_clock when shadowed */
+extern unsigned int shadow_clock;           /* counts shadowed points */
 
 enum suicide_rules {
   FORBIDDEN,
@@ -229,6 +231,7 @@ extern enum ko_rules ko_rule;
 extern int stackp;                /* stack pointer */
 extern int count_variations;      /* count (decidestring) */
 extern SGFTree *sgf_dumptree;
+extern void (*trymove_hook)(void); /* called by every trymove() if set */
 
 
 /* This struct holds the internal board state. */
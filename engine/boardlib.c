@@ -51,6 +51,8 @@ enum ko_rules ko_rule = SIMPLE;
 
 
 signed char shadow[BOARDMAX];
+unsigned int _EMBEDDED_HOT shadow_stamp[BOARDMAX];
+unsigned int shadow_clock;
 
 /* Hashing of positions. */
 Hash_data board_hash;
@@ -64,3 +66,8 @@ struct stats_data stats;
 /* Variation tracking in SGF trees: */
 int count_variations  = 0;
 SGFTree *sgf_dumptree = NULL;
+
+/* Called before each trymove() while set, e.g. to abandon a search
+ * when pondering (see ponder.c).
+ */
+void (*trymove_hook)(void) = NULL;
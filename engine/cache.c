@@ -30,9 +30,15 @@
 #include <limits.h>
 #include <string.h>
 
+#if defined(HAVE_FORK) && defined(HAVE_SYS_MMAN_H)
+#define SHARED_TTABLE 1
+#include <sys/mman.h>
+#endif
+
 #include "liberty.h"
 #include "cache.h"
 #include "sgftree.h"
+#include "gg_utils.h"
 
 
 /* ================================================================ */
@@ -41,6 +47,7 @@
 
 static void tt_init(Transposition_table *table, int memsize);
 static void tt_clear(Transposition_table *table);
+static void tt_release(Transposition_table *table);
 
 /* The transposition table itself. */
 Transposition_table ttable;
@@ -85,7 +92,8 @@ calculate_hashval_for_tt(Hash_data *hashdata, int routine, int target1,
 
 
 /* Initialize the transposition table. Non-positive memsize means use
- * the default size of DEFAULT_NUMBER_OF_CACHE_ENTRIES entries.
+ * the default size of DEFAULT_NUMBER_OF_CACHE_ENTRIES entries. With
+ * CONFIG_FIXED_MEMORY the table fills its pool, whatever the size.
  */
 
 static void
@@ -97,13 +105,21 @@ tt_init(Transposition_table *table, int memsize)
   hash_init();
   keyhash_init();
 
+  /* The table may be initialized again. */
+  tt_release(table);
+
+#ifdef CONFIG_FIXED_MEMORY
+  memsize = mempool_largest_block(POOL_READING_CACHE);
+#endif
+
   if (memsize > 0)
     num_entries = memsize / sizeof(table->entries[0]);
   else
     num_entries = DEFAULT_NUMBER_OF_CACHE_ENTRIES;
 
   table->num_entries = num_entries;
-  table->entries     = malloc(num_entries * sizeof(table->entries[0]));
+  table->entries     = pool_malloc(POOL_READING_CACHE,
+				   num_entries * sizeof(table->entries[0]));
 
   if (table->entries == NULL) {
     perror("Couldn't allocate memory for transposition table. \n");
@@ -132,7 +148,88 @@ tt_clear(Transposition_table *table)
 void
 tt_free(Transposition_table *table)
 {
-  free(table->entries);
+  tt_release(table);
+}
+
+
+/* Give the memory of the table back. */
+
+static void
+tt_release(Transposition_table *table)
+{
+#ifdef SHARED_TTABLE
+  if (table->is_shared) {
+    munmap(table->entries, table->num_entries * sizeof(table->entries[0]));
+    table->entries = NULL;
+    table->is_shared = 0;
+    return;
+  }
+#endif
+  pool_free(table->entries);
+  table->entries = NULL;
+}
+
+
+/* Move the table to memory which is shared with the processes forked
+ * afterwards, so that worker processes (see parallel.c) use each
+ * other's results. They write to the table without locking; a node
+ * torn by two processes writing it at once fails the check of the
+ * key in tt_get(), see the comment about Hashnode in cache.h. If no
+ * shared memory can be had, the workers use private copies of the
+ * table as before.
+ */
+
+void
+tt_share(Transposition_table *table)
+{
+#ifdef SHARED_TTABLE
+  size_t size = table->num_entries * sizeof(table->entries[0]);
+  Hashentry *entries;
+
+  /* The workers may change the table behind our back. */
+  table->is_clean = 0;
+
+  if (table->is_shared || table->entries == NULL)
+    return;
+
+  entries = mmap(NULL, size, PROT_READ | PROT_WRITE,
+		 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (entries == MAP_FAILED)
+    return;
+
+  memcpy(entries, table->entries, size);
+  pool_free(table->entries);
+  table->entries = entries;
+  table->is_shared = 1;
+#else
+  UNUSED(table);
+#endif
+}
+
+
+/* Store a node. The key is stored xor'ed with the data. */
+
+static void
+hn_store(Hashnode *node, Hash_data *hashval, unsigned int data)
+{
+  Hashnode new_node;
+
+  new_node.key = *hashval;
+  new_node.key.hashval[0] ^= data;
+  new_node.data = data;
+  *node = new_node;
+}
+
+
+/* Does the node hold the result for hashval? */
+
+static int
+hn_matches(const Hashnode *node, Hash_data *hashval)
+{
+  Hash_data key = node->key;
+
+  key.hashval[0] ^= node->data;
+  return hashdata_is_equal(key, *hashval);
 }
 
 
@@ -152,7 +249,7 @@ tt_get(Transposition_table *table,
 {
   Hash_data hashval;
   Hashentry *entry;
-  Hashnode *node;
+  Hashnode node;
  
   /* Sanity check. */
   if (remaining_depth < 0 || remaining_depth > HN_MAX_REMAINING_DEPTH)
@@ -161,14 +258,16 @@ tt_get(Transposition_table *table,
   /* Get the combined hash value. */
   calculate_hashval_for_tt(&hashval, routine, target1, target2, extra_hash);
 
-  /* Get the correct entry and node. */
+  /* Get the correct entry and node. The node is copied, since a
+   * worker process may overwrite it meanwhile.
+   */
   entry = &table->entries[hashdata_remainder(hashval, table->num_entries)];
-  if (hashdata_is_equal(hashval, entry->deepest.key))
-    node = &entry->deepest;
-  else if (hashdata_is_equal(hashval, entry->newest.key))
-    node = &entry->newest;
-  else
-    return 0;
+  node = entry->deepest;
+  if (!hn_matches(&node, &hashval)) {
+    node = entry->newest;
+    if (!hn_matches(&node, &hashval))
+      return 0;
+  }
 
   stats.read_result_hits++;
 
@@ -177,12 +276,12 @@ tt_get(Transposition_table *table,
    * ordering if nothing else.
    */
   if (move)
-    *move = hn_get_move(node->data);
-  if (remaining_depth <= (int) hn_get_remaining_depth(node->data)) {
+    *move = hn_get_move(node.data);
+  if (remaining_depth <= (int) hn_get_remaining_depth(node.data)) {
     if (value1)
-      *value1 = hn_get_value1(node->data);
+      *value1 = hn_get_value1(node.data);
     if (value2)
-      *value2 = hn_get_value2(node->data);
+      *value2 = hn_get_value2(node.data);
     stats.trusted_read_result_hits++;
     return 2;
   }
@@ -225,18 +324,18 @@ tt_update(Transposition_table *table,
   newest  = &entry->newest;
  
   /* See if we found an already existing node. */
-  if (hashdata_is_equal(hashval, deepest->key)
+  if (hn_matches(deepest, &hashval)
       && remaining_depth >= (int) hn_get_remaining_depth(deepest->data)) {
 
     /* Found deepest */
-    deepest->data = data;
+    hn_store(deepest, &hashval, data);
 
   }
-  else if (hashdata_is_equal(hashval, newest->key)
+  else if (hn_matches(newest, &hashval)
            && remaining_depth >= (int) hn_get_remaining_depth(newest->data)) {
 
     /* Found newest */
-    newest->data = data;
+    hn_store(newest, &hashval, data);
 
     /* If newest has become deeper than deepest, then switch them. */
     if (hn_get_remaining_depth(newest->data)
@@ -252,13 +351,11 @@ tt_update(Transposition_table *table,
   else if (hn_get_total_cost(data) > hn_get_total_cost(deepest->data)) {
     if (hn_get_total_cost(newest->data) < hn_get_total_cost(deepest->data))
       *newest = *deepest;
-    deepest->key  = hashval;
-    deepest->data = data;
+    hn_store(deepest, &hashval, data);
   } 
   else {
     /* Replace newest. */
-    newest->key  = hashval;
-    newest->data = data;
+    hn_store(newest, &hashval, data);
   }
 
   stats.read_result_entered++;
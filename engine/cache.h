@@ -56,6 +56,10 @@
  *   remaining_depth:  5 bits (depth - stackp)  NOTE: HN_MAX_REMAINING_DEPTH
  *
  *   The last 9 bits together give an index for the total costs.
+ *
+ * The key is stored xor'ed with the data, so that a node which is half
+ * written by one process while another one reads it doesn't match any
+ * position (see tt_share()).
  */
 typedef struct {
   Hash_data key;
@@ -93,6 +97,7 @@ typedef struct {
   unsigned int num_entries;
   Hashentry *entries;
   int is_clean;
+  int is_shared; /* Entries are shared with worker processes. */
 } Transposition_table;
 
 extern Transposition_table ttable;
@@ -103,6 +108,7 @@ extern Transposition_table ttable;
 #define DEFAULT_NUMBER_OF_CACHE_ENTRIES 350000
 
 void tt_free(Transposition_table *table);
+void tt_share(Transposition_table *table);
 int  tt_get(Transposition_table *table, enum routine_id routine,
 	    int target1, int target2, int remaining_depth,
 	    Hash_data *extra_hash,
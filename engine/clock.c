@@ -40,6 +40,8 @@
 #include "gg_utils.h"
 #include "board.h"
 
+#include <math.h>
+
 /* Level data */
 static int level             = DEFAULT_LEVEL; /* current level */
 static int level_offset      = 0;
@@ -274,6 +276,187 @@ clock_push_button(int color)
 /**********************/
 
 
+/* The autolevel system learns how long our moves take at each level.
+ * The time of a move is modeled as the number of reading, owl and
+ * connection nodes it needs, times the time per node. The latter
+ * depends on the machine and is much the same at all levels. The
+ * logarithm of the number of nodes is modeled as a base, which depends
+ * on the kind of position, plus the level times the logarithm of a
+ * growth factor. For each class of positions (opening, middle game,
+ * endgame) the base is a moving average over the moves of the genmove
+ * trace (see utils.c), so it follows the positions of the game.
+ *
+ * The growth factor is estimated from averages kept for each class
+ * and level. Differences between positions are much larger than
+ * between neighboring levels though, so it takes many moves until the
+ * measurements outweigh the default. For the same reason the expected
+ * time takes the variance of the number of nodes into account.
+ *
+ * What has been learned is kept from one game to the next.
+ */
+#define NUM_POSITION_CLASSES  3
+#define MAX_MODEL_LEVEL       20
+/* Moves with fewer nodes, e.g. from the fuseki database, tell nothing. */
+#define MIN_MODEL_NODES       1000
+#define COST_AVERAGING        0.3  /* Weight of a new measurement. */
+#define DEFAULT_LEVEL_GROWTH  1.4
+/* Variance of the logarithm of the default growth. */
+#define PRIOR_GROWTH_VARIANCE 0.02
+/* A moving average counts as at most this many measurements. */
+#define MAX_EFFECTIVE_SAMPLES 6
+#define MIN_LEVEL_GROWTH      1.05
+#define MAX_LEVEL_GROWTH      3.0
+/* Part of the time available per move that we plan to use. */
+#define TIME_SAFETY_MARGIN    0.75
+
+struct level_cost {
+  int samples;
+  double log_nodes;
+};
+
+static struct level_cost level_costs[NUM_POSITION_CLASSES][MAX_MODEL_LEVEL + 1];
+static struct level_cost class_base[NUM_POSITION_CLASSES];
+static double time_per_node = -1.0;
+static double log_variance = 0.0;
+
+
+static int
+position_class(int move_number)
+{
+  int area = board_size * board_size;
+
+  if (move_number < area / 6)
+    return 0;
+  if (move_number < area / 2)
+    return 1;
+  return 2;
+}
+
+
+/* Add a measurement to a moving average. */
+static void
+average_cost(struct level_cost *cost, double log_nodes)
+{
+  if (cost->samples == 0)
+    cost->log_nodes = log_nodes;
+  else
+    cost->log_nodes += COST_AVERAGING * (log_nodes - cost->log_nodes);
+  cost->samples++;
+}
+
+
+/* The logarithm of the factor by which the number of nodes grows per
+ * level. Each pair of neighboring measured levels in the same class
+ * gives an estimate, which is combined with the default weighted by
+ * the inverse of its variance.
+ */
+static double
+log_level_growth(void)
+{
+  double sum = log(DEFAULT_LEVEL_GROWTH) / PRIOR_GROWTH_VARIANCE;
+  double precision = 1.0 / PRIOR_GROWTH_VARIANCE;
+  double variance = gg_max(log_variance, 0.25);
+  int c;
+  int l;
+
+  for (c = 0; c < NUM_POSITION_CLASSES; c++) {
+    int last = -1;
+    for (l = 0; l <= MAX_MODEL_LEVEL; l++) {
+      if (level_costs[c][l].samples == 0)
+	continue;
+      if (last >= 0) {
+	int steps = l - last;
+	double n1 = gg_min(level_costs[c][last].samples,
+			   MAX_EFFECTIVE_SAMPLES);
+	double n2 = gg_min(level_costs[c][l].samples, MAX_EFFECTIVE_SAMPLES);
+	double growth = ((level_costs[c][l].log_nodes
+			  - level_costs[c][last].log_nodes) / steps);
+	double growth_variance = variance * (1.0/n1 + 1.0/n2) / (steps * steps);
+	sum += growth / growth_variance;
+	precision += 1.0 / growth_variance;
+      }
+      last = l;
+    }
+  }
+
+  return gg_min(gg_max(sum / precision, log(MIN_LEVEL_GROWTH)),
+		log(MAX_LEVEL_GROWTH));
+}
+
+
+/* Learn from the trace of a generated move, see genmove_trace_finish().
+ * Moves answered from the ponder cache tell nothing.
+ */
+void
+clock_learn_move_cost(const struct genmove_trace *trace)
+{
+  struct level_cost *base;
+  double nodes = 0.0;
+  double log_nodes;
+  double log_growth;
+  int c;
+  int k;
+
+  if (trace->pondered || trace->level < 0 || trace->level > MAX_MODEL_LEVEL)
+    return;
+
+  for (k = 0; k < NUM_GENMOVE_PHASES; k++)
+    nodes += (trace->phase[k].reading_nodes + trace->phase[k].owl_nodes
+	      + trace->phase[k].connection_nodes);
+  if (nodes < MIN_MODEL_NODES)
+    return;
+
+  if (time_per_node < 0.0)
+    time_per_node = trace->wall_time / nodes;
+  else
+    time_per_node += COST_AVERAGING * (trace->wall_time / nodes
+				       - time_per_node);
+
+  log_nodes = log(nodes);
+  c = position_class(trace->movenum);
+  base = &class_base[c];
+  log_growth = log_level_growth();
+  if (base->samples > 0) {
+    double deviation = (log_nodes - trace->level * log_growth
+			- base->log_nodes);
+    log_variance += COST_AVERAGING * (deviation * deviation - log_variance);
+  }
+  average_cost(base, log_nodes - trace->level * log_growth);
+  average_cost(&level_costs[c][trace->level], log_nodes);
+
+  DEBUG(DEBUG_TIME,
+	"Level %d took %f s, %d nodes (class %d, variance %f)\n",
+	trace->level, trace->wall_time, (int) nodes, c, log_variance);
+}
+
+
+/* The expected time for a move at level l in positions of class c, or
+ * a negative value if nothing has been measured yet. Classes without
+ * measurements borrow from the nearest class which has them. The
+ * number of nodes is taken to be log-normally distributed, so its
+ * expectation is exp(mean + variance / 2) of its logarithm.
+ */
+static double
+expected_time(int c, int l, double log_growth)
+{
+  int distance;
+  int k;
+
+  if (time_per_node < 0.0)
+    return -1.0;
+
+  for (distance = 0; distance < NUM_POSITION_CLASSES; distance++)
+    for (k = -1; k <= 1; k += 2) {
+      int c2 = c + k * distance;
+      if (c2 >= 0 && c2 < NUM_POSITION_CLASSES && class_base[c2].samples > 0)
+	return time_per_node * exp(class_base[c2].log_nodes + l * log_growth
+				   + log_variance / 2.0);
+    }
+
+  return -1.0;
+}
+
+
 /* Analyze the two most recent time reports and determine the time
  * spent on the last moves, the (effective) number of stones left and
  * the (effective) remaining time.
@@ -326,7 +509,9 @@ analyze_time_data(int color, double *time_for_last_move, double *time_left,
 
 
 /* Adjust the level offset given information of current playing speed
- * and remaining time and stones.
+ * and remaining time and stones. The new level is the highest one
+ * whose expected time fits into the time available per move, with a
+ * safety margin. Nothing changes until a move has been measured.
  */
 void
 adjust_level_offset(int color)
@@ -334,41 +519,32 @@ adjust_level_offset(int color)
   double time_for_last_move;
   double time_left;
   int stones_left;
+  double budget;
+  double log_growth;
+  int c = position_class(movenum);
+  int new_level = -1;
+  int l;
 
   if (!analyze_time_data(color, &time_for_last_move, &time_left, &stones_left))
     return;
 
+  log_growth = log_level_growth();
+  if (expected_time(c, level + level_offset, log_growth) < 0.0)
+    return;
+
+  budget = TIME_SAFETY_MARGIN * time_left / gg_max(stones_left, 1);
+  for (l = min_level; l <= gg_min(max_level, MAX_MODEL_LEVEL); l++)
+    if (expected_time(c, l, log_growth) <= budget)
+      new_level = l;
 
-  /* These rules are both crude and ad hoc.
-   *
-   * FIXME: Use rules with at least some theoretical basis.
-   */
-  if (time_left < time_for_last_move * (stones_left + 3))
-    level_offset--;
-  if (time_left < time_for_last_move * stones_left)
-    level_offset--;
-  if (3 * time_left < 2 * time_for_last_move * stones_left)
-    level_offset--;
-  if (2 * time_left < time_for_last_move * stones_left)
-    level_offset--;
-  if (3 * time_left < time_for_last_move * stones_left)
-    level_offset--;
-
-  if (time_for_last_move == 0)
-    time_for_last_move = 1;
-  if (time_left > time_for_last_move * (stones_left + 6))
-    level_offset++;
-  if (time_left > 2 * time_for_last_move * (stones_left + 6))
-    level_offset++;
-
-  if (level + level_offset < min_level)
-    level_offset = min_level - level;
-
-  if (level + level_offset > max_level)
-    level_offset = max_level - level;
-
-  DEBUG(DEBUG_TIME, "New level %d (%d %C %f %f %d)\n", level + level_offset,
-	movenum / 2, color, time_for_last_move, time_left, stones_left);
+  if (new_level < 0)
+    new_level = min_level;
+  level_offset = new_level - level;
+
+  DEBUG(DEBUG_TIME, "New level %d (%d %C %f %f %d, expect %f s, growth %f)\n",
+	level + level_offset, movenum / 2, color, time_for_last_move,
+	time_left, stones_left, expected_time(c, new_level, log_growth),
+	exp(log_growth));
 }
 
 
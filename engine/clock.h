@@ -37,6 +37,8 @@ void clock_print(int color);
 int have_time_settings(void);
 
 void adjust_level_offset(int color);
+struct genmove_trace;
+void clock_learn_move_cost(const struct genmove_trace *trace);
 
 /* Access to level settings. */
 int get_level(void);
@@ -1021,7 +1021,7 @@ atari_atari_attack_callback(int anchor, int color,
    * if the pattern must be rejected.
    */
   if (pattern->autohelper_flag & HAVE_CONSTRAINT)
-    if (!pattern->autohelper(ll, move, color, 0))
+    if (!pattern_constraint(pattern, ll, move, color))
       return;
 
   /* If the pattern has a helper, call it to see if the pattern must
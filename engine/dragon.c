@@ -107,6 +107,7 @@ make_dragons(int stop_before_owl)
 {
   int str;
   int d;
+  int phase;
 
   dragon2_initialized = 0;
   initialize_dragon_data();
@@ -192,6 +193,7 @@ make_dragons(int stop_before_owl)
   /* Determine life and death status of each dragon using the owl code
    * if necessary.
    */
+  phase = genmove_trace_phase(GENMOVE_OWL);
   start_timer(2);
   for (str = BOARDMIN; str < BOARDMAX; str++)
     if (ON_BOARD(str)) {
@@ -371,6 +373,7 @@ make_dragons(int stop_before_owl)
       dragon[str] = dragon[dragon[str].origin];
 
   time_report(2, "  owl threats ", NO_MOVE, 1.0);
+  genmove_trace_phase(phase);
   
 
   /* Compute the safety value. */
@@ -419,8 +422,10 @@ make_dragons(int stop_before_owl)
   /* Revise inessentiality of critical worms and dragons. */
   revise_inessentiality();
 
+  phase = genmove_trace_phase(GENMOVE_OWL);
   semeai();
   time_report(2, "  semeai module", NO_MOVE, 1.0);
+  genmove_trace_phase(phase);
   
   /* Count the non-dead dragons. */
   lively_white_dragons = 0;
@@ -698,9 +703,9 @@ initialize_supplementary_dragon_data(void)
    *       array if the old one is too small.
    */
   if (dragon2 != NULL)
-    free(dragon2);
+    pool_free(dragon2);
   
-  dragon2 = malloc(number_of_dragons * sizeof(*dragon2));
+  dragon2 = pool_malloc(POOL_ENGINE, number_of_dragons * sizeof(*dragon2));
   gg_assert(dragon2 != NULL);
   
   /* Find the origins of the dragons to establish the mapping back to
@@ -2233,7 +2238,7 @@ compute_refined_dragon_weaknesses()
 void
 compute_strategic_sizes()
 {
-  float *bonus = calloc(number_of_dragons, sizeof(float));
+  float *bonus = pool_calloc(POOL_ENGINE, number_of_dragons, sizeof(float));
   int d;
   int k;
 
@@ -2279,7 +2284,7 @@ compute_strategic_sizes()
 				       3 * DRAGON(d).effective_size);
   }
 
-  free(bonus);
+  pool_free(bonus);
 }
 
 
@@ -61,8 +61,10 @@ static int revise_thrashing_dragon(int color, float our_score,
 
 static void break_mirror_go(int color);
 static int find_mirror_move(int *move, int color);
+static int find_forced_move(int color, int *move, float *value);
 static int should_resign(int color, float optimistic_score, int move);
 static void compute_scores(int use_chinese_rules);
+static void do_examine_position(int how_much, int aftermath_play);
 
 
 /* Reset some things in the engine. 
@@ -122,6 +124,15 @@ reset_engine()
 
 void
 examine_position(int how_much, int aftermath_play)
+{
+  int phase = genmove_trace_phase(GENMOVE_SETUP);
+  do_examine_position(how_much, aftermath_play);
+  genmove_trace_phase(phase);
+}
+
+
+static void
+do_examine_position(int how_much, int aftermath_play)
 {
   int save_verbose = verbose;
 
@@ -134,6 +145,7 @@ examine_position(int how_much, int aftermath_play)
     --verbose;
 
   if (NEEDS_UPDATE(worms_examined)) {
+    genmove_trace_phase(GENMOVE_WORMS);
     start_timer(0);
     make_worms();
     time_report(0, "  make worms", NO_MOVE, 1.0);
@@ -146,8 +158,10 @@ examine_position(int how_much, int aftermath_play)
   }
 
   if (stones_on_board(BLACK | WHITE) != 0) {
-    if (NEEDS_UPDATE(initial_influence_examined))
+    if (NEEDS_UPDATE(initial_influence_examined)) {
+      genmove_trace_phase(GENMOVE_INFLUENCE);
       compute_worm_influence();
+    }
     if (how_much == EXAMINE_INITIAL_INFLUENCE) {
       verbose = save_verbose;
       gg_assert(test_gray_border() < 0);
@@ -155,15 +169,19 @@ examine_position(int how_much, int aftermath_play)
     }
 
     if (how_much == EXAMINE_DRAGONS_WITHOUT_OWL) {
-      if (NEEDS_UPDATE(dragons_examined_without_owl))
+      if (NEEDS_UPDATE(dragons_examined_without_owl)) {
+	genmove_trace_phase(GENMOVE_DRAGONS);
 	make_dragons(1);
+      }
       verbose = save_verbose;
       gg_assert(test_gray_border() < 0);
       return;
     }
     
     if (NEEDS_UPDATE(dragons_examined)) {
+      genmove_trace_phase(GENMOVE_DRAGONS);
       make_dragons(0);
+      genmove_trace_phase(GENMOVE_INFLUENCE);
       compute_scores(chinese_rules || aftermath_play);
       /* We have automatically done a partial dragon analysis as well. */
       dragons_examined_without_owl = position_number;
@@ -177,7 +195,9 @@ examine_position(int how_much, int aftermath_play)
   else if (how_much == EXAMINE_INITIAL_INFLUENCE
 	   || how_much == EXAMINE_DRAGONS
 	   || how_much == EXAMINE_ALL) {
+    genmove_trace_phase(GENMOVE_DRAGONS);
     initialize_dragon_data();
+    genmove_trace_phase(GENMOVE_INFLUENCE);
     compute_scores(chinese_rules || aftermath_play);
     verbose = save_verbose;
     gg_assert(test_gray_border() < 0);
@@ -187,6 +207,7 @@ examine_position(int how_much, int aftermath_play)
   verbose = save_verbose;
 
   if (NEEDS_UPDATE(initial_influence2_examined)) {
+    genmove_trace_phase(GENMOVE_INFLUENCE);
     compute_dragon_influence();
   }
   if (how_much == EXAMINE_INITIAL_INFLUENCE2) {
@@ -195,6 +216,7 @@ examine_position(int how_much, int aftermath_play)
   }
 
   if (NEEDS_UPDATE(dragons_refinedly_examined)) {
+    genmove_trace_phase(GENMOVE_DRAGONS);
     compute_refined_dragon_weaknesses();
     compute_strategic_sizes();
   }
@@ -246,9 +268,21 @@ int
 genmove(int color, float *value, int *resign)
 {
   int move = PASS_MOVE;
+  float ponder_value;
   if (resign)
     *resign = 0;
 
+  /* Use the answer prepared while pondering, if the opponent played
+   * one of the predicted moves.
+   */
+  if (!limit_search && ponder_lookup(color, &move, &ponder_value, resign)) {
+    if (value)
+      *value = ponder_value;
+    genmove_trace_start(color);
+    genmove_trace_finish(move, ponder_value, 1);
+    return move;
+  }
+
 #if ORACLE
   if (metamachine) {
     move = metamachine_genmove(color, value, limit_search);
@@ -397,6 +431,7 @@ do_genmove(int color, float pure_threat_value,
     value = &dummy_value;
 
   start_timer(0);
+  genmove_trace_start(color);
   clearstats();
 
   /* Usually we would not recommend resignation. */
@@ -425,6 +460,24 @@ do_genmove(int color, float pure_threat_value,
       && find_mirror_move(&move, color)) {
     TRACE("genmove() recommends mirror move at %1m\n", move);
     *value = 1.0;
+    genmove_trace_finish(move, *value, 0);
+    return move;
+  }
+
+  /* If there is only one sensible move, play it without the full
+   * examination of the position.
+   */
+  if (forced_moves
+      && !allowed_moves
+      && !doing_scoring
+      && !play_out_aftermath
+      && !capture_all_dead
+      && find_forced_move(color, &move, value)) {
+    TRACE("genmove() recommends forced move at %1m\n", move);
+    time_report(1, "forced move", move, 1.0);
+    gg_assert(stackp == 0);
+    gg_assert(depth == save_depth);
+    genmove_trace_finish(move, *value, 0);
     return move;
   }
 
@@ -477,6 +530,7 @@ do_genmove(int color, float pure_threat_value,
 
   
   /* Pick up moves that we know of already. */
+  genmove_trace_phase(GENMOVE_MOVE_REASONS);
   save_verbose = verbose;
   if (verbose > 0)
     verbose--;
@@ -485,6 +539,7 @@ do_genmove(int color, float pure_threat_value,
   time_report(1, "generate move reasons", NO_MOVE, 1.0);
   
   /* Try to find empty corner moves. */
+  genmove_trace_phase(GENMOVE_SHAPES);
   fuseki(color);
   gg_assert(stackp == 0);
 
@@ -510,6 +565,7 @@ do_genmove(int color, float pure_threat_value,
   gg_assert(stackp == 0);
 
   /* Review the move reasons and estimate move values. */
+  genmove_trace_phase(GENMOVE_REVIEW);
   if (review_move_reasons(&move, value, color, 
 			  pure_threat_value, pessimistic_score, allowed_moves,
 			  use_thrashing_dragon_heuristics))
@@ -520,9 +576,11 @@ do_genmove(int color, float pure_threat_value,
 
   /* If the move value is 6 or lower, we look for endgame patterns too. */
   if (*value <= 6.0 && !disable_endgame_patterns) {
+    genmove_trace_phase(GENMOVE_SHAPES);
     endgame_shapes(color);
     endgame(color);
     gg_assert(stackp == 0);
+    genmove_trace_phase(GENMOVE_REVIEW);
     if (review_move_reasons(&move, value, color, pure_threat_value,
 	  		    pessimistic_score, allowed_moves,
 			    use_thrashing_dragon_heuristics))
@@ -537,8 +595,10 @@ do_genmove(int color, float pure_threat_value,
    */
   if (move == PASS_MOVE) {
     if (revise_semeai(color)) {
+      genmove_trace_phase(GENMOVE_SHAPES);
       shapes(color);
       endgame_shapes(color);
+      genmove_trace_phase(GENMOVE_REVIEW);
       if (review_move_reasons(&move, value, color, pure_threat_value,
 			      pessimistic_score, allowed_moves,
 			      use_thrashing_dragon_heuristics)) {
@@ -571,10 +631,13 @@ do_genmove(int color, float pure_threat_value,
       else
 	allowed_moves2[pos] = 0;
     
-    if (num_allowed_moves2 > 1)
+    if (num_allowed_moves2 > 1) {
+      genmove_trace_phase(GENMOVE_MONTE_CARLO);
       move = monte_carlo_genmove(color, allowed_moves2, value, resign);
+    }
   }
 #endif
+  genmove_trace_phase(GENMOVE_AFTERMATH);
   
   /* If still no move, fill a remaining liberty. This should pick up
    * all missing dame points.
@@ -656,6 +719,7 @@ do_genmove(int color, float pure_threat_value,
   gg_assert(test_gray_border() < 0);
   gg_assert(depth == save_depth);
 
+  genmove_trace_finish(move, *value, 0);
   return move;
 }
 
@@ -783,6 +847,151 @@ find_mirror_move(int *move, int color)
   return 0;
 }
 
+/* The smallest string whose capture or rescue find_forced_move()
+ * considers forced. Smaller strings are often sacrifices.
+ */
+#define FORCED_MIN_STONES 4
+
+/* Look for a move which needs no full examination of the position,
+ * using only the worm data and the unconditional status. These are
+ *
+ * 1. a pass when the whole board is unconditionally settled,
+ * 2. the capture of a big string which the opponent's last move left
+ *    in atari and which could otherwise escape, and
+ * 3. the rescue of a big string which the opponent's last move put
+ *    into atari, by capturing the attacker if that is no ko, and
+ *    otherwise by the defense point of the string.
+ *
+ * The last two cases are only taken when no other string of either
+ * color is in atari, and the move must leave the new stone and the
+ * rescued string safe from tactical attack. Ko moves are never forced.
+ */
+
+static int
+find_forced_move(int color, int *move, float *value)
+{
+  int other = OTHER_COLOR(color);
+  int last_move = get_last_move();
+  int attacker = NO_MOVE;
+  int target = NO_MOVE;
+  int candidate = NO_MOVE;
+  int empty = 0;
+  int pos;
+  int k;
+
+  examine_position(EXAMINE_WORMS, 0);
+
+  if (last_move != NO_MOVE && board[last_move] == other)
+    attacker = worm[last_move].origin;
+
+  for (pos = BOARDMIN; pos < BOARDMAX; pos++) {
+    if (!ON_BOARD(pos))
+      continue;
+    if (board[pos] == EMPTY)
+      empty++;
+    else if (worm[pos].origin == pos
+	     && worm[pos].liberties == 1
+	     && pos != attacker) {
+      /* Several strings in atari, or a target which is not ours;
+       * let the full move generation sort it out.
+       */
+      if (board[pos] == other || target != NO_MOVE)
+	return 0;
+      target = pos;
+    }
+  }
+
+  /* 1. Nothing left to play for. */
+  if (target == NO_MOVE && empty < board_size * board_size / 3) {
+    int unconditional_territory_black[BOARDMAX];
+    int unconditional_territory_white[BOARDMAX];
+    int settled = 1;
+
+    unconditional_life(unconditional_territory_black, BLACK);
+    unconditional_life(unconditional_territory_white, WHITE);
+    for (pos = BOARDMIN; pos < BOARDMAX; pos++)
+      if (ON_BOARD(pos)
+	  && !unconditional_territory_black[pos]
+	  && !unconditional_territory_white[pos])
+	settled = 0;
+
+    if (settled) {
+      TRACE("find_forced_move: the board is unconditionally settled\n");
+      *move = PASS_MOVE;
+      *value = 0.0;
+      return 1;
+    }
+  }
+
+  if (attacker == NO_MOVE)
+    return 0;
+
+  if (target == NO_MOVE) {
+    /* 2. The opponent's last move left a big string in atari. If it
+     * cannot escape anyway, the capture is not urgent and the full
+     * move generation may well prefer a bigger move.
+     */
+    if (worm[attacker].liberties != 1
+	|| worm[attacker].size < FORCED_MIN_STONES
+	|| worm[attacker].defense_codes[0] == 0)
+      return 0;
+    findlib(attacker, 1, &candidate);
+    TRACE("find_forced_move: %1m captures %1m\n", candidate, attacker);
+    *value = 2.0 * worm[attacker].effective_size;
+  }
+  else {
+    /* 3. A big string of ours in atari from the opponent's last move. */
+    if (worm[target].size < FORCED_MIN_STONES
+	|| worm[target].attack_codes[0] != WIN
+	|| worm[target].defense_codes[0] != WIN)
+      return 0;
+
+    for (k = 0; k < 4; k++)
+      if (board[last_move + delta[k]] == color
+	  && worm[last_move + delta[k]].origin == target)
+	break;
+    if (k == 4)
+      return 0;
+
+    if (worm[attacker].liberties == 1) {
+      findlib(attacker, 1, &candidate);
+      if (is_ko(candidate, color, NULL))
+	candidate = NO_MOVE;
+    }
+    if (candidate == NO_MOVE)
+      candidate = worm[target].defense_points[0];
+    TRACE("find_forced_move: %1m saves %1m, put into atari by %1m\n",
+	  candidate, target, attacker);
+    *value = 2.0 * worm[target].effective_size;
+  }
+
+  if (candidate == NO_MOVE
+      || !is_allowed_move(candidate, color)
+      || is_ko(candidate, color, NULL))
+    return 0;
+
+  /* Cheap blunder check. */
+  if (!trymove(candidate, color, "find_forced_move", target))
+    return 0;
+  if ((target != NO_MOVE && attack(target, NULL) != 0)
+      || attack(candidate, NULL) != 0) {
+    popgo();
+    return 0;
+  }
+  popgo();
+
+  *move = candidate;
+
+  for (k = 0; k < 10; k++) {
+    best_moves[k] = NO_MOVE;
+    best_move_values[k] = 0.0;
+  }
+  record_top_move(candidate, *value);
+  move_considered(candidate, *value);
+  return 1;
+}
+
+
 /* Computer two territory estimates: for *upper, the status of all
  * cricital stones gets resolved in White's favor; vice verso for
  * black.
@@ -98,6 +98,7 @@ int output_flags      = OUTPUT_DEFAULT; /* amount of output to outfile */
 int metamachine       = 0;  /* use metamachine_genmove */
 int oracle_exists     = 0;  /* oracle is available for consultation   */
 int autolevel_on      = 0;  /* Adjust level in GMP or ASCII mode. */
+int ponder_on         = 0;  /* Think on the opponent's time in GTP mode. */
 
 int disable_threat_computation = 0;
 int disable_endgame_patterns   = 0;
@@ -110,6 +111,14 @@ int experimental_connections = EXPERIMENTAL_CONNECTIONS;
 int alternate_connections = ALTERNATE_CONNECTIONS;
 /* compute owl threats */
 int owl_threats = OWL_THREATS; 
+/* number of processes for independent owl reading, 0 or 1 for none */
+int owl_workers = 0;
+/* return forced moves without the full move generation */
+#ifdef CONFIG_FORCED_MOVES
+int forced_moves = 1;
+#else
+int forced_moves = 0;
+#endif
 /* use experimental owl extension (GAIN/LOSS) */
 int experimental_owl_ext = EXPERIMENTAL_OWL_EXT;
 /* use experimental territory break-in module */
@@ -152,7 +161,7 @@ int _EMBEDDED_BSS false_eye_territory[BOARDMAX];
 int _EMBEDDED_BSS_SMALL forced_backfilling_moves[BOARDMAX];
 
 struct worm_data     _EMBEDDED_BSS worm[BOARDMAX];
-struct  dragon_data   _EMBEDDED_BSS dragon[BOARDMAX];
+struct  dragon_data   _EMBEDDED_HOT dragon[BOARDMAX];
 int                   number_of_dragons;
 struct  dragon_data2   *dragon2 = NULL;
 struct  half_eye_data  _EMBEDDED_BSS half_eye[BOARDMAX];
@@ -163,7 +172,7 @@ struct  vital_eye_points _EMBEDDED_BSS white_vital_points[BOARDMAX];
 struct  surround_data _EMBEDDED_BSS_SMALL surroundings[MAX_SURROUND];
 int                   surround_pointer;
 
-int _EMBEDDED_BSS_SMALL cutting_points[BOARDMAX];
+int _EMBEDDED_HOT cutting_points[BOARDMAX];
 
 double slowest_time = 0.0;
 int    slowest_move = NO_MOVE;
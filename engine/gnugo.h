@@ -213,6 +213,8 @@ extern int experimental_owl_ext;     /* use experimental owl (GAIN/LOSS) */
 extern int experimental_connections; /* use experimental connection module */
 extern int alternate_connections;    /* use alternate connection module */
 extern int owl_threats;              /* compute owl threats */
+extern int owl_workers;              /* processes reading owl questions ahead */
+extern int forced_moves;             /* skip full genmove for forced moves */
 extern int capture_all_dead;         /* capture all dead opponent stones */
 extern int play_out_aftermath; /* make everything unconditionally settled */
 extern int resign_allowed;           /* allows GG to resign hopeless games */
@@ -240,6 +242,7 @@ extern int mandated_owl_node_limit;
 extern int mandated_semeai_node_limit; 
 
 extern int autolevel_on;
+extern int ponder_on;
 
 extern float potential_moves[BOARDMAX];
 
@@ -313,10 +316,56 @@ void silent_examine_position(int how_much);
 /* These are mostly used for GTP examination. */
 void reset_owl_node_counter(void);
 int get_owl_node_counter(void);
+void add_owl_node_counter(int nodes);
 void reset_reading_node_counter(void);
 int get_reading_node_counter(void);
+void add_reading_node_counter(int nodes);
 void reset_connection_node_counter(void);
 int get_connection_node_counter(void);
+void add_connection_node_counter(int nodes);
+
+/* Where the time of a move generation went, see genmove_trace_phase(). */
+enum genmove_phase {
+  GENMOVE_SETUP,
+  GENMOVE_WORMS,
+  GENMOVE_INFLUENCE,
+  GENMOVE_DRAGONS,
+  GENMOVE_OWL,
+  GENMOVE_MOVE_REASONS,
+  GENMOVE_SHAPES,
+  GENMOVE_REVIEW,
+  GENMOVE_VALUE_MOVES,
+  GENMOVE_BLUNDER_CHECK,
+  GENMOVE_MONTE_CARLO,
+  GENMOVE_AFTERMATH,
+  NUM_GENMOVE_PHASES
+};
+
+struct genmove_phase_data {
+  double cpu_time;
+  double wall_time;
+  int reading_nodes;
+  int owl_nodes;
+  int connection_nodes;
+};
+
+struct genmove_trace {
+  int color;
+  int movenum;		/* Moves played before this one. */
+  int level;
+  int move;
+  float value;
+  int pondered;		/* The answer was prepared while pondering. */
+  double cpu_time;
+  double wall_time;
+  struct genmove_phase_data phase[NUM_GENMOVE_PHASES];
+};
+
+/* Called with the trace of every move generation if set. */
+extern void (*genmove_trace_hook)(const struct genmove_trace *trace);
+const struct genmove_trace *get_genmove_trace(void);
+const char *genmove_phase_name(int phase);
+void print_genmove_trace(FILE *outfile, const struct genmove_trace *trace);
 
 
 
@@ -331,6 +380,22 @@ void who_wins(int color, FILE *outfile);
 int genmove(int color, float *value, int *resign);
 int genmove_conservative(int color, float *value);
 
+/* interrupt.c */
+int run_interruptible(void (*job)(void *data), void *data,
+		      int (*interrupt)(void));
+void interrupt_search(void);
+
+/* placement.c */
+#ifdef PROFILE_PLACEMENT
+void placement_profile_start(void);
+void placement_report(FILE *outfile);
+#endif
+
+/* ponder.c */
+void ponder_start(int color);
+int ponder(int (*interrupt)(void));
+int ponder_prepared_moves(int *moves, int max_moves);
+
 /* Play through the aftermath. */
 float aftermath_compute_score(int color, SGFTree *tree);
 
@@ -350,6 +415,8 @@ int same_dragon(int dr1, int dr2);
 /* debugging functions */
 void prepare_pattern_profiling(void);
 void report_pattern_profiling(void);
+void reset_pattern_statistics(void);
+void print_pattern_statistics(FILE *outfile, int csv);
 
 /* sgffile.c */
 void sgffile_add_debuginfo(SGFNode *node, float value);
@@ -372,6 +439,7 @@ void decide_eye(int pos);
 void decide_combination(int color);
 void decide_surrounded(int pos);
 void decide_oracle(Gameinfo *gameinfo, char *infilename, char *untilstring);
+void decide_batch(FILE *input, FILE *output, int workers);
 
 /*oracle.c*/
 void dismiss_oracle(void);
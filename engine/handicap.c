@@ -400,7 +400,7 @@ free_handicap_callback(int anchor, int color, struct pattern *pattern,
    * if the pattern must be rejected.
    */
   if (pattern->autohelper_flag & HAVE_CONSTRAINT) {
-    if (!pattern->autohelper(ll, move, color, 0))
+    if (!pattern_constraint(pattern, ll, move, color))
       return;
   }
   
@@ -45,8 +45,8 @@
 
 
 /* Random values for the board hash function. For stones and ko position. */
-static Hash_data _EMBEDDED_BSS_SMALL white_hash[BOARDMAX];
-static Hash_data _EMBEDDED_BSS_SMALL black_hash[BOARDMAX];
+static Hash_data _EMBEDDED_HOT white_hash[BOARDMAX];
+static Hash_data _EMBEDDED_HOT black_hash[BOARDMAX];
 static Hash_data _EMBEDDED_BSS_SMALL ko_hash[BOARDMAX];
 static Hash_data _EMBEDDED_BSS_SMALL komaster_hash[NUM_KOMASTER_STATES];
 static Hash_data _EMBEDDED_BSS_SMALL kom_pos_hash[BOARDMAX];
@@ -57,7 +57,7 @@ struct influence_data _EMBEDDED_BSS initial_black_influence;
 struct influence_data _EMBEDDED_BSS initial_white_influence;
 
 /* Influence computed after some move has been made. */
-struct influence_data _EMBEDDED_BSS move_influence;
+struct influence_data _EMBEDDED_HOT move_influence;
 struct influence_data _EMBEDDED_BSS followup_influence;
 
 /* Influence used for estimation of escape potential. */
@@ -66,6 +66,35 @@ static struct influence_data _EMBEDDED_BSS  escape_influence;
 /* Pointer to influence data used during pattern matching. */
 static struct influence_data *current_influence = NULL;
 
+/* Record of the influence each source has added in the last
+ * computation of the initial influences, so that
+ * compute_move_influence() can take back the sources affected by a
+ * move without spreading them again. The points at which each source
+ * has been spread are kept in point[start] to point[end - 1], the
+ * influence actually added there in amount[]. The additional
+ * spreading from removed double blocks is kept at the end, from
+ * extra_start on.
+ */
+#define INFLUENCE_RECORD_SIZE (48 * MAX_BOARD * MAX_BOARD)
+#define MAX_DOUBLE_BLOCKS 20 
+
+struct influence_record {
+  int id;		/* Id of the recorded computation, 0 if invalid. */
+  int num_points;
+  int start[2][BOARDMAX];	/* Indexed by color == BLACK. */
+  int end[2][BOARDMAX];
+  int extra_start;
+  int num_blocks;
+  int blocks[MAX_DOUBLE_BLOCKS];
+  short point[INFLUENCE_RECORD_SIZE];
+  float amount[INFLUENCE_RECORD_SIZE];
+};
+
+static struct influence_record *influence_records[2];
+
+/* The record being filled in, if any. */
+static struct influence_record *recording = NULL;
+
 
 /* Thresholds values used in the whose_moyo() functions */
 static struct moyo_determination_data moyo_data;
@@ -128,6 +157,11 @@ static int influence_id = 0;
  * unrolling makes a noticeable performance difference. It does,
  * however, make the code much harder to read and maintain. Therefore
  * we include both the original and the unrolled versions.
+ *
+ * The unrolled version also handles the origin separately, looks up
+ * the inverse square distance in a table, and keeps the direction
+ * offsets as constants. It accumulates the same contributions in the
+ * same order as the original version, so the results are identical.
  */
 
 #define EXPLICIT_LOOP_UNROLLING 1
@@ -149,11 +183,10 @@ static int influence_id = 0;
 
 
 #define code1(arg_di, arg_dj, arg, arg_d) do { \
-      if (!q->safe[arg] \
-	  && ((arg_di)*(delta_i) + (arg_dj)*(delta_j) > 0 \
-	      || queue_start == 1)) { \
+      int a = (arg_di)*(delta_i) + (arg_dj)*(delta_j); \
+      if (a > 0 && ON_BOARD(arg) && !q->safe[arg]) { \
 	float contribution; \
-	float permeability = permeability_array[ii]; \
+	float permeability = permeability_here; \
 	if (arg_d) { \
 	  permeability *= gg_max(permeability_array[ii + DELTA(arg_di, 0)], \
 			         permeability_array[ii + DELTA(0, arg_dj)]); \
@@ -161,10 +194,7 @@ static int influence_id = 0;
 	    continue; \
 	} \
 	contribution = current_strength * permeability; \
-	if (queue_start != 1) { \
-	  int a = (arg_di)*(delta_i) + (arg_dj)*(delta_j); \
-	  contribution *= (a*a) * b; /* contribution *= cos(phi) */ \
-	} \
+	contribution *= (a*a) * b; /* contribution *= cos(phi) */ \
 	if (contribution <= INFLUENCE_CUTOFF) \
 	  continue; \
 	if (working[arg] == 0.0) { \
@@ -173,6 +203,12 @@ static int influence_id = 0;
 	} \
 	working[arg] += contribution; \
       } } while (0) 
+
+/* 1/(di^2 + dj^2) for all distances on the board, indexed by the
+ * square of the distance. This saves a division for each point
+ * influence is spread from.
+ */
+static float inv_square_distance[2 * (MAX_BOARD - 1) * (MAX_BOARD - 1) + 1];
 #endif
 
 
@@ -190,17 +226,23 @@ accumulate_influence(struct influence_data *q, int pos, int color)
   float inv_attenuation;
   float inv_diagonal_damping;
   float *permeability_array;
+  float *influence;
 
   /* Clear the queue. Entry 0 is implicitly (m, n). */
   int queue_start = 0;
   int queue_end = 1;
 
-  static float _EMBEDDED_BSS_SMALL working[BOARDMAX];
+  static float _EMBEDDED_HOT working[BOARDMAX];
   static int working_area_initialized = 0;
 
   if (!working_area_initialized) {
     for (ii = 0; ii < BOARDMAX; ii++)
       working[ii] = 0.0;
+#if EXPLICIT_LOOP_UNROLLING
+    inv_square_distance[0] = 1.0;
+    for (k = 1; k < (int) (sizeof(inv_square_distance) / sizeof(float)); k++)
+      inv_square_distance[k] = 1.0 / k;
+#endif
     working_area_initialized = 1;
   }
 
@@ -233,10 +275,51 @@ accumulate_influence(struct influence_data *q, int pos, int color)
     working[pos] = q->black_strength[pos];
 
 
+#if EXPLICIT_LOOP_UNROLLING
+  /* From the origin influence is spread in all directions, without
+   * direction dependent damping. Handling it separately keeps these
+   * tests out of the main loop below.
+   */
+  queue_start = 1;
+  if (permeability_array[pos] != 0.0) {
+    float current_strength = working[pos] * inv_attenuation;
+
+    for (k = 0; k < 8; k++) {
+      int d_ii = delta[k];
+      float permeability = permeability_array[pos];
+      float contribution;
+
+      if (!ON_BOARD(pos + d_ii) || q->safe[pos + d_ii])
+	continue;
+
+      if (k > 3) { /* diagonal movement */
+	permeability *= gg_max(permeability_array[pos + DELTA(deltai[k], 0)],
+			       permeability_array[pos + DELTA(0, deltaj[k])]);
+	if (permeability == 0.0)
+	  continue;
+	contribution = (current_strength * inv_diagonal_damping) * permeability;
+      }
+      else
+	contribution = current_strength * permeability;
+
+      if (contribution <= INFLUENCE_CUTOFF)
+	continue;
+      if (working[pos + d_ii] == 0.0) {
+	q->queue[queue_end] = pos + d_ii;
+	queue_end++;
+      }
+      working[pos + d_ii] += contribution;
+    }
+  }
+#endif
+
   /* Spread influence until the stack is empty. */
   while (queue_start < queue_end) {
     float current_strength;
     int delta_i, delta_j;
+#if EXPLICIT_LOOP_UNROLLING
+    float permeability_here;
+#endif
 
     ii = q->queue[queue_start];
     delta_i = I(ii) - m;
@@ -247,10 +330,15 @@ accumulate_influence(struct influence_data *q, int pos, int color)
     if (0)
       gprintf("Picked %1m from queue. w=%f start=%d end=%d\n",
 	      ii, working[ii], queue_start, queue_end);
+#if EXPLICIT_LOOP_UNROLLING
+    b = inv_square_distance[delta_i * delta_i + delta_j * delta_j];
+    permeability_here = permeability_array[ii];
+#else
     if (queue_start == 1)
       b = 1.0;
     else
       b = 1.0 / ((delta_i)*(delta_i) + (delta_j)*(delta_j));
+#endif
 
     current_strength = working[ii] * inv_attenuation;
 
@@ -323,27 +411,22 @@ accumulate_influence(struct influence_data *q, int pos, int color)
       }
     }
 #else
-    if (ON_BOARD(ii + delta[0]))
-      code1(deltai[0], deltaj[0], ii + delta[0], 0);
-    if (ON_BOARD(ii + delta[1]))
-      code1(deltai[1], deltaj[1], ii + delta[1], 0);
-    if (ON_BOARD(ii + delta[2]))
-      code1(deltai[2], deltaj[2], ii + delta[2], 0);
-    if (ON_BOARD(ii + delta[3]))
-      code1(deltai[3], deltaj[3], ii + delta[3], 0);
+    /* The directions are those of deltai[], deltaj[] and delta[],
+     * written out as constants so that the compiler can fold them.
+     */
+    code1( 1,  0, SOUTH(ii), 0);
+    code1( 0, -1, WEST(ii), 0);
+    code1(-1,  0, NORTH(ii), 0);
+    code1( 0,  1, EAST(ii), 0);
 
     /* Update factors for diagonal movement. */
     b *= 0.5;
     current_strength *= inv_diagonal_damping;
 
-    if (ON_BOARD(ii + delta[4]))
-      code1(deltai[4], deltaj[4], ii + delta[4], 1);
-    if (ON_BOARD(ii + delta[5]))
-      code1(deltai[5], deltaj[5], ii + delta[5], 1);
-    if (ON_BOARD(ii + delta[6]))
-      code1(deltai[6], deltaj[6], ii + delta[6], 1);
-    if (ON_BOARD(ii + delta[7]))
-      code1(deltai[7], deltaj[7], ii + delta[7], 1);
+    code1( 1, -1, SW(ii), 1);
+    code1(-1, -1, NW(ii), 1);
+    code1(-1,  1, NE(ii), 1);
+    code1( 1,  1, SE(ii), 1);
 #endif
   }
   
@@ -352,21 +435,27 @@ accumulate_influence(struct influence_data *q, int pos, int color)
    * influenced points were stored in the queue, so we just traverse
    * it.
    */
+  if (color == WHITE)
+    influence = q->white_influence;
+  else
+    influence = q->black_influence;
+
   for (k = 0; k < queue_end; k++) {
+    float added = 0.0;
     ii = q->queue[k];
-
-    if (color == WHITE) {
-      if (working[ii] > 1.01 * INFLUENCE_CUTOFF
-	  || q->white_influence[ii] == 0.0)
-	q->white_influence[ii] += working[ii];
-    }
-    else {
-      if (working[ii] > 1.01 * INFLUENCE_CUTOFF
-	  || q->black_influence[ii] == 0.0)
-	q->black_influence[ii] += working[ii];
+    if (working[ii] > 1.01 * INFLUENCE_CUTOFF || influence[ii] == 0.0) {
+      added = working[ii];
+      influence[ii] += added;
     }
-    
     working[ii] = 0.0;
+
+    if (recording) {
+      if (recording->num_points < INFLUENCE_RECORD_SIZE) {
+	recording->point[recording->num_points] = ii;
+	recording->amount[recording->num_points] = added;
+      }
+      recording->num_points++;
+    }
   }
 }
 
@@ -742,7 +831,7 @@ influence_callback(int anchor, int color, struct pattern *pattern, int ll,
    * if the pattern must be rejected.
    */
   if ((pattern->autohelper_flag & HAVE_CONSTRAINT)
-      && !pattern->autohelper(ll, pos, color, 0))
+      && !pattern_constraint(pattern, ll, pos, color))
     return;
 
   DEBUG(DEBUG_INFLUENCE, "influence pattern '%s'+%d matched at %1m\n",
@@ -896,7 +985,7 @@ followup_influence_callback(int anchor, int color, struct pattern *pattern,
    * if the pattern must be rejected.
    */
   if (pattern->autohelper_flag & HAVE_CONSTRAINT
-      && !pattern->autohelper(ll, t, color, 0))
+      && !pattern_constraint(pattern, ll, t, color))
     return;
 
   /* Actions in B patterns are used as followup specific constraints. */
@@ -1006,24 +1095,36 @@ find_influence_patterns(struct influence_data *q)
   reset_unblocked_blocks(q);
 }
 
-/* This function checks whether we have two or more adjacent blocks for
- * influence of color next to pos. If yes, it returns the position of the
- * least valuable blocks; otherwise, it returns NO_MOVE.
- */
+/* Count the empty neighbors of pos which block the influence of color. */
 static int
-check_double_block(int color, int pos, const struct influence_data *q)
+count_block_neighbors(int color, int pos, const struct influence_data *q)
 {
   int k;
   int block_neighbors = 0;
   const float *permeability = ((color == BLACK) ? q->black_permeability :
 						  q->white_permeability);
 
-  /* Count neighboring blocks. */
   for (k = 0; k < 4; k++)
     if (board[pos + delta[k]] == EMPTY && permeability[pos + delta[k]] == 0.0)
       block_neighbors++;
 
-  if (block_neighbors >= 2) {
+  return block_neighbors;
+}
+
+/* This function checks whether we have two or more adjacent blocks for
+ * influence of color next to pos. If yes, it returns the position of the
+ * least valuable blocks; otherwise, it returns NO_MOVE.
+ *
+ * The territory values in q must be up to date.
+ */
+static int
+check_double_block(int color, int pos, const struct influence_data *q)
+{
+  int k;
+  const float *permeability = ((color == BLACK) ? q->black_permeability :
+						  q->white_permeability);
+
+  if (count_block_neighbors(color, pos, q) >= 2) {
     /* Search for least valuable block. */
     float smallest_value = 4.0 * MAX_BOARD * MAX_BOARD;
     int smallest_block = NO_MOVE;
@@ -1055,14 +1156,16 @@ check_double_block(int color, int pos, const struct influence_data *q)
   return NO_MOVE;
 }
 
-#define MAX_DOUBLE_BLOCKS 20 
-
 
 /* This function checks for the situation where an influence source for
  * the color to move is direclty neighbored by 2 or more influence blocks.
  * It then removes the least valuable of these blocks, and re-runs the
  * influence accumulation for this position.
  *
+ * The territory values needed to choose the block are only computed
+ * when some source actually has two blocked neighbors, which is rare.
+ * The caller must recompute them afterwards in any case.
+ *
  * See endgame:840 for an example where this is essential.
  */
 static void
@@ -1074,10 +1177,16 @@ remove_double_blocks(struct influence_data *q,
       						   q->black_strength);
   int double_blocks[MAX_DOUBLE_BLOCKS];
   int num_blocks = 0;
+  int territory_valued = 0;
   for (ii = BOARDMIN; ii < BOARDMAX; ii++)
     if (board[ii] == EMPTY
 	&& !(inhibited_sources && inhibited_sources[ii])
-	&& strength[ii] > 0.0) {
+	&& strength[ii] > 0.0
+	&& count_block_neighbors(q->color_to_move, ii, q) >= 2) {
+      if (!territory_valued) {
+	value_territory(q);
+	territory_valued = 1;
+      }
       double_blocks[num_blocks] = check_double_block(q->color_to_move, ii, q);
       if (double_blocks[num_blocks] != NO_MOVE) {
 	num_blocks++;
@@ -1089,23 +1198,158 @@ remove_double_blocks(struct influence_data *q,
     int k;
     float *permeability = ((q->color_to_move == BLACK)
 			   ? q->black_permeability : q->white_permeability);
+    if (recording) {
+      recording->extra_start = recording->num_points;
+      recording->num_blocks = num_blocks;
+    }
     for (k = 0; k < num_blocks; k++) {
       DEBUG(DEBUG_INFLUENCE, "Removing block for %s at %1m.\n",
 	    color_to_string(q->color_to_move), double_blocks[k]);
       permeability[double_blocks[k]] = 1.0;
+      if (recording)
+	recording->blocks[k] = double_blocks[k];
       accumulate_influence(q, double_blocks[k], q->color_to_move);
     }
   }
 }
 
 
+/* Find the record of the influence computation q, if there is one. */
+static struct influence_record *
+find_influence_record(const struct influence_data *q)
+{
+  int k;
+  for (k = 0; k < 2; k++)
+    if (influence_records[k] && influence_records[k]->id == q->id)
+      return influence_records[k];
+  return NULL;
+}
+
+
+/* Take back the influence recorded in points first to last - 1 of
+ * record.
+ */
+static void
+remove_recorded_influence(const struct influence_record *record,
+			  int first, int last, float influence[BOARDMAX])
+{
+  int k;
+  for (k = first; k < last; k++) {
+    int ii = record->point[k];
+    influence[ii] = gg_max(influence[ii] - record->amount[k], 0.0);
+  }
+}
+
+
+/* Does the spreading recorded in points first to last - 1 of record
+ * pass through a point marked in affected?
+ */
+static int
+spreading_affected(const struct influence_record *record, int first,
+		   int last, const signed char affected[BOARDMAX])
+{
+  int k;
+  for (k = first; k < last; k++)
+    if (affected[record->point[k]])
+      return 1;
+  return 0;
+}
+
+
+/* Spread the influence in q, starting from the influence in base,
+ * which was computed for the position before a move, and its record.
+ * Only the sources whose strength or attenuation has changed, or
+ * whose spreading has passed next to a point where the safe stones or
+ * the permeability have changed, are spread anew. Their old influence
+ * is taken back from the record, as is the extra spreading from the
+ * double blocks removed in base, whose points count as changed.
+ */
+static void
+spread_changed_sources(const struct influence_data *base,
+		       const struct influence_record *record,
+		       struct influence_data *q)
+{
+  signed char changed[2][BOARDMAX];
+  signed char affected[2][BOARDMAX];
+  int ii;
+  int c;
+  int k;
+
+  memcpy(q->white_influence, base->white_influence,
+	 sizeof(q->white_influence));
+  memcpy(q->black_influence, base->black_influence,
+	 sizeof(q->black_influence));
+  remove_recorded_influence(record, record->extra_start, record->num_points,
+			    (base->color_to_move == WHITE
+			     ? q->white_influence : q->black_influence));
+
+  /* The spreading through a point also reads the safe stones and the
+   * permeability of its neighbors.
+   */
+  memset(changed, 0, sizeof(changed));
+  memset(affected, 0, sizeof(affected));
+  for (ii = BOARDMIN; ii < BOARDMAX; ii++)
+    if (ON_BOARD(ii)) {
+      int safe_changed = (!q->safe[ii] != !base->safe[ii]);
+      changed[0][ii] = (safe_changed || q->white_permeability[ii]
+			!= base->white_permeability[ii]);
+      changed[1][ii] = (safe_changed || q->black_permeability[ii]
+			!= base->black_permeability[ii]);
+    }
+  for (k = 0; k < record->num_blocks; k++)
+    changed[base->color_to_move == BLACK][record->blocks[k]] = 1;
+
+  for (c = 0; c < 2; c++)
+    for (ii = BOARDMIN; ii < BOARDMAX; ii++)
+      if (changed[c][ii]) {
+	affected[c][ii] = 1;
+	for (k = 0; k < 8; k++)
+	  if (ON_BOARD(ii + delta[k]))
+	    affected[c][ii + delta[k]] = 1;
+      }
+
+  for (ii = BOARDMIN; ii < BOARDMAX; ii++) {
+    if (!ON_BOARD(ii))
+      continue;
+
+    if (q->white_strength[ii] != base->white_strength[ii]
+	|| (base->white_strength[ii] > 0.0
+	    && (q->white_attenuation[ii] != base->white_attenuation[ii]
+		|| spreading_affected(record, record->start[0][ii],
+				      record->end[0][ii], affected[0])))) {
+      if (base->white_strength[ii] > 0.0)
+	remove_recorded_influence(record, record->start[0][ii],
+				  record->end[0][ii], q->white_influence);
+      if (q->white_strength[ii] > 0.0)
+	accumulate_influence(q, ii, WHITE);
+    }
+
+    if (q->black_strength[ii] != base->black_strength[ii]
+	|| (base->black_strength[ii] > 0.0
+	    && (q->black_attenuation[ii] != base->black_attenuation[ii]
+		|| spreading_affected(record, record->start[1][ii],
+				      record->end[1][ii], affected[1])))) {
+      if (base->black_strength[ii] > 0.0)
+	remove_recorded_influence(record, record->start[1][ii],
+				  record->end[1][ii], q->black_influence);
+      if (q->black_strength[ii] > 0.0)
+	accumulate_influence(q, ii, BLACK);
+    }
+  }
+}
+
+
 /* Do the real work of influence computation. This is called from
- * compute_influence and compute_escape_influence.
+ * compute_influence, compute_move_influence and compute_escape_influence.
  *
  * q->is_territorial_influence and q->color_to_move must be set by the caller.
+ * If base is not NULL, the influence is updated from base, whose
+ * computation must have been recorded. Otherwise the computation is
+ * recorded if q is one of the initial influences.
  */
 static void
-do_compute_influence(const signed char safe_stones[BOARDMAX],
+do_compute_influence(const struct influence_data *base,
+		     const signed char safe_stones[BOARDMAX],
 		     const signed char inhibited_sources[BOARDMAX],
     		     const float strength[BOARDMAX], struct influence_data *q,
 		     int move, const char *trace_message)
@@ -1117,17 +1361,48 @@ do_compute_influence(const signed char safe_stones[BOARDMAX],
   find_influence_patterns(q);
   modify_depth_values(1 - stackp);
   
-  for (ii = BOARDMIN; ii < BOARDMAX; ii++)
-    if (ON_BOARD(ii) && !(inhibited_sources && inhibited_sources[ii])) {
-      if (q->white_strength[ii] > 0.0)
-	accumulate_influence(q, ii, WHITE);
-      if (q->black_strength[ii] > 0.0)
-	accumulate_influence(q, ii, BLACK);
+  if (base)
+    spread_changed_sources(base, find_influence_record(base), q);
+  else {
+    if (!inhibited_sources
+	&& (q == &initial_black_influence || q == &initial_white_influence)) {
+      int k = (q == &initial_white_influence);
+      if (!influence_records[k])
+	influence_records[k] = pool_malloc(POOL_ENGINE,
+					   sizeof(*influence_records[k]));
+      recording = influence_records[k];
+      if (recording) {
+	recording->id = 0;
+	recording->num_points = 0;
+	recording->num_blocks = 0;
+      }
     }
 
-  value_territory(q);
-  remove_double_blocks(q, inhibited_sources);
+    for (ii = BOARDMIN; ii < BOARDMAX; ii++)
+      if (ON_BOARD(ii) && !(inhibited_sources && inhibited_sources[ii])) {
+	if (q->white_strength[ii] > 0.0) {
+	  if (recording)
+	    recording->start[0][ii] = recording->num_points;
+	  accumulate_influence(q, ii, WHITE);
+	  if (recording)
+	    recording->end[0][ii] = recording->num_points;
+	}
+	if (q->black_strength[ii] > 0.0) {
+	  if (recording)
+	    recording->start[1][ii] = recording->num_points;
+	  accumulate_influence(q, ii, BLACK);
+	  if (recording)
+	    recording->end[1][ii] = recording->num_points;
+	}
+      }
+  }
 
+  remove_double_blocks(q, inhibited_sources);
+  if (recording) {
+    if (recording->num_points <= INFLUENCE_RECORD_SIZE)
+      recording->id = q->id;
+    recording = NULL;
+  }
   value_territory(q);
   
   if ((move == NO_MOVE
@@ -1178,7 +1453,45 @@ compute_influence(int color, const signed char safe_stones[BOARDMAX],
   influence_id++;
   q->id = influence_id;
 
-  do_compute_influence(safe_stones, NULL, strength,
+  do_compute_influence(NULL, safe_stones, NULL, strength,
+		       q, move, trace_message);
+
+  debug = save_debug;
+}
+
+
+/* Compute the influence after a move, like compute_influence(), but
+ * starting from the initial influence base for the position before
+ * the move, with the same color in turn. Only the influence sources
+ * whose spreading is affected by the move are spread again.
+ */
+void
+compute_move_influence(const struct influence_data *base, int color,
+		       const signed char safe_stones[BOARDMAX],
+		       const float strength[BOARDMAX],
+		       struct influence_data *q,
+		       int move, const char *trace_message)
+{
+  int save_debug = debug;
+  VALGRIND_MAKE_WRITABLE(q, sizeof(*q));
+
+  if (base->color_to_move != color
+      || !base->is_territorial_influence
+      || !find_influence_record(base)) {
+    compute_influence(color, safe_stones, strength, q, move, trace_message);
+    return;
+  }
+
+  q->is_territorial_influence = 1;
+  q->color_to_move = color;
+
+  if (move != debug_influence)
+    debug = debug &~ DEBUG_INFLUENCE;
+
+  influence_id++;
+  q->id = influence_id;
+
+  do_compute_influence(base, safe_stones, NULL, strength,
 		       q, move, trace_message);
 
   debug = save_debug;
@@ -1608,7 +1921,7 @@ compute_escape_influence(int color, const signed char safe_stones[BOARDMAX],
    * states. Better check for these, too.
    */
   static int _EMBEDDED_BSS_SMALL cached_board[BOARDMAX];
-  static signed char _EMBEDDED_BSS_SMALL escape_values[BOARDMAX][2];
+  static signed char _EMBEDDED_HOT escape_values[BOARDMAX][2];
   static int active_caches[2] = {0, 0};
 
   int cache_number = (color == WHITE);
@@ -1654,7 +1967,7 @@ compute_escape_influence(int color, const signed char safe_stones[BOARDMAX],
   if (!(debug & DEBUG_ESCAPE))
     debug &= ~DEBUG_INFLUENCE;
 
-  do_compute_influence(safe_stones, goal, strength,
+  do_compute_influence(NULL, safe_stones, goal, strength,
       		       &escape_influence, -1, NULL);
 
   debug = save_debug;
@@ -45,6 +45,14 @@ init_gnugo(float memory, unsigned int seed)
    * FIXME: Test the quality of the seed.
    */
   set_random_seed(HASH_RANDOM_SEED);
+#ifdef CONFIG_FIXED_MEMORY
+  /* The memory is the budget for all the pools, see mempool.c. By
+   * default the reading cache gets about its usual size.
+   */
+  if (memory <= 0)
+    memory = 2 * reading_cache_default_size();
+  mempool_init(NULL, memory * 1024 * 1024);
+#endif
   reading_cache_init(memory * 1024 * 1024);
   set_random_seed(seed);
   persistent_cache_init();
@@ -0,0 +1,179 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ * This is GNU Go, a Go program. Contact gnugo@gnu.org, or see       *
+ * http://www.gnu.org/software/gnugo/ for more information.          *
+ *                                                                   *
+ * Copyright 1999, 2000, 2001, 2002, 2003, 2004, 2005, 2006, 2007,   *
+ * 2008 and 2009  by the Free Software Foundation.                   *
+ *                                                                   *
+ * This program is free software; you can redistribute it and/or     *
+ * modify it under the terms of the GNU General Public License as    *
+ * published by the Free Software Foundation - version 3 or          *
+ * (at your option) any later version.                               *
+ *                                                                   *
+ * This program is distributed in the hope that it will be useful,   *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of    *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the     *
+ * GNU General Public License in file COPYING for more details.      *
+ *                                                                   *
+ * You should have received a copy of the GNU General Public         *
+ * License along with this program; if not, write to the Free        *
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,       *
+ * Boston, MA 02111, USA.                                            *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Interruptible searches.
+ *
+ * The engine has no natural points where a search could stop and
+ * return what it has found so far. Instead a search run by
+ * run_interruptible() is abandoned altogether. A trymove hook polls
+ * an interrupt callback and the flag set by interrupt_search(), and
+ * leaves the search by a longjmp(). The reading stack is then
+ * unwound, moves played on the board are taken back and the globals
+ * which the reading code changes temporarily are restored. Data
+ * computed for the position, like worms and dragons, are recomputed
+ * on demand since the position number changes.
+ *
+ * Searches without trymove() calls, like the Monte Carlo move
+ * generation, cannot be interrupted.
+ */
+
+#include "gnugo.h"
+
+#include <setjmp.h>
+#include <stdio.h>
+
+#include "liberty.h"
+#include "sgftree.h"
+
+/* Number of trymove() calls between polls of the interrupt callback. */
+#define INTERRUPT_POLL_INTERVAL 256
+
+static jmp_buf interrupt_jmp;
+static int (*interrupt_callback)(void) = NULL;
+static int interrupt_poll_counter;
+static volatile int interrupt_requested = 0;
+
+
+/* Abandon the search run by run_interruptible() at the next
+ * trymove(). This only sets a flag, so it may be called from a
+ * signal handler or another task. If no search is running, the next
+ * one is abandoned at once.
+ */
+void
+interrupt_search()
+{
+  interrupt_requested = 1;
+}
+
+
+/* The trymove hook during an interruptible search. */
+static void
+interrupt_poll(void)
+{
+  if (interrupt_requested)
+    longjmp(interrupt_jmp, 1);
+
+  if (interrupt_callback
+      && ++interrupt_poll_counter >= INTERRUPT_POLL_INTERVAL) {
+    interrupt_poll_counter = 0;
+    if (interrupt_callback())
+      longjmp(interrupt_jmp, 1);
+  }
+}
+
+
+/* Call job(data) at stackp == 0 and return 1 if it finishes, or 0 if
+ * it is abandoned because interrupt(), which may be NULL, returns
+ * nonzero or interrupt_search() is called. The job may play moves
+ * with play_move(), but must take them back before it returns.
+ *
+ * The output and tracing options and the reading parameters are the
+ * same afterwards as before, so the job is free to change them.
+ */
+int
+run_interruptible(void (*job)(void *data), void *data,
+		  int (*interrupt)(void))
+{
+  /* The statics are not clobbered by longjmp(). */
+  static int save_verbose, save_debug, save_printworms, save_printmoyo;
+  static int save_printboard, save_showtime, save_showscore;
+  static int save_count_variations, save_owl_workers;
+  static int save_owl_node_limit, save_connection_node_limit;
+  static int save_owl_reading_depth, save_depth_modification;
+  static int save_movenum;
+  static SGFTree *save_sgf_dumptree;
+  int finished = 1;
+
+  gg_assert(stackp == 0);
+
+  /* Nested searches are interrupted through the outer one. */
+  if (trymove_hook) {
+    job(data);
+    return 1;
+  }
+
+  save_verbose = verbose;
+  save_debug = debug;
+  save_printworms = printworms;
+  save_printmoyo = printmoyo;
+  save_printboard = printboard;
+  save_showtime = showtime;
+  save_showscore = showscore;
+  save_sgf_dumptree = sgf_dumptree;
+  save_count_variations = count_variations;
+  save_owl_workers = owl_workers;
+  save_owl_node_limit = owl_node_limit;
+  save_connection_node_limit = connection_node_limit;
+  save_owl_reading_depth = owl_reading_depth;
+  save_depth_modification = get_depth_modification();
+  save_movenum = movenum;
+
+  interrupt_callback = interrupt;
+  interrupt_poll_counter = 0;
+
+  if (setjmp(interrupt_jmp) == 0) {
+    trymove_hook = interrupt_poll;
+    job(data);
+  }
+  else {
+    /* Unwind the reading and take back the moves played by the job.
+     * Undoing zero moves still makes a new position number, so that
+     * half computed data of the position is not used.
+     */
+    trymove_hook = NULL;
+    while (stackp > 0)
+      popgo();
+    owl_abandon_search();
+    undo_move(movenum - save_movenum);
+    finished = 0;
+  }
+
+  trymove_hook = NULL;
+  interrupt_callback = NULL;
+  interrupt_requested = 0;
+
+  verbose = save_verbose;
+  debug = save_debug;
+  printworms = save_printworms;
+  printmoyo = save_printmoyo;
+  printboard = save_printboard;
+  showtime = save_showtime;
+  showscore = save_showscore;
+  sgf_dumptree = save_sgf_dumptree;
+  count_variations = save_count_variations;
+  owl_workers = save_owl_workers;
+  owl_node_limit = save_owl_node_limit;
+  connection_node_limit = save_connection_node_limit;
+  owl_reading_depth = save_owl_reading_depth;
+  modify_depth_values(save_depth_modification - get_depth_modification());
+
+  return finished;
+}
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * c-basic-offset: 2
+ * End:
+ */
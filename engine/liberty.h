@@ -46,6 +46,10 @@
 
 void start_timer(int n);
 double time_report(int n, const char *occupation, int move, double mintime);
+void genmove_trace_start(int color);
+int genmove_trace_phase(int phase);
+void genmove_trace_finish(int move, float value, int pondered);
+void genmove_trace_enable(int enable);
 void showstats(void);
 void clearstats(void);
 
@@ -163,6 +167,7 @@ const char *status_to_string(enum dragon_status status);
 /* Forward struct declarations. */
 struct pattern;
 struct pattern_db;
+struct joint_pattern_db;
 struct fullboard_pattern;
 struct corner_pattern;
 struct corner_db;
@@ -189,10 +194,20 @@ void matchpat(matchpat_callback_fn_ptr callback, int color,
 void matchpat_goal_anchor(matchpat_callback_fn_ptr callback, int color,
 	      struct pattern_db *pdb, void *callback_data,
 	      signed char goal[BOARDMAX], int anchor_in_goal);
+
+/* Callback, callback data and goal for one database of a joint match. */
+struct joint_match {
+  matchpat_callback_fn_ptr callback;
+  void *callback_data;
+  signed char *goal;
+};
+void matchpat_joint(int color, struct joint_pattern_db *jdb,
+		    struct joint_match match[]);
 void fullboard_matchpat(fullboard_matchpat_callback_fn_ptr callback,
 			int color, struct fullboard_pattern *pattern);
 void corner_matchpat(corner_matchpat_callback_fn_ptr callback, int color,
 		     struct corner_db *database);
+int pattern_constraint(struct pattern *pattern, int ll, int move, int color);
 void dfa_match_init(void);
 
 void reading_cache_init(int bytes);
@@ -219,11 +234,15 @@ int simple_ladder(int str, int *move);
 #define MOVE_ORDERING_PARAMETERS 67
 void tune_move_ordering(int params[MOVE_ORDERING_PARAMETERS]);
 void draw_reading_shadow(void);
+int get_reading_cached_results(void);
 
 /* persistent.c */
 void persistent_cache_init(void);
 void purge_persistent_caches(void);
 void clear_persistent_caches(void);
+int persistent_cache_serial(void);
+int export_persistent_owl_cache(int serial, void *buffer);
+void import_persistent_owl_cache(const void *buffer, int size);
 
 int search_persistent_reading_cache(enum routine_id routine, int str,
 				    int *result, int *move);
@@ -341,6 +360,13 @@ int movelist_move_known(int move, int max_points, int points[], int codes[]);
 void movelist_change_point(int move, int code, int max_points, 
 			   int points[], int codes[]);
 
+/* parallel.c */
+#define PARALLEL_MAX_RESULT_SIZE 1024
+typedef void (*parallel_job_fn)(int job, void *result);
+int use_worker_processes(int workers);
+void run_parallel_jobs(int num_jobs, int workers, parallel_job_fn job,
+		       void *results, int result_size);
+
 /* surround.c */
 int compute_surroundings(int pos, int apos, int showboard,
 			 int *surround_size);
@@ -438,6 +464,9 @@ int owl_eye_size(int pos);
 int owl_lunch(int str);
 int owl_strong_dragon(int pos);
 void owl_reasons(int color);
+void add_owl_query(enum routine_id routine, int move, int target,
+		   int target2);
+void read_owl_queries(void);
 
 void unconditional_life(int unconditional_territory[BOARDMAX], int color);
 void clear_unconditionally_meaningless_moves(void);
@@ -497,6 +526,9 @@ int aftermath_genmove(int color, int do_capture_dead_stones,
 		      int allowed_moves[BOARDMAX]);
 enum dragon_status aftermath_final_status(int color, int pos);
 
+int load_pattern_image(const void *image, size_t size);
+int load_pattern_file(const char *filename);
+
 #ifndef CONFIG_DISABLE_MONTE_CARLO
 int mc_get_size_of_pattern_values_table(void);
 int mc_load_patterns_from_db(const char *filename, unsigned int *values);
@@ -526,6 +558,7 @@ void owl_analyze_semeai_after_move(int move, int color, int apos, int bpos,
 				   int *semeai_move, int owl,
 				   int *semeai_result_certain,
 				   int recompute_dragons);
+void owl_abandon_search(void);
 
 void set_limit_search(int value);
 void set_search_diamond(int pos);
@@ -541,6 +574,7 @@ int metamachine_genmove(int color, float *value);
 void draw_search_area(void);
 
 int genmove_restricted(int color, int allowed_moves[BOARDMAX]);
+int ponder_lookup(int color, int *move, float *value, int *resign);
 
 void change_attack(int str, int move, int acode);
 void change_defense(int str, int move, int dcode);
@@ -630,6 +664,11 @@ void compute_influence(int color, const signed char safe_stones[BOARDMAX],
 		       const float strength[BOARDMAX],
 		       struct influence_data *q,
 		       int move, const char *trace_message);
+void compute_move_influence(const struct influence_data *base, int color,
+			    const signed char safe_stones[BOARDMAX],
+			    const float strength[BOARDMAX],
+			    struct influence_data *q,
+			    int move, const char *trace_message);
 void compute_followup_influence(const struct influence_data *base,
 			        struct influence_data *q, 
 		                int move, const char *trace_message);
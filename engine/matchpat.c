@@ -129,6 +129,226 @@ report_pattern_profiling()
 
 
 
+/**************************************************************************/
+/* Pattern database statistics:                                           */
+/**************************************************************************/
+
+/* Unlike pattern profiling, which counts matches per pattern and must
+ * be compiled in, these statistics are always available and are
+ * collected per database once reset_pattern_statistics() has been
+ * called. Times include the callbacks, and the constraints evaluated
+ * by the callbacks. The owl code evaluates most constraints after the
+ * matching, though.
+ */
+struct pattern_statistics {
+  const char *name;
+  struct pattern_db *pdb;
+  struct joint_pattern_db *jdb;
+
+  /* The patterns of pdb, for finding the database of a pattern. */
+  struct pattern *patterns;
+  int num_patterns;
+
+  int calls;			/* Calls of matchpat(). */
+  int anchors;			/* Anchor positions tried. */
+  int dfa_hits;			/* Patterns found by the DFA scan. */
+  int matches;			/* Callbacks. */
+  int callback_nodes;		/* Reading nodes spent in callbacks. */
+  int constraints;		/* Constraint evaluations. */
+  int constraint_nodes;		/* Reading nodes spent in constraints. */
+  double time;			/* Seconds spent in matchpat(). */
+  double callback_time;
+  double constraint_time;
+};
+
+static struct pattern_statistics db_statistics[] = {
+  {"pat",		&pat_db,		NULL, NULL, 0, 0,0,0,0,0,0,0, 0,0,0},
+  {"attpat",		&attpat_db,		NULL, NULL, 0, 0,0,0,0,0,0,0, 0,0,0},
+  {"defpat",		&defpat_db,		NULL, NULL, 0, 0,0,0,0,0,0,0, 0,0,0},
+  {"endpat",		&endpat_db,		NULL, NULL, 0, 0,0,0,0,0,0,0, 0,0,0},
+  {"conn",		&conn_db,		NULL, NULL, 0, 0,0,0,0,0,0,0, 0,0,0},
+  {"influencepat",	&influencepat_db,	NULL, NULL, 0, 0,0,0,0,0,0,0, 0,0,0},
+  {"barrierspat",	&barrierspat_db,	NULL, NULL, 0, 0,0,0,0,0,0,0, 0,0,0},
+  {"fusekipat",		&fusekipat_db,		NULL, NULL, 0, 0,0,0,0,0,0,0, 0,0,0},
+  {"handipat",		&handipat_db,		NULL, NULL, 0, 0,0,0,0,0,0,0, 0,0,0},
+  {"aa_attackpat",	&aa_attackpat_db,	NULL, NULL, 0, 0,0,0,0,0,0,0, 0,0,0},
+  {"owl_attackpat",	&owl_attackpat_db,	NULL, NULL, 0, 0,0,0,0,0,0,0, 0,0,0},
+  {"owl_defendpat",	&owl_defendpat_db,	NULL, NULL, 0, 0,0,0,0,0,0,0, 0,0,0},
+  {"owl_vital_apat",	&owl_vital_apat_db,	NULL, NULL, 0, 0,0,0,0,0,0,0, 0,0,0},
+#if ORACLE
+  {"oracle",		&oracle_db,		NULL, NULL, 0, 0,0,0,0,0,0,0, 0,0,0},
+#endif
+  {"owl_shapes",	NULL,		&owl_shapes_db, NULL, 0, 0,0,0,0,0,0,0, 0,0,0},
+  {NULL,		NULL,			NULL, NULL, 0, 0,0,0,0,0,0,0, 0,0,0}
+};
+
+/* Nonzero when statistics are collected. */
+static int collect_pattern_statistics = 0;
+
+/* Statistics of the database currently being matched, or NULL. */
+static struct pattern_statistics *current_statistics = NULL;
+
+
+/* Clear the pattern database statistics and start collecting them. */
+void
+reset_pattern_statistics(void)
+{
+  struct pattern_statistics *s;
+
+  for (s = db_statistics; s->name; s++) {
+    s->patterns = NULL;
+    s->num_patterns = 0;
+    s->calls = 0;
+    s->anchors = 0;
+    s->dfa_hits = 0;
+    s->matches = 0;
+    s->callback_nodes = 0;
+    s->constraints = 0;
+    s->constraint_nodes = 0;
+    s->time = 0.0;
+    s->callback_time = 0.0;
+    s->constraint_time = 0.0;
+  }
+
+  collect_pattern_statistics = 1;
+}
+
+
+/* Print the pattern database statistics, as a table or as comma
+ * separated values with a header line. Databases which have not been
+ * used are left out of the table.
+ */
+void
+print_pattern_statistics(FILE *outfile, int csv)
+{
+  struct pattern_statistics *s;
+
+  if (csv)
+    fprintf(outfile, "database,calls,anchors,dfa_hits,matches,callback_nodes,"
+	    "constraints,constraint_nodes,time_us,callback_time_us,"
+	    "constraint_time_us\n");
+  else
+    fprintf(outfile, "%-15s %7s %9s %9s %8s %9s %8s %9s %9s %9s %9s\n",
+	    "database", "calls", "anchors", "dfa_hits", "matches", "cb_nodes",
+	    "constr", "co_nodes", "time_ms", "cb_ms", "co_ms");
+
+  for (s = db_statistics; s->name; s++) {
+    if (csv)
+      fprintf(outfile, "%s,%d,%d,%d,%d,%d,%d,%d,%.0f,%.0f,%.0f\n",
+	      s->name, s->calls, s->anchors, s->dfa_hits, s->matches,
+	      s->callback_nodes, s->constraints, s->constraint_nodes,
+	      1e6 * s->time, 1e6 * s->callback_time, 1e6 * s->constraint_time);
+    else if (s->calls > 0 || s->matches > 0 || s->constraints > 0)
+      fprintf(outfile, "%-15s %7d %9d %9d %8d %9d %8d %9d %9.1f %9.1f %9.1f\n",
+	      s->name, s->calls, s->anchors, s->dfa_hits, s->matches,
+	      s->callback_nodes, s->constraints, s->constraint_nodes,
+	      1e3 * s->time, 1e3 * s->callback_time, 1e3 * s->constraint_time);
+  }
+}
+
+
+static struct pattern_statistics *
+find_db_statistics(struct pattern_db *pdb, struct joint_pattern_db *jdb)
+{
+  struct pattern_statistics *s;
+
+  for (s = db_statistics; s->name; s++)
+    if ((pdb && s->pdb == pdb) || (jdb && s->jdb == jdb))
+      return s;
+
+  return NULL;
+}
+
+
+/* Find the database a pattern belongs to. */
+static struct pattern_statistics *
+find_pattern_statistics(struct pattern *pattern)
+{
+  struct pattern_statistics *s;
+
+  for (s = db_statistics; s->name; s++) {
+    if (!s->pdb)
+      continue;
+
+    /* The patterns may have been replaced by load_pattern_file(). */
+    if (s->patterns != s->pdb->patterns) {
+      s->patterns = s->pdb->patterns;
+      for (s->num_patterns = 0; s->patterns[s->num_patterns].patn;
+	   s->num_patterns++)
+	;
+    }
+
+    if (pattern >= s->patterns && pattern < s->patterns + s->num_patterns)
+      return s;
+  }
+
+  return NULL;
+}
+
+
+/* Call back to the invoker of matchpat() for a matched pattern,
+ * counting the match.
+ */
+static void
+pattern_callback(matchpat_callback_fn_ptr callback, int anchor, int color,
+		 struct pattern *pattern, int ll, void *callback_data)
+{
+  struct pattern_statistics *s = current_statistics;
+  int nodes_before;
+  double time_before;
+
+  if (!s) {
+    callback(anchor, color, pattern, ll, callback_data);
+    return;
+  }
+
+  nodes_before = stats.nodes;
+  time_before = gg_gettimeofday();
+
+  callback(anchor, color, pattern, ll, callback_data);
+
+  s->matches++;
+  s->callback_nodes += stats.nodes - nodes_before;
+  s->callback_time += gg_gettimeofday() - time_before;
+  current_statistics = s;
+}
+
+
+/* Evaluate the constraint of a pattern. All pattern constraints
+ * should be evaluated through this function, so that they are
+ * counted in the pattern database statistics.
+ */
+int
+pattern_constraint(struct pattern *pattern, int ll, int move, int color)
+{
+  struct pattern_statistics *s;
+  struct pattern_statistics *saved_statistics;
+  int nodes_before;
+  double time_before;
+  int result;
+
+  if (!collect_pattern_statistics)
+    return pattern->autohelper(ll, move, color, 0);
+
+  s = find_pattern_statistics(pattern);
+  saved_statistics = current_statistics;
+  nodes_before = stats.nodes;
+  time_before = gg_gettimeofday();
+
+  result = pattern->autohelper(ll, move, color, 0);
+
+  if (s) {
+    s->constraints++;
+    s->constraint_nodes += stats.nodes - nodes_before;
+    s->constraint_time += gg_gettimeofday() - time_before;
+  }
+  current_statistics = saved_statistics;
+
+  return result;
+}
+
+
+
 /**************************************************************************/
 /* Standard matcher:                                                      */
 /**************************************************************************/
@@ -476,7 +696,7 @@ do_matchpat(int anchor, matchpat_callback_fn_ptr callback, int color,
 #endif
 	
 	/* A match!  - Call back to the invoker to let it know. */
-	callback(anchor, color, pattern, ll, callback_data);
+	pattern_callback(callback, anchor, color, pattern, ll, callback_data);
 
 #if PROFILE_PATTERNS
 	pattern->reading_nodes += stats.nodes - nodes_before;
@@ -507,9 +727,12 @@ matchpat_loop(matchpat_callback_fn_ptr callback, int color, int anchor,
   int pos;
   
   for (pos = BOARDMIN; pos < BOARDMAX; pos++) {
-    if (board[pos] == anchor && (!anchor_in_goal || goal[pos] != 0))
+    if (board[pos] == anchor && (!anchor_in_goal || goal[pos] != 0)) {
+      if (current_statistics)
+	current_statistics->anchors++;
       do_matchpat(pos, callback, color, pdb->patterns,
 		  callback_data, goal);
+    }
   }
 }
 
@@ -523,7 +746,7 @@ matchpat_loop(matchpat_callback_fn_ptr callback, int color, int anchor,
 
 /* Data. */
 static int dfa_board_size = -1;
-static int _EMBEDDED_BSS dfa_p[DFA_BASE * DFA_BASE];
+static int _EMBEDDED_HOT dfa_p[DFA_BASE * DFA_BASE];
 
 /* This is used by the EXPECTED_COLOR macro. */
 static const int convert[3][4] = {
@@ -553,6 +776,8 @@ static void dfa_matchpat_loop(matchpat_callback_fn_ptr callback,
 			      int color, int anchor,
 			      struct pattern_db *pdb, void *callback_data,
 			      signed char goal[BOARDMAX], int anchor_in_goal);
+static void do_dfa_matchpat_joint(struct joint_pattern_db *jdb, int anchor,
+				  int color, struct joint_match match[]);
 
 
 /***********************************************************************/
@@ -587,6 +812,8 @@ dfa_match_init(void)
     DEBUG(DEBUG_MATCHER, "barrierspat --> using dfa\n");
   if (fusekipat_db.pdfa != NULL)
     DEBUG(DEBUG_MATCHER, "barrierspat --> using dfa\n");
+  if (owl_shapes_db.pdfa != NULL)
+    DEBUG(DEBUG_MATCHER, "owl_shapes --> using joint dfa\n");
 
   /* force out_board initialization */
   dfa_board_size = -1;
@@ -710,6 +937,8 @@ do_dfa_matchpat(dfa_rt_t *pdfa,
 #if PROFILE_PATTERNS
     database[matched].dfa_hits++;
 #endif
+    if (current_statistics)
+      current_statistics->dfa_hits++;
 
     check_pattern_light(anchor, callback, color, database + matched,
 			ll, callback_data, goal, anchor_in_goal);
@@ -785,7 +1014,7 @@ check_pattern_light(int anchor, matchpat_callback_fn_ptr callback, int color,
 #endif
   
   /* A match!  - Call back to the invoker to let it know. */
-  callback(anchor, color, pattern, ll, callback_data);
+  pattern_callback(callback, anchor, color, pattern, ll, callback_data);
   
 #if PROFILE_PATTERNS
   pattern->reading_nodes += stats.nodes - nodes_before;
@@ -812,14 +1041,84 @@ dfa_matchpat_loop(matchpat_callback_fn_ptr callback, int color, int anchor,
   int pos;
 
   for (pos = BOARDMIN; pos < BOARDMAX; pos++) {
-    if (board[pos] == anchor && (!anchor_in_goal || goal[pos] != 0))
+    if (board[pos] == anchor && (!anchor_in_goal || goal[pos] != 0)) {
+      if (current_statistics)
+	current_statistics->anchors++;
       do_dfa_matchpat(pdb->pdfa, pos, callback, color, pdb->patterns,
 		      callback_data, goal, anchor_in_goal);
+    }
   }
 }
 
 
 
+/* Perform pattern matching for all databases of a joint DFA with a
+ * single scan at `anchor'.
+ */
+static void
+do_dfa_matchpat_joint(struct joint_pattern_db *jdb, int anchor, int color,
+		      struct joint_match match[])
+{
+  int k;
+  int ll;      /* Iterate over transformations (rotations or reflections)  */
+  int patterns[DFA_MAX_MATCHED + 8];
+  int num_matched = 0;
+  int *dfa_pos = dfa_p + DFA_POS(I(anchor), J(anchor));
+  struct pattern_statistics *saved_statistics = current_statistics;
+
+  /* Basic sanity checks. */
+  ASSERT_ON_BOARD1(anchor);
+
+  /* One scan by transformation */
+  for (ll = 0; ll < 8; ll++) {
+    num_matched += scan_for_patterns(jdb->pdfa, ll, dfa_pos,
+				     patterns + num_matched);
+    patterns[num_matched++] = -1;
+  }
+
+  ASSERT1(num_matched <= DFA_MAX_MATCHED + 8, anchor);
+
+  /* Dispatch each match to the database it belongs to. */
+  for (ll = 0, k = 0; ll < 8; k++) {
+    int db;
+    struct pattern_db *pdb;
+    struct pattern *pattern;
+
+    if (patterns[k] == -1) {
+      ll++;
+      continue;
+    }
+
+    db = DFA_JOINT_DB(patterns[k]);
+    if (match[db].callback == NULL)
+      continue;
+
+    pdb = jdb->dbs[db];
+    if (pdb->fixed_anchor && match[db].goal[anchor] == 0)
+      continue;
+
+    pattern = pdb->patterns + DFA_JOINT_INDEX(patterns[k]);
+
+#if PROFILE_PATTERNS
+    pattern->dfa_hits++;
+#endif
+
+    /* Count the hits and matches for the individual database. */
+    if (collect_pattern_statistics) {
+      current_statistics = find_db_statistics(pdb, NULL);
+      if (current_statistics)
+	current_statistics->dfa_hits++;
+    }
+
+    check_pattern_light(anchor, match[db].callback, color, pattern, ll,
+			match[db].callback_data, match[db].goal,
+			pdb->fixed_anchor);
+  }
+
+  current_statistics = saved_statistics;
+}
+
+
 /**************************************************************************/
 /* Main functions:                                                        */
 /**************************************************************************/
@@ -858,6 +1157,16 @@ matchpat_goal_anchor(matchpat_callback_fn_ptr callback, int color,
 {
   loop_fn_ptr_t loop = matchpat_loop;
   prepare_fn_ptr_t prepare = prepare_for_match;
+  struct pattern_statistics *saved_statistics = current_statistics;
+  double time_before = 0.0;
+
+  if (collect_pattern_statistics) {
+    current_statistics = find_db_statistics(pdb, NULL);
+    if (current_statistics) {
+      current_statistics->calls++;
+      time_before = gg_gettimeofday();
+    }
+  }
 
   /* check board size */
   if (pdb->fixed_for_size != board_size) {
@@ -896,6 +1205,73 @@ matchpat_goal_anchor(matchpat_callback_fn_ptr callback, int color,
 	loop(callback, color, BLACK, pdb, callback_data, goal, anchor_in_goal);
       }
   }
+
+  if (current_statistics)
+    current_statistics->time += gg_gettimeofday() - time_before;
+  current_statistics = saved_statistics;
+}
+
+
+
+/* Match several pattern databases for `color' in a single scan of the
+ * board, using the joint DFA of `jdb'. match[k] holds the callback,
+ * callback data and goal for database k of `jdb'. Databases with a
+ * NULL callback are not matched.
+ *
+ * For each database the callbacks come in the same order as from
+ * matchpat(), but callbacks of different databases are interleaved.
+ * Thus the callbacks should not depend on each other, e.g. just
+ * collect the matched patterns for later evaluation.
+ */
+void
+matchpat_joint(int color, struct joint_pattern_db *jdb,
+	       struct joint_match match[])
+{
+  int k;
+  int anchor;
+  int pos;
+  struct pattern_statistics *statistics = NULL;
+  double time_before = 0.0;
+
+  gg_assert(color == WHITE || color == BLACK);
+
+  /* Without a joint DFA, match the databases one by one. */
+  if (jdb->pdfa == NULL) {
+    for (k = 0; k < jdb->num_dbs; k++)
+      if (match[k].callback != NULL)
+	matchpat(match[k].callback, color, jdb->dbs[k],
+		 match[k].callback_data, match[k].goal);
+    return;
+  }
+
+  if (collect_pattern_statistics) {
+    statistics = find_db_statistics(NULL, jdb);
+    if (statistics) {
+      statistics->calls++;
+      time_before = gg_gettimeofday();
+    }
+  }
+
+  /* check board size */
+  for (k = 0; k < jdb->num_dbs; k++) {
+    struct pattern_db *pdb = jdb->dbs[k];
+    if (pdb->fixed_for_size != board_size) {
+      fixup_patterns_for_board_size(pdb->patterns);
+      pdb->fixed_for_size = board_size;
+    }
+  }
+
+  dfa_prepare_for_match(color);
+  for (anchor = WHITE; anchor <= BLACK; anchor++)
+    for (pos = BOARDMIN; pos < BOARDMAX; pos++)
+      if (board[pos] == anchor) {
+	if (statistics)
+	  statistics->anchors++;
+	do_dfa_matchpat_joint(jdb, pos, color, match);
+      }
+
+  if (statistics)
+    statistics->time += gg_gettimeofday() - time_before;
 }
 
 
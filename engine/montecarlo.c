@@ -1275,8 +1275,8 @@ mc_load_patterns_from_db(const char *filename, unsigned int *values)
     return 0;
   }
 
-  matching_geometries = malloc((NUM_GEOMETRIES + 1)
-			       * sizeof(*matching_geometries));
+  matching_geometries = pool_malloc(POOL_MONTE_CARLO, (NUM_GEOMETRIES + 1)
+				    * sizeof(*matching_geometries));
 
   /* Set unloaded patterns to a "-1" value. */
   for (k = 1; k <= NUM_GEOMETRIES; k++)
@@ -1344,7 +1344,7 @@ mc_load_patterns_from_db(const char *filename, unsigned int *values)
       if (values[k * NUM_PROPERTIES + m] == 0xffffffffU)
 	values[k * NUM_PROPERTIES + m] = 1;
 
-  free(matching_geometries);
+  pool_free(matching_geometries);
   return 1;
 }
 
@@ -2112,6 +2112,40 @@ uct_dump_tree(struct uct_tree *tree, const char *filename, int color,
 }
 
 
+/* Free the arrays of the tree, in reverse order, which leaves a
+ * memory pool unfragmented.
+ */
+static void
+uct_free_tree(struct uct_tree *tree)
+{
+  pool_free(tree->hashtable_even);
+  pool_free(tree->hashtable_odd);
+  pool_free(tree->arcs);
+  pool_free(tree->nodes);
+}
+
+/* Allocate the arrays of a tree with the given number of nodes.
+ * Returns 0, with nothing allocated, if there is not enough memory.
+ */
+static int
+uct_alloc_tree(struct uct_tree *tree, int nodes)
+{
+  tree->nodes = pool_malloc(POOL_MONTE_CARLO, nodes * sizeof(*tree->nodes));
+  tree->arcs = pool_malloc(POOL_MONTE_CARLO, nodes * sizeof(*tree->arcs));
+  tree->hashtable_size = nodes;
+  tree->hashtable_odd = pool_calloc(POOL_MONTE_CARLO, nodes,
+				    sizeof(*tree->hashtable_odd));
+  tree->hashtable_even = pool_calloc(POOL_MONTE_CARLO, nodes,
+				     sizeof(*tree->hashtable_even));
+  if (tree->nodes && tree->arcs
+      && tree->hashtable_odd && tree->hashtable_even)
+    return 1;
+
+  uct_free_tree(tree);
+  return 0;
+}
+
+
 void
 uct_genmove(int color, int *move, int *forbidden_moves, int *allowed_moves,
 	    int nodes, float *move_values, int *move_frequencies)
@@ -2138,18 +2172,13 @@ uct_genmove(int color, int *move, int *forbidden_moves, int *allowed_moves,
     starting_position.settled[pos] = forbidden_moves[pos];
 
   tree.game = starting_position;
-  /* FIXME: Don't reallocate between moves. */
-  tree.nodes = malloc(nodes * sizeof(*tree.nodes));
-  gg_assert(tree.nodes);
-  tree.arcs = malloc(nodes * sizeof(*tree.arcs));
-  gg_assert(tree.arcs);
-  tree.hashtable_size = nodes;
-  tree.hashtable_odd = calloc(tree.hashtable_size,
-			      sizeof(*tree.hashtable_odd));
-  tree.hashtable_even = calloc(tree.hashtable_size,
-			       sizeof(*tree.hashtable_even));
-  gg_assert(tree.hashtable_odd);
-  gg_assert(tree.hashtable_even);
+  /* FIXME: Don't reallocate between moves. With fixed memory pools
+   * the tree may have to be smaller than asked for.
+   */
+  while (!uct_alloc_tree(&tree, nodes)) {
+    gg_assert(nodes > 100);
+    nodes /= 2;
+  }
   tree.num_nodes = nodes;
   tree.num_arcs = nodes;
   tree.num_used_nodes = 0;
@@ -2248,10 +2277,7 @@ uct_genmove(int color, int *move, int *forbidden_moves, int *allowed_moves,
     }
   }
   
-  free(tree.nodes);
-  free(tree.arcs);
-  free(tree.hashtable_odd);
-  free(tree.hashtable_even);
+  uct_free_tree(&tree);
 }
 
 
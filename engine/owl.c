@@ -68,24 +68,29 @@
                       /*    not called                                       */
 
 struct local_owl_data {
-  signed char goal[BOARDMAX];
-  signed char boundary[BOARDMAX];
+  /* The goal, cumulative_goal and boundary arrays are shared with the
+   * previous stack entry until they are modified, see
+   * owl_goal_writable() and owl_boundary_writable().
+   */
+  signed char *goal;
+  signed char *boundary;
   /* Same as goal, except never anything is removed from it. */
-  signed char cumulative_goal[BOARDMAX];
+  signed char *cumulative_goal;
 
-  /* FIXME: neighbors[] and escape_values[] are never recomputed.
-   *	    Consider moving these arrays from stack to a static or
-   *	    dynamic variable so it is not copied around in
-   *	    do_push_owl().  Be aware of semeai code though.
+  /* neighbors[] and escape_values[] are only computed when the owl
+   * data is initialized and are shared by all stack entries pushed
+   * on top of it, see owl_root_data below.
    */
-  signed char neighbors[BOARDMAX];
-
-  signed char escape_values[BOARDMAX];
+  signed char *neighbors;
+  signed char *escape_values;
   int color;
 
-  struct eye_data my_eye[BOARDMAX];
+  /* Normally points to own_eye and own_half_eye, but may be shared
+   * with the previous stack entry, see do_owl_defend().
+   */
+  struct eye_data *my_eye;
   /* array of half-eye data for use during owl reading */
-  struct half_eye_data half_eye[BOARDMAX];
+  struct half_eye_data *half_eye;
   
   int lunch[MAX_LUNCHES];
   int lunch_attack_code[MAX_LUNCHES];
@@ -100,8 +105,28 @@ struct local_owl_data {
 
   /* This is used to organize the owl stack. */
   struct local_owl_data *restore_from;
+
+  /* Storage for the arrays above, used when they are not shared. */
+  signed char own_goal[BOARDMAX];
+  signed char own_boundary[BOARDMAX];
+  signed char own_cumulative_goal[BOARDMAX];
+  struct eye_data own_eye[BOARDMAX];
+  struct half_eye_data own_half_eye[BOARDMAX];
+};
+
+/* There are at most two sets of owl data initialized at the same
+ * time, at the bottom of the owl stack (see init_owl()). Their
+ * neighbors and escape values are kept here.
+ */
+#define MAX_OWL_ROOTS 2
+
+struct owl_root_data {
+  signed char neighbors[BOARDMAX];
+  signed char escape_values[BOARDMAX];
 };
 
+static struct owl_root_data _EMBEDDED_HOT owl_root_data[MAX_OWL_ROOTS];
+
 
 static int result_certain;
 
@@ -158,6 +183,11 @@ struct matched_pattern_data {
   int next_pattern_index;
 };
   
+struct owl_arena_mark {
+  int chunk;
+  int used;
+};
+
 struct matched_patterns_list_data {
   int initialized;
   int counter; 		/* Number of patterns in the list. */
@@ -168,6 +198,9 @@ struct matched_patterns_list_data {
 
   int heap_num_patterns;
   struct matched_pattern_data **pattern_heap;
+
+  /* Position of the owl arena when the list was initialized. */
+  struct owl_arena_mark arena_mark;
 };
 
 void dump_pattern_list(struct matched_patterns_list_data *list);
@@ -180,6 +213,12 @@ static int do_owl_defend(int str, int *move, int *wormid,
 static void owl_shapes(struct matched_patterns_list_data *list,
                        struct owl_move_data moves[MAX_MOVES], int color,
 		       struct local_owl_data *owl, struct pattern_db *type);
+static void owl_shapes_semeai(struct matched_patterns_list_data *defense_list,
+			      struct owl_move_data defense_moves[MAX_MOVES],
+			      struct matched_patterns_list_data *attack_list,
+			      struct owl_move_data attack_moves[MAX_MOVES],
+			      int color, struct local_owl_data *owla,
+			      struct local_owl_data *owlb);
 static void collect_owl_shapes_callbacks(int anchor, int color,
 	  			         struct pattern *pattern_db,
 				         int ll, void *data);
@@ -194,6 +233,10 @@ static int get_next_move_from_list(struct matched_patterns_list_data *list,
                                    int color, struct owl_move_data *moves,
 				   int cutoff, struct local_owl_data *owl);
 static void init_pattern_list(struct matched_patterns_list_data *list);
+static void *owl_arena_alloc(int size);
+static void *owl_arena_grow(void *ptr, int old_size, int new_size);
+static void owl_arena_get_mark(struct owl_arena_mark *mark);
+static void owl_arena_release(const struct owl_arena_mark *mark);
 static void close_pattern_list(int color,
 			       struct matched_patterns_list_data *list);
 static void owl_shapes_callback(int anchor, int color,
@@ -291,7 +334,7 @@ static int find_semeai_backfilling_move(int worm, int liberty);
 static int liberty_of_goal(int pos, struct local_owl_data *owl);
 static int second_liberty_of_goal(int pos, struct local_owl_data *owl);
 static int matches_found;
-static signed char _EMBEDDED_BSS found_matches[BOARDMAX];
+static signed char _EMBEDDED_HOT found_matches[BOARDMAX];
 
 static void reduced_init_owl(struct local_owl_data **owl,
     			     int at_bottom_of_stack);
@@ -305,6 +348,8 @@ static void check_owl_stack_size(void);
 static void push_owl(struct local_owl_data **owl);
 static void do_push_owl(struct local_owl_data **owl);
 static void pop_owl(struct local_owl_data **owl);
+static void owl_goal_writable(struct local_owl_data *owl);
+static void owl_boundary_writable(struct local_owl_data *owl);
 
 #if 0
 static int catalog_goal(struct local_owl_data *owl,
@@ -889,10 +934,19 @@ do_owl_analyze_semeai(int apos, int bpos,
 			 move, PASS_MOVE, WIN, 0);
     }
     
-    /* Next the shape moves. */
+    /* Next the shape moves. If we need both defense and attack
+     * patterns, they are matched in one scan of the board.
+     */
+    if (!I_look_alive && !you_look_alive)
+      owl_shapes_semeai(&shape_defensive_patterns, shape_defensive_moves,
+			&shape_offensive_patterns, shape_offensive_moves,
+			color, owla, owlb);
+
     if (!I_look_alive) {
-      owl_shapes(&shape_defensive_patterns, shape_defensive_moves, color,
-		 owla, &owl_defendpat_db);
+      if (you_look_alive)
+	owl_shapes(&shape_defensive_patterns, shape_defensive_moves, color,
+		   owla, &owl_defendpat_db);
+      current_owl_data = owla;
       for (k = 0; k < MAX_MOVES-1; k++)
 	if (!get_next_move_from_list(&shape_defensive_patterns, color,
 				     shape_defensive_moves, 1, owla))
@@ -902,8 +956,10 @@ do_owl_analyze_semeai(int apos, int bpos,
       shape_defensive_moves[0].pos = NO_MOVE;
 
     if (!you_look_alive) {
-      owl_shapes(&shape_offensive_patterns, shape_offensive_moves, color,
-		 owlb, &owl_attackpat_db);
+      if (I_look_alive)
+	owl_shapes(&shape_offensive_patterns, shape_offensive_moves, color,
+		   owlb, &owl_attackpat_db);
+      current_owl_data = owlb;
       for (k = 0; k < MAX_MOVES-1; k++)
 	if (!get_next_move_from_list(&shape_offensive_patterns, color,
 				     shape_offensive_moves, 1, owlb))
@@ -2354,6 +2410,7 @@ do_owl_attack(int str, int *move, int *wormid,
 
       /* Test whether the move cut the goal dragon apart. */
       if (moves[k].cuts[0] != NO_MOVE && origin != NO_MOVE) {
+	owl_goal_writable(owl);
 	owl_test_cuts(owl->goal, owl->color, moves[k].cuts);
 	if (!owl->goal[origin])
 	  origin = select_new_goal_origin(origin, owl);
@@ -2771,12 +2828,13 @@ do_owl_defend(int str, int *move, int *wormid, struct local_owl_data *owl,
   }
   else {
     /* In this case we don't recompute eyes. However, to avoid accessing
-     * partially-random data left on stack, we copy eye data from the
+     * partially-random data left on stack, we use the eye data from the
      * previous depth level. It should be reasonably close to the actual
-     * state of eyes.
+     * state of eyes. The data is only read in this node, so it can be
+     * shared rather than copied.
      */
-    memcpy(owl->my_eye, owl->restore_from->my_eye, sizeof(owl->my_eye));
-    memcpy(owl->half_eye, owl->restore_from->half_eye, sizeof(owl->half_eye));
+    owl->my_eye = owl->restore_from->my_eye;
+    owl->half_eye = owl->restore_from->half_eye;
 
     vital_moves[0].pos = 0;
     vital_moves[0].value = -1;
@@ -3795,6 +3853,51 @@ owl_shapes(struct matched_patterns_list_data *pattern_list,
 }
 
 
+/* Same as owl_shapes() with owl_defendpat_db for `owla' and with
+ * owl_attackpat_db for `owlb', but both databases are matched in a
+ * single scan of the board. current_owl_data must be set to the
+ * right owl data before moves are taken from either list.
+ */
+static void
+owl_shapes_semeai(struct matched_patterns_list_data *defense_list,
+		  struct owl_move_data defense_moves[MAX_MOVES],
+		  struct matched_patterns_list_data *attack_list,
+		  struct owl_move_data attack_moves[MAX_MOVES],
+		  int color, struct local_owl_data *owla,
+		  struct local_owl_data *owlb)
+{
+  SGFTree *save_sgf_dumptree = sgf_dumptree;
+  int save_count_variations = count_variations;
+  struct joint_match match[2];
+
+  /* The order of the databases is given by `mkpat -J owl_shapes'. */
+  gg_assert(owl_shapes_db.dbs[0] == &owl_defendpat_db);
+  gg_assert(owl_shapes_db.dbs[1] == &owl_attackpat_db);
+
+  sgf_dumptree = NULL;
+  count_variations = 0;
+
+  clear_owl_move_data(defense_moves);
+  clear_owl_move_data(attack_moves);
+
+  memset(owla->safe_move_cache, 0, sizeof(owla->safe_move_cache));
+  memset(owlb->safe_move_cache, 0, sizeof(owlb->safe_move_cache));
+  init_pattern_list(defense_list);
+  init_pattern_list(attack_list);
+
+  match[0].callback = collect_owl_shapes_callbacks;
+  match[0].callback_data = defense_list;
+  match[0].goal = owla->goal;
+  match[1].callback = collect_owl_shapes_callbacks;
+  match[1].callback_data = attack_list;
+  match[1].goal = owlb->goal;
+  matchpat_joint(color, &owl_shapes_db, match);
+
+  sgf_dumptree = save_sgf_dumptree;
+  count_variations = save_count_variations;
+}
+
+
 /* This function contains all the expensive checks for a matched pattern. */
 static int
 check_pattern_hard(int move, int color, struct pattern *pattern, int ll)
@@ -3816,7 +3919,7 @@ check_pattern_hard(int move, int color, struct pattern *pattern, int ll)
   /* If the constraint is cheap to check, we do this first. */
   if ((pattern->autohelper_flag & HAVE_CONSTRAINT)
       && pattern->constraint_cost < 0.45) {
-    if (!pattern->autohelper(ll, move, color, 0))
+    if (!pattern_constraint(pattern, ll, move, color))
       return 0;
     constraint_checked = 1;
   }
@@ -3855,16 +3958,125 @@ check_pattern_hard(int move, int color, struct pattern *pattern, int ll)
    * if the pattern must be rejected.
    */
   if ((pattern->autohelper_flag & HAVE_CONSTRAINT) && !constraint_checked)
-    if (!pattern->autohelper(ll, move, color, 0))
+    if (!pattern_constraint(pattern, ll, move, color))
       return 0;
   return 1;
 }
 
 
+/*
+ * The pattern lists and heaps are allocated from an arena. Memory is
+ * handed out from the top of the arena and given back by resetting
+ * the top to a mark taken earlier. Since the lists of a node are
+ * closed before the lists of its parent, this frees the memory in
+ * the order it was allocated, and after the first few owl searches
+ * the arena is big enough that no more heap calls are needed.
+ *
+ * The arena is a list of chunks, so that the memory already handed
+ * out never moves.
+ */
+
+#define OWL_ARENA_CHUNK_SIZE	(64 * 1024)
+#define MAX_OWL_ARENA_CHUNKS	256
+#define OWL_ARENA_ALIGN(size)	(((size) + 7) & ~7)
+
+static struct {
+  char *data;
+  int size;
+} owl_arena[MAX_OWL_ARENA_CHUNKS];
+static int owl_arena_num_chunks = 0;
+static int owl_arena_chunk = 0;	/* Chunk holding the top of the arena. */
+static int owl_arena_used = 0;	/* Bytes used in this chunk. */
+
+static void *
+owl_arena_alloc(int size)
+{
+  void *ptr;
+
+  size = OWL_ARENA_ALIGN(size);
+  if (owl_arena_chunk < owl_arena_num_chunks
+      && owl_arena_used + size <= owl_arena[owl_arena_chunk].size) {
+    ptr = owl_arena[owl_arena_chunk].data + owl_arena_used;
+    owl_arena_used += size;
+    return ptr;
+  }
+
+  /* Move on to the next chunk, unless the current one is unused. */
+  if (owl_arena_chunk < owl_arena_num_chunks && owl_arena_used > 0)
+    owl_arena_chunk++;
+  gg_assert(owl_arena_chunk < MAX_OWL_ARENA_CHUNKS);
+
+  if (owl_arena_chunk == owl_arena_num_chunks) {
+    owl_arena[owl_arena_chunk].size = gg_max(size, OWL_ARENA_CHUNK_SIZE);
+    owl_arena[owl_arena_chunk].data = pool_malloc(POOL_OWL,
+						  owl_arena[owl_arena_chunk].size);
+    owl_arena_num_chunks++;
+  }
+  else if (owl_arena[owl_arena_chunk].size < size) {
+    /* An unused chunk which is too small for an unusually big request. */
+    pool_free(owl_arena[owl_arena_chunk].data);
+    owl_arena[owl_arena_chunk].size = size;
+    owl_arena[owl_arena_chunk].data = pool_malloc(POOL_OWL, size);
+  }
+  gg_assert(owl_arena[owl_arena_chunk].data != NULL);
+
+  owl_arena_used = size;
+  return owl_arena[owl_arena_chunk].data;
+}
+
+
+/* Enlarge a block from owl_arena_alloc(). If it is at the top of the
+ * arena it is extended in place, otherwise it is moved to the top.
+ */
+static void *
+owl_arena_grow(void *ptr, int old_size, int new_size)
+{
+  void *new_ptr;
+
+  old_size = OWL_ARENA_ALIGN(old_size);
+  new_size = OWL_ARENA_ALIGN(new_size);
+  if (owl_arena_chunk < owl_arena_num_chunks
+      && (char *) ptr + old_size
+	 == owl_arena[owl_arena_chunk].data + owl_arena_used
+      && owl_arena_used - old_size + new_size
+	 <= owl_arena[owl_arena_chunk].size) {
+    owl_arena_used += new_size - old_size;
+    return ptr;
+  }
+
+  new_ptr = owl_arena_alloc(new_size);
+  memcpy(new_ptr, ptr, old_size);
+  return new_ptr;
+}
+
+
+static void
+owl_arena_get_mark(struct owl_arena_mark *mark)
+{
+  mark->chunk = owl_arena_chunk;
+  mark->used = owl_arena_used;
+}
+
+
+/* Free everything allocated since the mark was taken. Releasing to a
+ * mark above the current top does nothing, so two lists initialized
+ * together may be closed in either order.
+ */
+static void
+owl_arena_release(const struct owl_arena_mark *mark)
+{
+  if (mark->chunk < owl_arena_chunk
+      || (mark->chunk == owl_arena_chunk && mark->used < owl_arena_used)) {
+    owl_arena_chunk = mark->chunk;
+    owl_arena_used = mark->used;
+  }
+}
+
+
 /* This initializes a pattern list, allocating memory for 200 patterns.
  * If more patterns need to be stored, collect_owl_shapes_callbacks will
- * dynamically reallocate additional memory.
- * The space for list->pattern_list is allocated here.
+ * enlarge the list.
+ * The space for list->pattern_list is allocated here, from the owl arena.
  *
  * This function is automatically called from owl_shapes. Every call here
  * has to be matched by a call to close_pattern_list below.
@@ -3877,9 +4089,9 @@ init_pattern_list(struct matched_patterns_list_data *list)
   list->counter = 0;
   list->used = 0;
 
-  list->pattern_list = malloc(200 * sizeof(list->pattern_list[0]));
+  owl_arena_get_mark(&list->arena_mark);
+  list->pattern_list = owl_arena_alloc(200 * sizeof(list->pattern_list[0]));
   list->list_size = 200;
-  gg_assert(list->pattern_list != NULL);
   list->pattern_heap = NULL;
 
   if (0)
@@ -3935,8 +4147,7 @@ close_pattern_list(int color, struct matched_patterns_list_data *list)
       count_variations = save_count_variations;
     }
 
-    free(list->pattern_list);
-    free(list->pattern_heap);
+    owl_arena_release(&list->arena_mark);
   }
   list->counter = -1;
 }
@@ -3988,11 +4199,13 @@ collect_owl_shapes_callbacks(int anchor, int color, struct pattern *pattern,
   UNUSED(color); /* The calling function has to remember that. */
 
   if (matched_patterns->counter >= matched_patterns->list_size) {
-    matched_patterns->list_size += 100;
     matched_patterns->pattern_list
-        = realloc(matched_patterns->pattern_list,
-	          matched_patterns->list_size
-	          * sizeof(matched_patterns->pattern_list[0]));
+        = owl_arena_grow(matched_patterns->pattern_list,
+			 matched_patterns->list_size
+			 * sizeof(matched_patterns->pattern_list[0]),
+			 (matched_patterns->list_size + 100)
+			 * sizeof(matched_patterns->pattern_list[0]));
+    matched_patterns->list_size += 100;
   }
 
   next_pattern = &matched_patterns->pattern_list[matched_patterns->counter];
@@ -4180,14 +4393,11 @@ pattern_list_prepare(struct matched_patterns_list_data *list)
    * but it is easier to allocate more than to count real number of
    * heap elements first.
    */
-  if (list->counter > 0) { /* avoid malloc(0) */
-    list->pattern_heap = malloc(list->counter * sizeof(*(list->pattern_heap)));
-    gg_assert(list->pattern_heap != NULL);
-  }
-  else {
-    /* free() has defined behaviour for NULL pointer */
+  if (list->counter > 0)
+    list->pattern_heap = owl_arena_alloc(list->counter
+					 * sizeof(*(list->pattern_heap)));
+  else
     list->pattern_heap = NULL;
-  }
 
   for (pos = BOARDMIN; pos < BOARDMAX; pos++)
     list->first_pattern_index[pos] = -1;
@@ -4776,7 +4986,7 @@ owl_mark_dragon(int apos, int bpos, struct local_owl_data *owl,
       }
   }
 
-  memcpy(owl->cumulative_goal, owl->goal, sizeof(owl->goal));
+  memcpy(owl->cumulative_goal, owl->goal, BOARDMAX);
   owl->color = color;
   owl_mark_boundary(owl);
 }
@@ -4818,8 +5028,8 @@ owl_mark_boundary(struct local_owl_data *owl)
   int color = owl->color;
   int other = OTHER_COLOR(color);
   
-  memset(owl->boundary, 0, sizeof(owl->boundary));
-  memset(owl->neighbors, 0, sizeof(owl->neighbors));
+  memset(owl->boundary, 0, BOARDMAX);
+  memset(owl->neighbors, 0, BOARDMAX);
 
   /* Find all friendly neighbors of the dragon in goal. */
   for (pos = BOARDMIN; pos < BOARDMAX; pos++) {
@@ -4966,6 +5176,7 @@ owl_update_goal(int pos, enum same_dragon_value same_dragon, int lunch,
       if (owl->goal[stones[k]] == 0) {
 	if (0)
 	  TRACE("Added %1m to goal.\n", stones[k]);
+	owl_goal_writable(owl);
 	owl->goal[stones[k]] = 2;
 	owl->cumulative_goal[stones[k]] = 1;
       }
@@ -4980,6 +5191,7 @@ owl_update_goal(int pos, enum same_dragon_value same_dragon, int lunch,
     adj = chainlinks(lunch, adjs);
     for (k = 0; k < adj; k++)
       if (!owl->goal[adjs[k]]) {
+	owl_goal_writable(owl);
 	mark_string(adjs[k], owl->goal, 2);
 	mark_string(adjs[k], owl->cumulative_goal, 2);
       }
@@ -5119,6 +5331,7 @@ owl_test_cuts(signed char goal[BOARDMAX], int color, int cuts[MAX_CUTS])
     int num_components;
     int biggest_component = -1;
     struct connection_data *conn_data;
+    struct owl_arena_mark arena_mark;
     int c_id;
     int pos;
 
@@ -5140,7 +5353,9 @@ owl_test_cuts(signed char goal[BOARDMAX], int color, int cuts[MAX_CUTS])
      */
     memset(component2, -1, BOARDMAX);
     memset(component_size, 0, sizeof(int) * num_components);
-    conn_data = malloc(sizeof(struct connection_data) * num_components);
+    owl_arena_get_mark(&arena_mark);
+    conn_data = owl_arena_alloc(sizeof(struct connection_data)
+				* num_components);
     for (c_id = 0; c_id < num_components; c_id++) {
       signed char this_goal[BOARDMAX];
       memset(this_goal, 0, BOARDMAX);
@@ -5199,7 +5414,7 @@ owl_test_cuts(signed char goal[BOARDMAX], int color, int cuts[MAX_CUTS])
       showboard(0);
       componentdump(component2);
     }
-    free(conn_data);
+    owl_arena_release(&arena_mark);
   }
   sgf_dumptree = save_sgf_dumptree;
   count_variations = save_count_variations;
@@ -5231,6 +5446,7 @@ owl_update_boundary_marks(int pos, struct local_owl_data *owl)
       boundary_mark = 2;
   }
 
+  owl_boundary_writable(owl);
   mark_string(pos, owl->boundary, boundary_mark);
 }
 
@@ -5258,6 +5474,105 @@ componentdump(const signed char component[BOARDMAX])
   gprintf("\n");
 }
 
+/* Owl questions which are about to be asked. With --owl-workers they
+ * are read ahead in worker processes, which send the answers back
+ * through the persistent caches (see parallel.c). The questions are
+ * then asked again as usual and answered from the caches.
+ */
+#define MAX_OWL_QUERIES BOARDMAX
+
+struct owl_query {
+  enum routine_id routine; /* OWL_DOES_ATTACK, OWL_DOES_DEFEND or SEMEAI */
+  int move;
+  int target;
+  int target2; /* The opponent of target in a semeai. */
+};
+
+static struct owl_query owl_queries[MAX_OWL_QUERIES];
+static int num_owl_queries = 0;
+
+
+/* Add a question for read_owl_queries(). Duplicates are ignored, and
+ * so are questions which don't fit anymore.
+ */
+void
+add_owl_query(enum routine_id routine, int move, int target, int target2)
+{
+  int k;
+
+  for (k = 0; k < num_owl_queries; k++)
+    if (owl_queries[k].routine == routine
+	&& owl_queries[k].move == move
+	&& owl_queries[k].target == target
+	&& owl_queries[k].target2 == target2)
+      return;
+
+  if (num_owl_queries == MAX_OWL_QUERIES)
+    return;
+
+  owl_queries[num_owl_queries].routine = routine;
+  owl_queries[num_owl_queries].move = move;
+  owl_queries[num_owl_queries].target = target;
+  owl_queries[num_owl_queries].target2 = target2;
+  num_owl_queries++;
+}
+
+
+/* Job for run_parallel_jobs(): answer owl_queries[job]. */
+static void
+answer_owl_query(int job, void *result)
+{
+  struct owl_query *query = &owl_queries[job];
+  int *answer = result;
+  int certain;
+
+  switch (query->routine) {
+  case OWL_DOES_ATTACK:
+    *answer = owl_does_attack(query->move, query->target, NULL);
+    break;
+  case OWL_DOES_DEFEND:
+    *answer = owl_does_defend(query->move, query->target, NULL);
+    break;
+  case SEMEAI:
+    owl_analyze_semeai_after_move(query->move,
+				  OTHER_COLOR(board[query->target]),
+				  query->target, query->target2, answer,
+				  NULL, NULL, 1, &certain, 0);
+    break;
+  default:
+    gg_assert(0);
+  }
+}
+
+
+/* Read the questions added by add_owl_query() in worker processes and
+ * forget them.
+ */
+void
+read_owl_queries(void)
+{
+  static int answers[MAX_OWL_QUERIES];
+
+  if (num_owl_queries > 0)
+    run_parallel_jobs(num_owl_queries, owl_workers, answer_owl_query,
+		      answers, sizeof(answers[0]));
+  num_owl_queries = 0;
+}
+
+
+/* Returns 1 if an owl attack at pos on dr, with result acode, must be
+ * tested against the semeai by test_owl_attack_move().
+ */
+static int
+owl_attack_needs_semeai_test(int pos, int dr, int acode)
+{
+  return !(DRAGON2(dr).semeais == 0
+	   || DRAGON2(dr).semeai_defense_point == NO_MOVE
+	   || (DRAGON2(dr).semeais == 1 && semeai_move_reason_known(pos, dr))
+	   || acode == GAIN);
+}
+
+
 /*
  * Owl attack moves are ineffective when the dragon can still live in a
  * semeai. This function tests whether an owl attack move has this problem.
@@ -5268,10 +5583,7 @@ static void
 test_owl_attack_move(int pos, int dr, int kworm, int acode)
 {
   int color = OTHER_COLOR(board[dr]);
-  if (DRAGON2(dr).semeais == 0
-      || DRAGON2(dr).semeai_defense_point == NO_MOVE
-      || (DRAGON2(dr).semeais == 1 && semeai_move_reason_known(pos, dr))
-      || acode == GAIN) {
+  if (!owl_attack_needs_semeai_test(pos, dr, acode)) {
     add_owl_attack_move(pos, dr, kworm, acode);
     DEBUG(DEBUG_OWL, "owl: %1m attacks %1m (%s) at move %d\n",
 	  pos, dr, result_to_string(DRAGON2(dr).owl_attack_code),
@@ -5301,6 +5613,63 @@ test_owl_attack_move(int pos, int dr, int kworm, int acode)
   }
 }
 
+/* Look through the neighbors of the victim at pos for dragons of
+ * our color. If we find at least one being thought alive everything
+ * is ok and NO_MOVE is returned. Otherwise we return the largest one
+ * for further examination. It may occasionally happen that no
+ * neighbor of our color is found. Assume safe in that case.
+ */
+static int
+owl_attacker_at_risk(int pos, int color)
+{
+  int largest = 0;
+  int k;
+  int bpos = NO_MOVE;
+
+  for (k = 0; k < DRAGON2(pos).neighbors; k++) {
+    int d = DRAGON2(pos).adjacent[k];
+    if (DRAGON(d).color == color) {
+      if (DRAGON(d).status == ALIVE)
+	return NO_MOVE;
+      if (DRAGON(d).size > largest) {
+	bpos = dragon2[d].origin;
+	largest = DRAGON(d).size;
+      }
+    }
+  }
+
+  return bpos;
+}
+
+
+/* Read the owl questions of owl_reasons() ahead in worker processes. */
+static void
+read_owl_reasons_ahead(int color)
+{
+  int pos;
+
+  for (pos = BOARDMIN; pos < BOARDMAX; pos++) {
+    int move;
+    if (board[pos] != OTHER_COLOR(color)
+	|| dragon[pos].origin != pos
+	|| dragon[pos].status != CRITICAL
+	|| DRAGON2(pos).owl_attack_point == NO_MOVE)
+      continue;
+
+    move = DRAGON2(pos).owl_attack_point;
+    if (dragon[pos].effective_size < 8) {
+      int bpos = owl_attacker_at_risk(pos, color);
+      if (bpos != NO_MOVE)
+	add_owl_query(OWL_DOES_DEFEND, move, bpos, NO_MOVE);
+    }
+    if (owl_attack_needs_semeai_test(move, pos, DRAGON2(pos).owl_attack_code))
+      add_owl_query(SEMEAI, move, pos, DRAGON2(pos).semeai_defense_target);
+  }
+
+  read_owl_queries();
+}
+
+
 /* Add owl move reasons. This function should be called once during
  * genmove. It has to be called after semeai_move_reasons().
  */
@@ -5310,6 +5679,9 @@ owl_reasons(int color)
 {
   int pos;
 
+  if (use_worker_processes(owl_workers))
+    read_owl_reasons_ahead(color);
+
   for (pos = BOARDMIN; pos < BOARDMAX; pos++) {
     if (!IS_STONE(board[pos])
         || dragon[pos].origin != pos)
@@ -5346,40 +5718,13 @@ owl_reasons(int color)
 	
 	/* No worries if we catch something big. */
 	if (dragon[pos].effective_size < 8) {
-	  /* Look through the neighbors of the victim for dragons of
-	   * our color. If we find at least one being thought alive
-	   * everything is ok. Otherwise we keep track of the
-	   * largest one for further examination.
-	   */
-	  int largest = 0;
-	  int k;
-	  int bpos = NO_MOVE;
+	  int bpos = owl_attacker_at_risk(pos, color);
 	  int kworm = NO_MOVE;
-	  int safe = 0;
-	  for (k = 0; k < DRAGON2(pos).neighbors; k++) {
-	    int d = DRAGON2(pos).adjacent[k];
-	    if (DRAGON(d).color == color) {
-	      if (DRAGON(d).status == ALIVE) {
-		safe = 1;
-		break;
-	      }
-	      if (DRAGON(d).size > largest) {
-		bpos = dragon2[d].origin;
-		largest = DRAGON(d).size;
-	      }
-	    }
-	  }
-	  
-	  /* It may occasionally happen that no neighbor of our
-	   * color was found. Assume safe in that case.
-	   */
-	  if (bpos == NO_MOVE)
-	    safe = 1;
 	  
 	  /* If not yet thought safe, ask the owl code whether the
 	   * owl attack defends the (largest) attacker.
 	   */
-	  if (!safe && owl_does_defend(move, bpos, &kworm) != WIN) {
+	  if (bpos != NO_MOVE && owl_does_defend(move, bpos, &kworm) != WIN) {
 	    DEBUG(DEBUG_OWL,
 		  "owl: %1m attacks %1m at move %d, but the attacker dies.\n",
 		  move, pos, movenum+1);
@@ -6321,7 +6666,7 @@ owl_substantial(int str)
   if (liberties > MAX_SUBSTANTIAL_LIBS)
     return 0;
 
-  memset(owl->goal, 0, sizeof(owl->goal));
+  memset(owl->goal, 0, BOARDMAX);
   /* Mark the neighbors of the string. If one is found which is alive, return
    * true. */
   {
@@ -6942,14 +7287,26 @@ owl_escape_route(struct local_owl_data *owl)
 static void
 reduced_init_owl(struct local_owl_data **owl, int at_bottom_of_stack)
 {
-  if (at_bottom_of_stack)
+  if (at_bottom_of_stack) {
     owl_stack_pointer = 0;
+    /* No pattern lists can be in use now. */
+    owl_arena_chunk = 0;
+    owl_arena_used = 0;
+  }
   else
     owl_stack_pointer++;
 
   check_owl_stack_size();
+  gg_assert(owl_stack_pointer < MAX_OWL_ROOTS);
   *owl = owl_stack[owl_stack_pointer];
   VALGRIND_MAKE_WRITABLE(*owl, sizeof(struct local_owl_data));
+  (*owl)->goal = (*owl)->own_goal;
+  (*owl)->boundary = (*owl)->own_boundary;
+  (*owl)->cumulative_goal = (*owl)->own_cumulative_goal;
+  (*owl)->neighbors = owl_root_data[owl_stack_pointer].neighbors;
+  (*owl)->escape_values = owl_root_data[owl_stack_pointer].escape_values;
+  (*owl)->my_eye = (*owl)->own_eye;
+  (*owl)->half_eye = (*owl)->own_half_eye;
 }
 
 
@@ -6981,7 +7338,7 @@ static void
 check_owl_stack_size(void)
 {
   while (owl_stack_size <= owl_stack_pointer) {
-    owl_stack[owl_stack_size] = malloc(sizeof(*owl_stack[0]));
+    owl_stack[owl_stack_size] = pool_malloc(POOL_OWL, sizeof(*owl_stack[0]));
     gg_assert(owl_stack[owl_stack_size] != NULL);
     owl_stack_size++;
   }
@@ -6989,6 +7346,11 @@ check_owl_stack_size(void)
 
 /* Push owl data one step upwards in the stack. Gets called from
  * push_owl.
+ *
+ * Only pointers are copied here. The goal and boundary arrays are
+ * copied first when they are modified, by owl_goal_writable() and
+ * owl_boundary_writable(). Neighbors and escape values are never
+ * modified above the bottom of the stack.
  */
 static void
 do_push_owl(struct local_owl_data **owl)
@@ -6997,15 +7359,15 @@ do_push_owl(struct local_owl_data **owl)
 
   /* Mark all the data in *new_owl as uninitialized. */
   VALGRIND_MAKE_WRITABLE(new_owl, sizeof(struct local_owl_data));
-  /* Copy the owl data. */
-  memcpy(new_owl->goal, (*owl)->goal, sizeof(new_owl->goal));
-  memcpy(new_owl->cumulative_goal, (*owl)->cumulative_goal,
-         sizeof(new_owl->cumulative_goal));
-  memcpy(new_owl->boundary, (*owl)->boundary, sizeof(new_owl->boundary));
-  memcpy(new_owl->neighbors, (*owl)->neighbors, sizeof(new_owl->neighbors));
-  memcpy(new_owl->escape_values, (*owl)->escape_values,
-	 sizeof(new_owl->escape_values));
+  /* Share the owl data. */
+  new_owl->goal = (*owl)->goal;
+  new_owl->cumulative_goal = (*owl)->cumulative_goal;
+  new_owl->boundary = (*owl)->boundary;
+  new_owl->neighbors = (*owl)->neighbors;
+  new_owl->escape_values = (*owl)->escape_values;
   new_owl->color = (*owl)->color;
+  new_owl->my_eye = new_owl->own_eye;
+  new_owl->half_eye = new_owl->own_half_eye;
 
   new_owl->lunches_are_current = 0;
 
@@ -7044,6 +7406,35 @@ pop_owl(struct local_owl_data **owl)
 }
 
 
+/* Make sure that the goal and cumulative_goal arrays of owl are not
+ * shared with a previous stack entry, so that they can be modified.
+ */
+static void
+owl_goal_writable(struct local_owl_data *owl)
+{
+  if (owl->goal != owl->own_goal) {
+    memcpy(owl->own_goal, owl->goal, sizeof(owl->own_goal));
+    owl->goal = owl->own_goal;
+  }
+  if (owl->cumulative_goal != owl->own_cumulative_goal) {
+    memcpy(owl->own_cumulative_goal, owl->cumulative_goal,
+	   sizeof(owl->own_cumulative_goal));
+    owl->cumulative_goal = owl->own_cumulative_goal;
+  }
+}
+
+
+/* Same as owl_goal_writable() for the boundary array. */
+static void
+owl_boundary_writable(struct local_owl_data *owl)
+{
+  if (owl->boundary != owl->own_boundary) {
+    memcpy(owl->own_boundary, owl->boundary, sizeof(owl->own_boundary));
+    owl->boundary = owl->own_boundary;
+  }
+}
+
+
 /*
  * List worms in order to track captures during owl reading
  * (GAIN/LOSS codes)
@@ -7156,6 +7547,17 @@ catalog_goal(struct local_owl_data *owl, int goal_worm[MAX_GOAL_WORMS])
 }
 #endif
 
+/* Forget an owl search which was left by a longjmp() from the
+ * trymove hook (see ponder.c). The owl stack and the pattern arena
+ * are reset anyway when the next search starts at the bottom of the
+ * stack, but these flags are normally cleared on the way back.
+ */
+void
+owl_abandon_search()
+{
+  include_semeai_worms_in_eyespace = 0;
+}
+
 /***********************/
 
 /* Clear statistics. */
@@ -7174,6 +7576,14 @@ get_owl_node_counter()
 }
 
 
+/* Count owl nodes which a worker process has read. */
+void
+add_owl_node_counter(int nodes)
+{
+  global_owl_node_counter += nodes;
+}
+
+
 /*
  * Local Variables:
  * tab-width: 8
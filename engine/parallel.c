@@ -0,0 +1,365 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ * This is GNU Go, a Go program. Contact gnugo@gnu.org, or see       *
+ * http://www.gnu.org/software/gnugo/ for more information.          *
+ *                                                                   *
+ * Copyright 1999, 2000, 2001, 2002, 2003, 2004, 2005, 2006, 2007,   *
+ * 2008 and 2009  by the Free Software Foundation.                   *
+ *                                                                   *
+ * This program is free software; you can redistribute it and/or     *
+ * modify it under the terms of the GNU General Public License as    *
+ * published by the Free Software Foundation - version 3 or          *
+ * (at your option) any later version.                               *
+ *                                                                   *
+ * This program is distributed in the hope that it will be useful,   *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of    *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the     *
+ * GNU General Public License in file COPYING for more details.      *
+ *                                                                   *
+ * You should have received a copy of the GNU General Public         *
+ * License along with this program; if not, write to the Free        *
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,       *
+ * Boston, MA 02111, USA.                                            *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Running independent jobs, such as owl searches, in worker processes.
+ *
+ * The engine keeps the board, the owl stack and all caches in global
+ * variables, so the searches cannot run in threads. Instead each job
+ * runs in a child process forked from the current state, which gives
+ * it a private copy of everything, and sends its result back through
+ * a pipe.
+ *
+ * The transposition table is moved to shared memory before the first
+ * worker is started (see tt_share() in cache.c), so the workers see
+ * each other's read results. Together with the result each worker
+ * sends back the numbers of reading, owl and connection nodes it has
+ * spent and the entries it has stored in the persistent owl and semeai
+ * caches. The main process adds them to its own in the order of the
+ * jobs, as if it had done the reading itself.
+ *
+ * Through the shared table a job can use the results of any job
+ * running at the same time, so the results depend on the number of
+ * workers and on the scheduling. They may also differ from those of a
+ * sequential run.
+ */
+
+#include "gnugo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_FORK
+#include <sys/types.h>
+#include <sys/select.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "liberty.h"
+#include "cache.h"
+#include "sgftree.h"
+#include "gg_utils.h"
+
+#define MAX_WORKERS 64
+
+
+#ifdef HAVE_FORK
+
+/* What a worker sends after the result of its job, followed by
+ * cache_size bytes of persistent cache entries.
+ */
+struct worker_report {
+  int reading_nodes;
+  int owl_nodes;
+  int connection_nodes;
+  int cache_size;
+};
+
+
+/* Write size bytes to fd. Returns 1 if they all could be written. */
+static int
+write_all(int fd, const void *data, int size)
+{
+  const char *p = data;
+  int written = 0;
+
+  while (written < size) {
+    int n = write(fd, p + written, size - written);
+    if (n <= 0)
+      return 0;
+    written += n;
+  }
+  return 1;
+}
+
+
+/* Read size bytes from fd. Returns 1 if they all arrived. */
+static int
+read_all(int fd, void *data, int size)
+{
+  char *p = data;
+  int received = 0;
+
+  while (received < size) {
+    int n = read(fd, p + received, size - received);
+    if (n <= 0)
+      return 0;
+    received += n;
+  }
+  return 1;
+}
+
+
+/* Run job j in the worker process and send everything back. */
+static void
+run_worker_job(int fd, int j, parallel_job_fn job, int result_size)
+{
+  char result[PARALLEL_MAX_RESULT_SIZE];
+  struct worker_report report;
+  void *cache = NULL;
+  int reading_nodes = get_reading_node_counter();
+  int owl_nodes = get_owl_node_counter();
+  int connection_nodes = get_connection_node_counter();
+  int serial = persistent_cache_serial();
+
+  job(j, result);
+
+  report.reading_nodes = get_reading_node_counter() - reading_nodes;
+  report.owl_nodes = get_owl_node_counter() - owl_nodes;
+  report.connection_nodes = get_connection_node_counter() - connection_nodes;
+  report.cache_size = export_persistent_owl_cache(serial, NULL);
+  if (report.cache_size > 0) {
+    cache = pool_malloc(POOL_ENGINE, report.cache_size);
+    if (cache)
+      export_persistent_owl_cache(serial, cache);
+    else
+      report.cache_size = 0;
+  }
+
+  if (!write_all(fd, result, result_size)
+      || !write_all(fd, &report, sizeof(report))
+      || !write_all(fd, cache, report.cache_size))
+    _exit(EXIT_FAILURE);
+}
+
+
+/* Start job j in a new process. Returns the read end of a pipe on
+ * which the result arrives, or -1 if no process could be started.
+ */
+static int
+start_worker(int j, parallel_job_fn job, int result_size, pid_t *pid)
+{
+  int fd[2];
+
+  if (pipe(fd) == -1)
+    return -1;
+
+  *pid = fork();
+  if (*pid == -1) {
+    close(fd[0]);
+    close(fd[1]);
+    return -1;
+  }
+
+  if (*pid == 0) {
+    close(fd[0]);
+    /* An interrupt must not longjmp() into the main process' search
+     * (see interrupt.c).
+     */
+    trymove_hook = NULL;
+    run_worker_job(fd[1], j, job, result_size);
+    /* Don't run atexit handlers or flush stdio buffers inherited from
+     * the main process.
+     */
+    _exit(EXIT_SUCCESS);
+  }
+
+  close(fd[1]);
+  return fd[0];
+}
+
+
+/* Collect the result and the report of a worker. The cache entries
+ * are stored in a new block at *cache. Returns 1 if everything
+ * arrived.
+ */
+static int
+finish_worker(int fd, pid_t pid, char *result, int result_size,
+	      struct worker_report *report, void **cache)
+{
+  int status;
+  int complete = (read_all(fd, result, result_size)
+		  && read_all(fd, report, sizeof(*report))
+		  && report->cache_size >= 0);
+
+  if (complete && report->cache_size > 0) {
+    *cache = pool_malloc(POOL_ENGINE, report->cache_size);
+    complete = (*cache != NULL
+		&& read_all(fd, *cache, report->cache_size));
+  }
+  close(fd);
+  if (waitpid(pid, &status, 0) != pid)
+    return 0;
+
+  return (complete
+	  && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+}
+
+
+/* Add what a worker has reported to the state of the main process. */
+static void
+merge_worker_report(struct worker_report *report, void *cache)
+{
+  add_reading_node_counter(report->reading_nodes);
+  add_owl_node_counter(report->owl_nodes);
+  add_connection_node_counter(report->connection_nodes);
+  if (cache)
+    import_persistent_owl_cache(cache, report->cache_size);
+}
+
+
+/* Run the jobs in up to the given number of processes at a time. Jobs
+ * which fail in a worker are run in the main process afterwards, in
+ * order.
+ */
+static void
+run_jobs_in_workers(int num_jobs, int max_workers, parallel_job_fn job,
+		    char *results, int result_size)
+{
+  int fds[MAX_WORKERS];
+  pid_t pids[MAX_WORKERS];
+  int worker_job[MAX_WORKERS];
+  signed char *failed = pool_calloc(POOL_ENGINE, num_jobs, 1);
+  struct worker_report *reports = pool_calloc(POOL_ENGINE, num_jobs,
+					      sizeof(*reports));
+  void **caches = pool_calloc(POOL_ENGINE, num_jobs, sizeof(*caches));
+  int workers = gg_min(max_workers, MAX_WORKERS);
+  int next_job = 0;
+  int running = 0;
+  int j;
+  int k;
+
+  gg_assert(failed != NULL && reports != NULL && caches != NULL);
+
+  /* Otherwise pending output is written once by every worker. */
+  fflush(NULL);
+
+  tt_share(&ttable);
+
+  for (k = 0; k < workers; k++)
+    fds[k] = -1;
+
+  while (next_job < num_jobs || running > 0) {
+    fd_set ready;
+    int max_fd = -1;
+
+    for (k = 0; k < workers && next_job < num_jobs; k++) {
+      if (fds[k] != -1)
+	continue;
+      fds[k] = start_worker(next_job, job, result_size, &pids[k]);
+      if (fds[k] == -1)
+	failed[next_job] = 1;
+      else {
+	worker_job[k] = next_job;
+	running++;
+      }
+      next_job++;
+    }
+
+    if (running == 0)
+      continue;
+
+    /* Wait until some worker has written its result or died. */
+    FD_ZERO(&ready);
+    for (k = 0; k < workers; k++)
+      if (fds[k] != -1) {
+	FD_SET(fds[k], &ready);
+	max_fd = gg_max(max_fd, fds[k]);
+      }
+    if (select(max_fd + 1, &ready, NULL, NULL, NULL) <= 0)
+      continue;
+
+    for (k = 0; k < workers; k++)
+      if (fds[k] != -1 && FD_ISSET(fds[k], &ready)) {
+	j = worker_job[k];
+	if (!finish_worker(fds[k], pids[k], results + j * result_size,
+			   result_size, &reports[j], &caches[j]))
+	  failed[j] = 1;
+	fds[k] = -1;
+	running--;
+      }
+  }
+
+  for (j = 0; j < num_jobs; j++) {
+    if (!failed[j])
+      merge_worker_report(&reports[j], caches[j]);
+    pool_free(caches[j]);
+  }
+
+  for (j = 0; j < num_jobs; j++)
+    if (failed[j])
+      job(j, results + j * result_size);
+
+  pool_free(caches);
+  pool_free(reports);
+  pool_free(failed);
+}
+
+#endif
+
+
+/* Returns 1 if run_parallel_jobs() would start worker processes for
+ * the given number of workers. It doesn't when tracing or sgf output
+ * is active, or on platforms without fork().
+ */
+int
+use_worker_processes(int workers)
+{
+#ifdef HAVE_FORK
+  return (workers > 1
+	  && !verbose && !debug && !printworms && !printmoyo && !printboard
+	  && sgf_dumptree == NULL);
+#else
+  UNUSED(workers);
+  return 0;
+#endif
+}
+
+
+/* Run the jobs 0, ..., num_jobs - 1 and store the result of job j at
+ * results + j * result_size. The jobs are run in up to workers
+ * processes if use_worker_processes(workers) says so, and
+ * sequentially, in order, otherwise.
+ *
+ * A job must not depend on the results of the others. Apart from the
+ * node counters and the persistent owl and semeai caches, everything
+ * it wants to report has to go into its result, which may be at most
+ * PARALLEL_MAX_RESULT_SIZE bytes.
+ */
+void
+run_parallel_jobs(int num_jobs, int workers, parallel_job_fn job,
+		  void *results, int result_size)
+{
+  int j;
+
+  gg_assert(result_size <= PARALLEL_MAX_RESULT_SIZE);
+
+#ifdef HAVE_FORK
+  if (num_jobs > 1 && use_worker_processes(workers)) {
+    run_jobs_in_workers(num_jobs, workers, job, results, result_size);
+    return;
+  }
+#endif
+
+  for (j = 0; j < num_jobs; j++)
+    job(j, (char *) results + j * result_size);
+}
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * c-basic-offset: 2
+ * End:
+ */
@@ -0,0 +1,563 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ * This is GNU Go, a Go program. Contact gnugo@gnu.org, or see       *
+ * http://www.gnu.org/software/gnugo/ for more information.          *
+ *                                                                   *
+ * Copyright 1999, 2000, 2001, 2002, 2003, 2004, 2005, 2006, 2007,   *
+ * 2008 and 2009  by the Free Software Foundation.                   *
+ *                                                                   *
+ * This program is free software; you can redistribute it and/or     *
+ * modify it under the terms of the GNU General Public License as    *
+ * published by the Free Software Foundation - version 3 or          *
+ * (at your option) any later version.                               *
+ *                                                                   *
+ * This program is distributed in the hope that it will be useful,   *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of    *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the     *
+ * GNU General Public License in file COPYING for more details.      *
+ *                                                                   *
+ * You should have received a copy of the GNU General Public         *
+ * License along with this program; if not, write to the Free        *
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,       *
+ * Boston, MA 02111, USA.                                            *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Loading of pattern databases in the binary format of patfile.h at
+ * run time. A loaded database replaces the compiled in database with
+ * the same name. The pattern elements and the DFA are used in place,
+ * so the image must stay valid as long as the engine runs. Only the
+ * pattern structs, which the matcher modifies for the board size, and
+ * the attributes are copied to allocated memory.
+ */
+
+#include "gnugo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "liberty.h"
+#include "patterns.h"
+#include "dfa.h"
+#include "patfile.h"
+#include "gg_utils.h"
+
+
+/* The databases which can be replaced. */
+static struct loadable_db {
+  const char *name;
+  struct pattern_db *pdb;
+
+  /* The compiled in database, providing the helper functions. */
+  _CONST_DECL struct pattern *compiled;
+  int num_compiled;
+
+  /* Allocated for the loaded database, or NULL. */
+  struct pattern *patterns;
+  struct pattern_attribute *attributes;
+  struct dfa_rt *pdfa;
+} loadable_dbs[] = {
+  {"pat",		&pat_db,		NULL, 0, NULL, NULL, NULL},
+  {"attpat",		&attpat_db,		NULL, 0, NULL, NULL, NULL},
+  {"defpat",		&defpat_db,		NULL, 0, NULL, NULL, NULL},
+  {"endpat",		&endpat_db,		NULL, 0, NULL, NULL, NULL},
+  {"conn",		&conn_db,		NULL, 0, NULL, NULL, NULL},
+  {"influencepat",	&influencepat_db,	NULL, 0, NULL, NULL, NULL},
+  {"barrierspat",	&barrierspat_db,	NULL, 0, NULL, NULL, NULL},
+  {"fusekipat",		&fusekipat_db,		NULL, 0, NULL, NULL, NULL},
+  {"handipat",		&handipat_db,		NULL, 0, NULL, NULL, NULL},
+  {"aa_attackpat",	&aa_attackpat_db,	NULL, 0, NULL, NULL, NULL},
+  {"owl_attackpat",	&owl_attackpat_db,	NULL, 0, NULL, NULL, NULL},
+  {"owl_defendpat",	&owl_defendpat_db,	NULL, 0, NULL, NULL, NULL},
+  {"owl_vital_apat",	&owl_vital_apat_db,	NULL, 0, NULL, NULL, NULL},
+#if ORACLE
+  {"oracle",		&oracle_db,		NULL, 0, NULL, NULL, NULL},
+#endif
+  {NULL,		NULL,			NULL, 0, NULL, NULL, NULL}
+};
+
+
+static struct loadable_db *
+find_loadable_db(const struct patfile_header *header)
+{
+  struct loadable_db *db;
+
+  if (memchr(header->name, 0, PATFILE_NAME_LENGTH) == NULL)
+    return NULL;
+
+  for (db = loadable_dbs; db->name; db++)
+    if (strcmp(db->name, header->name) == 0) {
+      if (db->compiled == NULL) {
+	db->compiled = db->pdb->patterns;
+	for (db->num_compiled = 0; db->compiled[db->num_compiled].patn;
+	     db->num_compiled++)
+	  ;
+      }
+      return db;
+    }
+
+  return NULL;
+}
+
+
+/* Does the section at `offset' with `num' entries of `size' bytes fit
+ * into the chunk?
+ */
+static int
+section_ok(const struct patfile_header *header, unsigned int offset,
+	   int num, int size)
+{
+  return (offset % 4 == 0
+	  && num >= 0
+	  && offset <= header->chunk_size
+	  && (unsigned int) num <= (header->chunk_size - offset) / size);
+}
+
+
+/* Decode a pattern offset, see OFFSET() in liberty.h. Returns 0 if it
+ * is not a valid index of transformation[].
+ */
+static int
+decode_offset(int offset, int *di, int *dj)
+{
+  if (offset < 0 || offset >= MAX_OFFSET)
+    return 0;
+
+  *di = offset % (2*MAX_BOARD - 1) - (MAX_BOARD - 1);
+  *dj = offset / (2*MAX_BOARD - 1) - (MAX_BOARD - 1);
+  return 1;
+}
+
+
+/* Check the transformations, extent, elements and attributes of a
+ * pattern. Without a DFA, do_matchpat() only checks that the extent
+ * fits on the board, so the elements must lie within it. In a DFA
+ * database mkpat may have stored the elements transformed, so only
+ * their range is checked. The same holds for the move, which mkpat
+ * puts outside the extent in patterns without a '*', and for offset
+ * attributes, which are relative to the move.
+ */
+static int
+pattern_geometry_ok(const struct patfile_header *header,
+		    const struct patfile_pattern *pat)
+{
+  const char *chunk = (const char *) header;
+  const struct patfile_patval *patvals;
+  const struct patfile_attribute *attr;
+  int di, dj;
+  int k;
+
+  if (pat->trfno < 1 || pat->trfno > 8
+      || pat->mini < -(MAX_BOARD - 1) || pat->maxi > MAX_BOARD - 1
+      || pat->minj < -(MAX_BOARD - 1) || pat->maxj > MAX_BOARD - 1
+      || pat->mini > pat->maxi || pat->minj > pat->maxj
+      || pat->height != pat->maxi - pat->mini
+      || pat->width != pat->maxj - pat->minj
+      || !decode_offset(pat->move_offset, &di, &dj))
+    return 0;
+
+  patvals = (const struct patfile_patval *) (chunk + header->patvals_offset);
+  for (k = pat->patn; k < pat->patn + pat->patlen; k++) {
+    if (!decode_offset(patvals[k].offset, &di, &dj)
+	|| patvals[k].att > ATT_not)
+      return 0;
+    if (header->num_states == 0
+	&& (di < pat->mini || di > pat->maxi
+	    || dj < pat->minj || dj > pat->maxj))
+      return 0;
+  }
+
+  /* The attribute list ends with LAST_ATTRIBUTE, which is checked to
+   * be the last entry of the section.
+   */
+  if (pat->attributes >= 0) {
+    attr = ((const struct patfile_attribute *)
+	    (chunk + header->attributes_offset)) + pat->attributes;
+    for (; attr->type != LAST_ATTRIBUTE; attr++)
+      if (attr->type >= FIRST_OFFSET_ATTRIBUTE
+	  && !decode_offset(attr->offset, &di, &dj))
+	return 0;
+  }
+
+  return 1;
+}
+
+
+/* Check that the database in `header' can replace the compiled in one
+ * and that all its indices and offsets are in range. The DFA is only
+ * checked for indices in range; a corrupt DFA can still make the
+ * matcher loop or report patterns which do not match.
+ */
+static int
+check_pattern_chunk(const struct patfile_header *header,
+		    struct loadable_db *db)
+{
+  const char *chunk = (const char *) header;
+  const struct patfile_pattern *pat;
+  const struct patfile_attribute *attr;
+  const state_rt_t *states;
+  const attrib_rt_t *indexes;
+  int k;
+
+  if (header->helper_signature != db->pdb->helper_signature) {
+    gprintf("Pattern database %s does not match the compiled in helpers.\n",
+	    db->name);
+    return 0;
+  }
+
+  if (header->max_board != MAX_BOARD
+#if GRID_OPT
+      || !(header->flags & PATFILE_GRID_OPT)
+#else
+      || (header->flags & PATFILE_GRID_OPT)
+#endif
+#ifdef FIXED_BOARD_SIZE
+      || header->fixed_for_size != FIXED_BOARD_SIZE
+#endif
+      || header->fixed_anchor != db->pdb->fixed_anchor) {
+    gprintf("Pattern database %s was compiled for another configuration.\n",
+	    db->name);
+    return 0;
+  }
+
+  if (!section_ok(header, header->patterns_offset, header->num_patterns,
+		  sizeof(struct patfile_pattern))
+      || !section_ok(header, header->patvals_offset, header->num_patvals,
+		     sizeof(struct patfile_patval))
+      || !section_ok(header, header->attributes_offset,
+		     header->num_attributes, sizeof(struct patfile_attribute))
+      || !section_ok(header, header->states_offset, header->num_states,
+		     PATFILE_STATE_SIZE)
+      || !section_ok(header, header->indexes_offset, header->num_indexes,
+		     PATFILE_INDEX_SIZE)
+      || !section_ok(header, header->names_offset, header->names_size, 1)
+      || (header->names_size > 0
+	  && chunk[header->names_offset + header->names_size - 1] != 0)
+      || (header->num_attributes > 0
+	  && ((const struct patfile_attribute *)
+	      (chunk + header->attributes_offset))
+	     [header->num_attributes - 1].type != LAST_ATTRIBUTE)
+      || (header->num_states == 0) != (header->num_indexes == 0)) {
+    gprintf("Pattern database %s is corrupt.\n", db->name);
+    return 0;
+  }
+
+  pat = (const struct patfile_pattern *) (chunk + header->patterns_offset);
+  for (k = 0; k < header->num_patterns; k++, pat++) {
+    if (pat->patn < 0 || pat->patlen < 0
+	|| pat->patn + gg_max(pat->patlen, 1) > header->num_patvals
+	|| pat->name < 0 || pat->name >= header->names_size
+	|| pat->attributes < -1 || pat->attributes >= header->num_attributes
+	|| pat->helper < -1 || pat->helper >= db->num_compiled
+	|| !pattern_geometry_ok(header, pat)) {
+      gprintf("Pattern database %s is corrupt (pattern %d).\n", db->name, k);
+      return 0;
+    }
+  }
+
+  attr = (const struct patfile_attribute *) (chunk + header->attributes_offset);
+  for (k = 0; k < header->num_attributes; k++)
+    if (attr[k].type < 0 || attr[k].type > LAST_ATTRIBUTE) {
+      gprintf("Pattern database %s is corrupt (attribute %d).\n", db->name, k);
+      return 0;
+    }
+
+  states = (const state_rt_t *) (chunk + header->states_offset);
+  for (k = 0; k < header->num_states; k++) {
+    int m;
+    if (states[k].att < 0 || states[k].att >= header->num_indexes) {
+      gprintf("Pattern database %s has a corrupt DFA.\n", db->name);
+      return 0;
+    }
+    for (m = 0; m < 4; m++)
+      if (k + states[k].next[m] < 0
+	  || k + states[k].next[m] >= header->num_states) {
+	gprintf("Pattern database %s has a corrupt DFA.\n", db->name);
+	return 0;
+      }
+  }
+
+  /* Index 0 is the empty attribute list and never visited. */
+  indexes = (const attrib_rt_t *) (chunk + header->indexes_offset);
+  for (k = 1; k < header->num_indexes; k++)
+    if (indexes[k].val < 0 || indexes[k].val >= header->num_patterns
+	|| indexes[k].next < 0 || indexes[k].next >= header->num_indexes) {
+      gprintf("Pattern database %s has a corrupt DFA.\n", db->name);
+      return 0;
+    }
+
+  return 1;
+}
+
+
+/* Replace the patterns of `db' by the checked database in `header'. */
+static void
+install_pattern_chunk(const struct patfile_header *header,
+		      struct loadable_db *db)
+{
+  const char *chunk = (const char *) header;
+  const struct patfile_pattern *pat;
+  const struct patfile_attribute *attr;
+  struct patval *patvals;
+  const char *names;
+  struct pattern *patterns;
+  struct pattern_attribute *attributes = NULL;
+  struct dfa_rt *pdfa = NULL;
+  int joint;
+  int k;
+
+  patterns = pool_calloc(POOL_ENGINE, header->num_patterns + 1,
+			 sizeof(*patterns));
+  if (header->num_attributes > 0)
+    attributes = pool_malloc(POOL_ENGINE,
+			     header->num_attributes * sizeof(*attributes));
+  if (header->num_states > 0)
+    pdfa = pool_malloc(POOL_ENGINE, sizeof(*pdfa));
+  if (!patterns
+      || (header->num_attributes > 0 && !attributes)
+      || (header->num_states > 0 && !pdfa)) {
+    fprintf(stderr, "Out of memory loading pattern database %s.\n", db->name);
+    exit(EXIT_FAILURE);
+  }
+
+  attr = (const struct patfile_attribute *) (chunk + header->attributes_offset);
+  for (k = 0; k < header->num_attributes; k++) {
+    attributes[k].type = attr[k].type;
+#ifdef HAVE_TRANSPARENT_UNIONS
+    if (attr[k].type >= FIRST_OFFSET_ATTRIBUTE)
+      attributes[k].offset = attr[k].offset;
+    else
+      attributes[k].value = attr[k].value;
+#else
+    attributes[k].value = attr[k].value;
+    attributes[k].offset = attr[k].offset;
+#endif
+  }
+
+  patvals = (struct patval *) (chunk + header->patvals_offset);
+  names = chunk + header->names_offset;
+  pat = (const struct patfile_pattern *) (chunk + header->patterns_offset);
+  for (k = 0; k < header->num_patterns; k++, pat++) {
+    struct pattern *p = patterns + k;
+
+    p->patn = patvals + pat->patn;
+    p->patlen = pat->patlen;
+    p->trfno = pat->trfno;
+    p->name = names + pat->name;
+    p->mini = pat->mini;
+    p->minj = pat->minj;
+    p->maxi = pat->maxi;
+    p->maxj = pat->maxj;
+    p->height = pat->height;
+    p->width = pat->width;
+    p->edge_constraints = pat->edge_constraints;
+    p->move_offset = pat->move_offset;
+#if GRID_OPT
+    memcpy(p->and_mask, pat->and_mask, sizeof(p->and_mask));
+    memcpy(p->val_mask, pat->val_mask, sizeof(p->val_mask));
+#endif
+    p->class = pat->class;
+    p->value = pat->value;
+    p->attributes = pat->attributes >= 0 ? attributes + pat->attributes : NULL;
+    p->autohelper_flag = pat->autohelper_flag;
+    if (pat->helper >= 0) {
+      p->helper = db->compiled[pat->helper].helper;
+      p->autohelper = db->compiled[pat->helper].autohelper;
+    }
+    p->anchored_at_X = pat->anchored_at_X;
+    p->constraint_cost = pat->constraint_cost;
+  }
+
+  if (pdfa) {
+    memset((char *) pdfa->name, 0, sizeof(pdfa->name));
+    strncpy((char *) pdfa->name, db->name, sizeof(pdfa->name) - 1);
+    pdfa->states = (const state_rt_t *) (chunk + header->states_offset);
+    pdfa->indexes = (const attrib_rt_t *) (chunk + header->indexes_offset);
+  }
+
+  pool_free(db->patterns);
+  pool_free(db->attributes);
+  pool_free(db->pdfa);
+  db->patterns = patterns;
+  db->attributes = attributes;
+  db->pdfa = pdfa;
+
+  db->pdb->patterns = patterns;
+  db->pdb->pdfa = pdfa;
+  db->pdb->fixed_for_size = header->fixed_for_size;
+
+  /* The joint DFA refers to the compiled in patterns, so fall back to
+   * matching the databases one by one.
+   */
+  for (joint = 0; joint < owl_shapes_db.num_dbs; joint++)
+    if (owl_shapes_db.dbs[joint] == db->pdb)
+      owl_shapes_db.pdfa = NULL;
+
+  DEBUG(DEBUG_MATCHER, "%s --> loaded %d patterns%s\n", db->name,
+	header->num_patterns, pdfa ? " with dfa" : "");
+}
+
+
+/* Load the pattern databases in a binary image, as written by `mkpat
+ * -B'. The image may hold several databases, which all must match the
+ * compiled in ones. If any database cannot be used, none is loaded.
+ * The image must stay valid and unmodified as long as the engine
+ * runs.
+ *
+ * Returns the number of loaded databases, or 0 on failure.
+ */
+int
+load_pattern_image(const void *image, size_t size)
+{
+  const char *p;
+  size_t left;
+  int pass;
+  int num_dbs = 0;
+
+  if (sizeof(struct patval) != sizeof(struct patfile_patval)
+      || sizeof(state_rt_t) != PATFILE_STATE_SIZE
+      || sizeof(attrib_rt_t) != PATFILE_INDEX_SIZE) {
+    gprintf("Binary pattern databases are not supported on this platform.\n");
+    return 0;
+  }
+
+  if ((unsigned long) image % 4 != 0) {
+    gprintf("Pattern database image is not aligned.\n");
+    return 0;
+  }
+
+  /* First check all the databases, then install them. */
+  for (pass = 0; pass < 2; pass++) {
+    for (p = image, left = size; left > 0; ) {
+      const struct patfile_header *header = (const void *) p;
+      struct loadable_db *db;
+
+      if (left < sizeof(*header)) {
+	gprintf("Pattern database image is truncated.\n");
+	return 0;
+      }
+      if (header->magic == PATFILE_MAGIC_SWAPPED) {
+	gprintf("Pattern database image has the wrong byte order.\n");
+	return 0;
+      }
+      if (header->magic != PATFILE_MAGIC) {
+	gprintf("Not a pattern database image.\n");
+	return 0;
+      }
+      if (header->version != PATFILE_VERSION) {
+	gprintf("Unsupported pattern database version %d.\n",
+		(int) header->version);
+	return 0;
+      }
+      if (header->chunk_size < sizeof(*header) || header->chunk_size > left
+	  || header->chunk_size % 4 != 0) {
+	gprintf("Pattern database image is truncated.\n");
+	return 0;
+      }
+
+      db = find_loadable_db(header);
+      if (!db) {
+	gprintf("Unknown pattern database %s.\n",
+		memchr(header->name, 0, PATFILE_NAME_LENGTH) ? header->name : "");
+	return 0;
+      }
+
+      if (pass == 0) {
+	if (!check_pattern_chunk(header, db))
+	  return 0;
+	num_dbs++;
+      }
+      else
+	install_pattern_chunk(header, db);
+
+      p += header->chunk_size;
+      left -= header->chunk_size;
+    }
+  }
+
+  return num_dbs;
+}
+
+
+/* Load the pattern databases in a binary file. The file is mapped
+ * into memory if possible, otherwise read into allocated memory.
+ *
+ * Returns the number of loaded databases, or 0 on failure.
+ */
+int
+load_pattern_file(const char *filename)
+{
+  void *image;
+  size_t size;
+  int num_dbs;
+#ifdef HAVE_SYS_MMAN_H
+  struct stat st;
+  int fd = open(filename, O_RDONLY);
+
+  if (fd < 0 || fstat(fd, &st) < 0) {
+    gprintf("Failed to open %s file.\n", filename);
+    if (fd >= 0)
+      close(fd);
+    return 0;
+  }
+
+  size = st.st_size;
+  image = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (image == MAP_FAILED) {
+    gprintf("Failed to map %s file.\n", filename);
+    return 0;
+  }
+
+  num_dbs = load_pattern_image(image, size);
+  if (!num_dbs)
+    munmap(image, size);
+#else
+  FILE *pattern_file = fopen(filename, "rb");
+  long length;
+
+  if (!pattern_file) {
+    gprintf("Failed to open %s file.\n", filename);
+    return 0;
+  }
+
+  fseek(pattern_file, 0, SEEK_END);
+  length = ftell(pattern_file);
+  fseek(pattern_file, 0, SEEK_SET);
+  if (length <= 0) {
+    gprintf("Failed to read %s file.\n", filename);
+    fclose(pattern_file);
+    return 0;
+  }
+
+  size = length;
+  image = pool_malloc(POOL_ENGINE, size);
+  if (!image || fread(image, 1, size, pattern_file) != size) {
+    gprintf("Failed to read %s file.\n", filename);
+    pool_free(image);
+    fclose(pattern_file);
+    return 0;
+  }
+  fclose(pattern_file);
+
+  num_dbs = load_pattern_image(image, size);
+  if (!num_dbs)
+    pool_free(image);
+#endif
+
+  return num_dbs;
+}
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * c-basic-offset: 2
+ * End:
+ */
@@ -53,6 +53,7 @@
 #include <stdlib.h>
 #include "liberty.h"
 #include "cache.h"
+#include "gg_utils.h"
 
 
 /* ================================================================ */
@@ -106,6 +107,7 @@ struct persistent_cache_entry {
   int move2;/* second result coordinate */
   int cost; /* Usually no. of tactical nodes spent on this reading result. */
   int score; /* Heuristic guess of the worth of the cache entry. */
+  int serial; /* Number of entries stored before, in any cache. */
 };
 
 /* Callback function that implements the computation of the active area.
@@ -170,6 +172,24 @@ static struct persistent_cache semeai_cache =
     "semeai cache", compute_active_semeai_area,
     NULL, 0, -1 };
 
+/* The caches whose new entries are sent back by worker processes (see
+ * parallel.c).
+ */
+static struct persistent_cache *const exported_caches[] = {
+  &owl_cache, &semeai_cache
+};
+#define NUM_EXPORTED_CACHES \
+  ((int) (sizeof(exported_caches) / sizeof(exported_caches[0])))
+
+/* An entry of one of the exported caches. */
+struct exported_cache_entry {
+  int cache;
+  struct persistent_cache_entry entry;
+};
+
+/* Number of entries stored so far. */
+static int persistent_cache_stores = 0;
+
 /* ================================================================ */
 /* Common helper functions.   		                            */
 
@@ -457,27 +477,13 @@ search_persistent_cache(struct persistent_cache *cache,
   return 1;
 }
 
-/* Generic function that tries to store a cache entry. If the cache
- * is full, we delete the lowest scoring entry.
- *
- * Unused parameters have to be normalized to NO_MOVE by the calling
- * function.
+/* Find a place for a new entry of the given cost. If the cache is
+ * full, we delete the lowest scoring entry, unless all entries score
+ * at least the cost. Then NULL is returned.
  */
-static void
-store_persistent_cache(struct persistent_cache *cache,
-		       enum routine_id routine,
-		       int apos, int bpos, int cpos, int color,
-		       Hash_data *goal_hash,
-		       int result, int result2, int move, int move2,
-		       int certain, int node_limit,
-		       int cost, const signed char goal[BOARDMAX],
-		       int goal_color)
+static struct persistent_cache_entry *
+new_persistent_cache_entry(struct persistent_cache *cache, int cost)
 {
-  int r;
-  struct persistent_cache_entry *entry;
-  if (stackp > cache->max_stackp)
-    return;
-
   /* If cache is still full, consider kicking out an old entry. */
   if (cache->current_size == cache->max_size) {
     int worst_entry = -1;
@@ -499,10 +505,37 @@ store_persistent_cache(struct persistent_cache *cache,
       cache->current_size--;
     }
     else
-      return;
+      return NULL;
   }
 
-  entry = &(cache->table[cache->current_size]);
+  return &(cache->table[cache->current_size]);
+}
+
+/* Generic function that tries to store a cache entry. If the cache
+ * is full, we delete the lowest scoring entry.
+ *
+ * Unused parameters have to be normalized to NO_MOVE by the calling
+ * function.
+ */
+static void
+store_persistent_cache(struct persistent_cache *cache,
+		       enum routine_id routine,
+		       int apos, int bpos, int cpos, int color,
+		       Hash_data *goal_hash,
+		       int result, int result2, int move, int move2,
+		       int certain, int node_limit,
+		       int cost, const signed char goal[BOARDMAX],
+		       int goal_color)
+{
+  int r;
+  struct persistent_cache_entry *entry;
+  if (stackp > cache->max_stackp)
+    return;
+
+  entry = new_persistent_cache_entry(cache, cost);
+  if (entry == NULL)
+    return;
+
   entry->boardsize  	 = board_size;
   entry->routine    	 = routine;
   entry->apos	     	 = apos;
@@ -521,6 +554,7 @@ store_persistent_cache(struct persistent_cache *cache,
   entry->score 		 = cost;
   entry->cost 		 = cost;
   entry->movenum 	 = movenum;
+  entry->serial		 = persistent_cache_stores++;
 
   for (r = 0; r < MAX_CACHE_DEPTH; r++) {
     if (r < stackp)
@@ -548,11 +582,15 @@ store_persistent_cache(struct persistent_cache *cache,
 /* Interface functions relevant to all caches.			    */
 /* ================================================================ */
 
-/* Allocate the actual cache table. */
+/* Allocate the actual cache table, or reuse the one allocated by an
+ * earlier call.
+ */
 static void
 init_cache(struct persistent_cache *cache)
 {
-  cache->table = malloc(cache->max_size*sizeof(struct persistent_cache_entry));
+  if (cache->table == NULL)
+    cache->table = pool_malloc(POOL_ENGINE, cache->max_size
+			       * sizeof(struct persistent_cache_entry));
   gg_assert(cache->table);
 }
 
@@ -595,6 +633,64 @@ purge_persistent_caches()
   purge_persistent_cache(&semeai_cache);
 }
 
+/* The number of entries stored so far. Entries stored later can be
+ * exported with export_persistent_owl_cache().
+ */
+int
+persistent_cache_serial()
+{
+  return persistent_cache_stores;
+}
+
+/* Copy the entries of the owl and semeai caches which were stored
+ * since persistent_cache_serial() returned serial to buffer, unless
+ * buffer is NULL. Returns the number of bytes needed.
+ */
+int
+export_persistent_owl_cache(int serial, void *buffer)
+{
+  struct exported_cache_entry *exported = buffer;
+  int num_exported = 0;
+  int c;
+  int k;
+
+  for (c = 0; c < NUM_EXPORTED_CACHES; c++) {
+    struct persistent_cache *cache = exported_caches[c];
+    for (k = 0; k < cache->current_size; k++)
+      if (cache->table[k].serial >= serial) {
+	if (exported) {
+	  exported[num_exported].cache = c;
+	  exported[num_exported].entry = cache->table[k];
+	}
+	num_exported++;
+      }
+  }
+
+  return num_exported * sizeof(struct exported_cache_entry);
+}
+
+/* Store the entries exported by export_persistent_owl_cache() in
+ * another process. Like stored entries, they replace the lowest
+ * scoring entries of a full cache.
+ */
+void
+import_persistent_owl_cache(const void *buffer, int size)
+{
+  const struct exported_cache_entry *exported = buffer;
+  int k;
+
+  for (k = 0; k < size / (int) sizeof(*exported); k++) {
+    struct persistent_cache *cache = exported_caches[exported[k].cache];
+    struct persistent_cache_entry *entry
+      = new_persistent_cache_entry(cache, exported[k].entry.cost);
+    if (entry == NULL)
+      continue;
+    *entry = exported[k].entry;
+    entry->serial = persistent_cache_stores++;
+    cache->current_size++;
+  }
+}
+
 /* ================================================================ */
 /*                  Tactical reading functions                      */
 /* ================================================================ */
@@ -0,0 +1,629 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ * This is GNU Go, a Go program. Contact gnugo@gnu.org, or see       *
+ * http://www.gnu.org/software/gnugo/ for more information.          *
+ *                                                                   *
+ * Copyright 1999, 2000, 2001, 2002, 2003, 2004, 2005, 2006, 2007,   *
+ * 2008 and 2009  by the Free Software Foundation.                   *
+ *                                                                   *
+ * This program is free software; you can redistribute it and/or     *
+ * modify it under the terms of the GNU General Public License as    *
+ * published by the Free Software Foundation - version 3 or          *
+ * (at your option) any later version.                               *
+ *                                                                   *
+ * This program is distributed in the hope that it will be useful,   *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of    *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the     *
+ * GNU General Public License in file COPYING for more details.      *
+ *                                                                   *
+ * You should have received a copy of the GNU General Public         *
+ * License along with this program; if not, write to the Free        *
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,       *
+ * Boston, MA 02111, USA.                                            *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Profiling the placement of the engine tables in memory.
+ *
+ * On the ESP32 tables declared with _EMBEDDED_BSS live in PSRAM,
+ * constant data such as the compiled pattern databases in flash, and
+ * the rest in internal RAM. PSRAM and flash are read through a small
+ * cache, and every miss costs tens of cycles. Which tables are worth
+ * the scarce internal RAM depends on how often they are accessed, and
+ * how well those accesses hit the cache.
+ *
+ * A host build configured with -DPROFILE_PLACEMENT=ON compiles the
+ * engine with -fsanitize=thread, but without the thread sanitizer
+ * runtime. The instrumentation then calls the __tsan_* functions
+ * below for every memory access, and these count the accesses per
+ * table and feed them through a model of the ESP32-S3 data cache. The
+ * tables are the data symbols of the executable, found with nm, plus
+ * the transposition table, the stack and the rest of the heap.
+ * _EMBEDDED_BSS puts tables into a section of its own in this build,
+ * so that they can be told apart from the tables in internal RAM, and
+ * so does _EMBEDDED_HOT_CONST for the constant tables taken out of
+ * flash.
+ *
+ * Two caches are simulated side by side: one sees the accesses to
+ * memory outside internal RAM with the tables placed as compiled, the
+ * other sees all accesses, as if nothing were in internal RAM. The
+ * report at exit proposes the tables outside with the largest saving
+ * per byte which fit into PLACEMENT_INTERNAL_BUDGET more bytes of
+ * internal RAM, or as many as the environment variable
+ * GNUGO_INTERNAL_RAM says. It also lists the tables in internal RAM
+ * which would save less per byte if all were outside, as candidates
+ * for making room.
+ *
+ * The figures are estimates. Accesses from library functions such as
+ * memcpy() are not seen, and nor are those of the pattern matcher
+ * helpers, which are not compiled with the instrumentation.
+ */
+
+#include "gnugo.h"
+
+#ifdef PROFILE_PLACEMENT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "liberty.h"
+#include "cache.h"
+#include "gg_utils.h"
+
+/* Default internal RAM for moving tables in. */
+#define PLACEMENT_INTERNAL_BUDGET (32 * 1024)
+
+/* ESP32-S3 data cache: 32 kB, 8 ways, 32 byte lines. */
+#define CACHE_LINE_BITS	5
+#define CACHE_WAYS	8
+#define CACHE_SETS	128
+
+/* Rough cycle counts at 240 MHz. */
+#define INTERNAL_CYCLES	1
+#define CACHE_HIT_CYCLES 2
+#define CACHE_MISS_CYCLES 80
+
+#define MAX_TABLES	8192
+
+enum placement {
+  PLACE_INTERNAL,
+  PLACE_PSRAM,
+  PLACE_FLASH
+};
+
+static const char *placement_names[] = {"internal", "psram", "flash"};
+
+struct placed_table {
+  char *name;
+  unsigned long start;
+  unsigned long size;
+  enum placement placement;
+  int movable;
+  unsigned long long accesses;
+  unsigned long long misses;		/* As placed. */
+  unsigned long long external_misses;	/* With all tables outside. */
+};
+
+struct cache_model {
+  unsigned long tag[CACHE_SETS][CACHE_WAYS];
+  unsigned long long used[CACHE_SETS][CACHE_WAYS];
+  unsigned long long clock;
+};
+
+/* Sorted by address. */
+static struct placed_table tables[MAX_TABLES];
+static int num_tables = 0;
+
+static struct placed_table transposition_table = {
+  "<transposition table>", 0, 0, PLACE_PSRAM, 1, 0, 0, 0};
+static struct placed_table stack = {
+  "<stack>", 0, 0, PLACE_PSRAM, 0, 0, 0, 0};
+static struct placed_table heap = {
+  "<heap>", 0, 0, PLACE_PSRAM, 0, 0, 0, 0};
+
+static struct cache_model placed_cache;
+static struct cache_model external_cache;
+
+static int profiling = 0;
+
+/* The tables declared _EMBEDDED_BSS and _EMBEDDED_HOT_CONST, see
+ * config.h.
+ */
+extern char __start_gg_psram[] __attribute__((weak));
+extern char __stop_gg_psram[] __attribute__((weak));
+extern char __start_gg_dram[] __attribute__((weak));
+extern char __stop_gg_dram[] __attribute__((weak));
+
+
+/* Look up an access in the cache. Returns 1 on a miss. */
+static int
+cache_access(struct cache_model *cache, unsigned long addr)
+{
+  unsigned long line = addr >> CACHE_LINE_BITS;
+  int set = line % CACHE_SETS;
+  int oldest = 0;
+  int k;
+
+  cache->clock++;
+  for (k = 0; k < CACHE_WAYS; k++) {
+    if (cache->used[set][k] && cache->tag[set][k] == line) {
+      cache->used[set][k] = cache->clock;
+      return 0;
+    }
+    if (cache->used[set][k] < cache->used[set][oldest])
+      oldest = k;
+  }
+
+  cache->tag[set][oldest] = line;
+  cache->used[set][oldest] = cache->clock;
+  return 1;
+}
+
+
+static struct placed_table *
+find_table(unsigned long addr)
+{
+  int low = 0;
+  int high = num_tables;
+
+  if (addr - transposition_table.start < transposition_table.size)
+    return &transposition_table;
+
+  /* The last table starting at or below addr. */
+  while (high - low > 1) {
+    int mid = (low + high) / 2;
+    if (tables[mid].start <= addr)
+      low = mid;
+    else
+      high = mid;
+  }
+  if (num_tables > 0 && addr - tables[low].start < tables[low].size)
+    return &tables[low];
+
+  if (addr - stack.start < stack.size)
+    return &stack;
+  return &heap;
+}
+
+
+static void
+record_access(const void *ptr)
+{
+  unsigned long addr = (unsigned long) ptr;
+  struct placed_table *table;
+
+  if (!profiling)
+    return;
+
+  table = find_table(addr);
+  table->accesses++;
+  if (table->placement != PLACE_INTERNAL
+      && cache_access(&placed_cache, addr))
+    table->misses++;
+  if (cache_access(&external_cache, addr))
+    table->external_misses++;
+}
+
+
+static int
+compare_start(const void *a, const void *b)
+{
+  const struct placed_table *ta = a;
+  const struct placed_table *tb = b;
+
+  if (ta->start < tb->start)
+    return -1;
+  return ta->start > tb->start;
+}
+
+
+/* Read the data symbols of the executable. The load address is found
+ * from the address of board[].
+ */
+static int
+read_symbols(void)
+{
+  char exe[512];
+  char line[1024];
+  FILE *nm;
+  unsigned long offset = 0;
+  int have_offset = 0;
+  int length;
+  int k;
+
+  length = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+  if (length <= 0)
+    return 0;
+  exe[length] = '\0';
+
+  gg_snprintf(line, sizeof(line), "nm -S --defined-only '%s'", exe);
+  nm = popen(line, "r");
+  if (!nm)
+    return 0;
+
+  while (fgets(line, sizeof(line), nm) && num_tables < MAX_TABLES) {
+    unsigned long value;
+    unsigned long size;
+    char type;
+    char name[512];
+
+    if (sscanf(line, "%lx %lx %c %511s", &value, &size, &type, name) != 4
+	|| size == 0 || !strchr("bBdDrR", type))
+      continue;
+
+    if (strcmp(name, "board") == 0) {
+      offset = (unsigned long) board - value;
+      have_offset = 1;
+    }
+
+    tables[num_tables].name = strdup(name);
+    tables[num_tables].start = value;
+    tables[num_tables].size = size;
+    tables[num_tables].placement = (type == 'r' || type == 'R'
+				    ? PLACE_FLASH : PLACE_INTERNAL);
+    tables[num_tables].movable = 1;
+    num_tables++;
+  }
+  pclose(nm);
+
+  if (!have_offset)
+    return 0;
+
+  for (k = 0; k < num_tables; k++) {
+    tables[k].start += offset;
+    if (tables[k].start >= (unsigned long) __start_gg_psram
+	&& tables[k].start < (unsigned long) __stop_gg_psram)
+      tables[k].placement = PLACE_PSRAM;
+    if (tables[k].start >= (unsigned long) __start_gg_dram
+	&& tables[k].start < (unsigned long) __stop_gg_dram)
+      tables[k].placement = PLACE_INTERNAL;
+  }
+  qsort(tables, num_tables, sizeof(tables[0]), compare_start);
+
+  return 1;
+}
+
+
+static unsigned long long
+table_cycles(struct placed_table *table, unsigned long long misses)
+{
+  return misses * CACHE_MISS_CYCLES
+    + (table->accesses - misses) * CACHE_HIT_CYCLES;
+}
+
+
+/* Cycles saved by moving the table into internal RAM, when all other
+ * tables are outside.
+ */
+static unsigned long long
+internal_saving(struct placed_table *table)
+{
+  return table_cycles(table, table->external_misses)
+    - table->accesses * INTERNAL_CYCLES;
+}
+
+
+/* Tables which only differ by a number at the end of the name, such as
+ * the element arrays owl_defendpat0, owl_defendpat1, ... of a pattern
+ * database, are reported and placed together.
+ */
+struct table_group {
+  char name[64];
+  unsigned long size;
+  int placement;		/* -1 if mixed. */
+  int movable;
+  unsigned long long accesses;
+  unsigned long long misses;
+  unsigned long long external_misses;
+  unsigned long long saving;		/* With all tables outside. */
+  unsigned long outside_size;
+  unsigned long long outside_saving;	/* As placed. */
+};
+
+static void
+group_name(const char *name, char *group)
+{
+  int length;
+
+  gg_snprintf(group, 64, "%s", name);
+  length = strlen(group);
+  while (length > 1 && group[length - 1] >= '0' && group[length - 1] <= '9')
+    length--;
+  if (group[length - 1] != '.' && group[length - 1] != '_')
+    group[length] = '\0';
+}
+
+
+static int
+compare_name(const void *a, const void *b)
+{
+  return strcmp(((const struct table_group *) a)->name,
+		((const struct table_group *) b)->name);
+}
+
+
+static double
+outside_saving_per_byte(const struct table_group *group)
+{
+  if (group->outside_size == 0)
+    return 0.0;
+  return (double) group->outside_saving / group->outside_size;
+}
+
+
+static int
+compare_saving_per_byte(const void *a, const void *b)
+{
+  double sa = outside_saving_per_byte(a);
+  double sb = outside_saving_per_byte(b);
+
+  if (sa > sb)
+    return -1;
+  return sa < sb;
+}
+
+
+/* Collect the tables into groups, sorted by the saving per byte of
+ * moving their parts outside internal RAM in. Returns the number of
+ * groups.
+ */
+static int
+make_groups(struct table_group *groups)
+{
+  struct placed_table *others[3];
+  int num_groups = 0;
+  int k;
+
+  others[0] = &transposition_table;
+  others[1] = &stack;
+  others[2] = &heap;
+
+  for (k = 0; k < num_tables + 3; k++) {
+    struct placed_table *table = k < num_tables ? &tables[k]
+				 : others[k - num_tables];
+    struct table_group *group = &groups[k];
+
+    group_name(table->name, group->name);
+    group->size = table->size;
+    group->placement = table->placement;
+    group->movable = table->movable;
+    group->accesses = table->accesses;
+    group->misses = table->misses;
+    group->external_misses = table->external_misses;
+    group->saving = internal_saving(table);
+    if (table->placement == PLACE_INTERNAL) {
+      group->outside_size = 0;
+      group->outside_saving = 0;
+    }
+    else {
+      group->outside_size = table->size;
+      group->outside_saving = table_cycles(table, table->misses)
+	- table->accesses * INTERNAL_CYCLES;
+    }
+  }
+  qsort(groups, num_tables + 3, sizeof(groups[0]), compare_name);
+
+  for (k = 0; k < num_tables + 3; k++) {
+    struct table_group *group = &groups[num_groups - 1];
+    if (num_groups > 0 && strcmp(group->name, groups[k].name) == 0) {
+      group->size += groups[k].size;
+      if (group->placement != groups[k].placement)
+	group->placement = -1;
+      group->accesses += groups[k].accesses;
+      group->misses += groups[k].misses;
+      group->external_misses += groups[k].external_misses;
+      group->saving += groups[k].saving;
+      group->outside_size += groups[k].outside_size;
+      group->outside_saving += groups[k].outside_saving;
+    }
+    else
+      groups[num_groups++] = groups[k];
+  }
+  qsort(groups, num_groups, sizeof(groups[0]), compare_saving_per_byte);
+
+  return num_groups;
+}
+
+
+static const char *
+group_placement(struct table_group *group)
+{
+  if (group->placement < 0)
+    return "mixed";
+  return placement_names[group->placement];
+}
+
+
+/* Print the access counts of the tables and the simulated cost of
+ * their placement, and propose a placement for the internal RAM
+ * budget.
+ */
+void
+placement_report(FILE *outfile)
+{
+  struct table_group *groups;
+  signed char *proposed;
+  unsigned long long total = 0;
+  unsigned long long placed_cost = 0;
+  unsigned long long external_cost = 0;
+  unsigned long long proposed_cost;
+  unsigned long budget = PLACEMENT_INTERNAL_BUDGET;
+  unsigned long used = 0;
+  unsigned long placed_internal = 0;
+  double least_saving = 0.0;
+  int num_groups;
+  const char *env = getenv("GNUGO_INTERNAL_RAM");
+  int k;
+
+  if (env)
+    budget = strtoul(env, NULL, 0);
+
+  groups = malloc((num_tables + 3) * sizeof(*groups));
+  proposed = calloc(num_tables + 3, 1);
+  if (!groups || !proposed) {
+    free(groups);
+    free(proposed);
+    return;
+  }
+
+  num_groups = make_groups(groups);
+  for (k = 0; k < num_groups; k++) {
+    struct table_group *group = &groups[k];
+    total += group->accesses;
+    external_cost += group->external_misses * CACHE_MISS_CYCLES
+      + (group->accesses - group->external_misses) * CACHE_HIT_CYCLES;
+  }
+  for (k = 0; k < num_tables; k++) {
+    if (tables[k].placement == PLACE_INTERNAL) {
+      placed_cost += tables[k].accesses * INTERNAL_CYCLES;
+      placed_internal += tables[k].size;
+    }
+    else
+      placed_cost += table_cycles(&tables[k], tables[k].misses);
+  }
+  placed_cost += table_cycles(&transposition_table,
+			      transposition_table.misses);
+  placed_cost += table_cycles(&stack, stack.misses);
+  placed_cost += table_cycles(&heap, heap.misses);
+
+  if (total == 0) {
+    fprintf(outfile, "placement: no accesses recorded\n");
+    free(groups);
+    free(proposed);
+    return;
+  }
+
+  fprintf(outfile, "\n%-32s %9s %-8s %7s %9s %12s %12s\n",
+	  "table", "bytes", "placed", "access", "per byte",
+	  "misses", "ext misses");
+  for (k = 0; k < num_groups; k++) {
+    struct table_group *group = &groups[k];
+    if (group->accesses * 1000 < total)
+      continue;
+    fprintf(outfile, "%-32s %9lu %-8s %6.2f%% %9.1f %12llu %12llu\n",
+	    group->name, group->size, group_placement(group),
+	    100.0 * group->accesses / total,
+	    group->size ? (double) group->accesses / group->size : 0.0,
+	    group->misses, group->external_misses);
+  }
+
+  fprintf(outfile, "\n%llu accesses, %lu bytes of tables in internal RAM\n",
+	  total, placed_internal);
+  fprintf(outfile, "estimated cycles as placed:   %14llu\n", placed_cost);
+  fprintf(outfile, "estimated cycles all outside: %14llu\n", external_cost);
+
+  /* Fill the budget with the largest savings per byte. */
+  proposed_cost = placed_cost;
+  for (k = 0; k < num_groups; k++) {
+    struct table_group *group = &groups[k];
+    if (!group->movable || group->outside_saving == 0
+	|| used + group->outside_size > budget)
+      continue;
+    proposed[k] = 1;
+    used += group->outside_size;
+    proposed_cost -= group->outside_saving;
+    least_saving = outside_saving_per_byte(group);
+  }
+
+  fprintf(outfile, "\n%lu more bytes of internal RAM, %lu used:\n",
+	  budget, used);
+  for (k = 0; k < num_groups; k++)
+    if (proposed[k])
+      fprintf(outfile, "  move in   %-32s %9lu %s\n", groups[k].name,
+	      groups[k].outside_size, group_placement(&groups[k]));
+  fprintf(outfile, "estimated cycles as proposed: %14llu\n", proposed_cost);
+
+  for (k = 0; k < num_groups; k++)
+    if (groups[k].placement == PLACE_INTERNAL && groups[k].movable
+	&& groups[k].accesses > 0 && groups[k].size >= 1024
+	&& (double) groups[k].saving / groups[k].size < least_saving)
+      fprintf(outfile, "  could go  %-32s %9lu\n", groups[k].name,
+	      groups[k].size);
+
+  free(groups);
+  free(proposed);
+}
+
+
+static void
+report_at_exit(void)
+{
+  profiling = 0;
+  placement_report(stderr);
+}
+
+
+/* Start counting accesses. Must be called after init_gnugo(), when the
+ * transposition table is allocated.
+ */
+void
+placement_profile_start(void)
+{
+  char here;
+
+  if (!read_symbols()) {
+    fprintf(stderr, "placement: cannot read the symbols of the executable\n");
+    return;
+  }
+
+  transposition_table.start = (unsigned long) ttable.entries;
+  transposition_table.size = ttable.num_entries * sizeof(Hashentry);
+  stack.start = (unsigned long) &here + 65536 - 64 * 1024 * 1024;
+  stack.size = 64 * 1024 * 1024;
+
+  atexit(report_at_exit);
+  profiling = 1;
+}
+
+
+/* Entry points of the thread sanitizer instrumentation. */
+
+void __tsan_init(void) {}
+void __tsan_func_entry(void *call_pc) { UNUSED(call_pc); }
+void __tsan_func_exit(void) {}
+
+#define ACCESS_HOOK(name) \
+  void name(void *addr) { record_access(addr); }
+
+ACCESS_HOOK(__tsan_read1)
+ACCESS_HOOK(__tsan_read2)
+ACCESS_HOOK(__tsan_read4)
+ACCESS_HOOK(__tsan_read8)
+ACCESS_HOOK(__tsan_read16)
+ACCESS_HOOK(__tsan_write1)
+ACCESS_HOOK(__tsan_write2)
+ACCESS_HOOK(__tsan_write4)
+ACCESS_HOOK(__tsan_write8)
+ACCESS_HOOK(__tsan_write16)
+ACCESS_HOOK(__tsan_unaligned_read2)
+ACCESS_HOOK(__tsan_unaligned_read4)
+ACCESS_HOOK(__tsan_unaligned_read8)
+ACCESS_HOOK(__tsan_unaligned_read16)
+ACCESS_HOOK(__tsan_unaligned_write2)
+ACCESS_HOOK(__tsan_unaligned_write4)
+ACCESS_HOOK(__tsan_unaligned_write8)
+ACCESS_HOOK(__tsan_unaligned_write16)
+
+void
+__tsan_read_range(void *addr, unsigned long size)
+{
+  UNUSED(size);
+  record_access(addr);
+}
+
+void
+__tsan_write_range(void *addr, unsigned long size)
+{
+  UNUSED(size);
+  record_access(addr);
+}
+
+#endif	/* PROFILE_PLACEMENT */
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * c-basic-offset: 2
+ * End:
+ */
@@ -0,0 +1,306 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ * This is GNU Go, a Go program. Contact gnugo@gnu.org, or see       *
+ * http://www.gnu.org/software/gnugo/ for more information.          *
+ *                                                                   *
+ * Copyright 1999, 2000, 2001, 2002, 2003, 2004, 2005, 2006, 2007,   *
+ * 2008 and 2009  by the Free Software Foundation.                   *
+ *                                                                   *
+ * This program is free software; you can redistribute it and/or     *
+ * modify it under the terms of the GNU General Public License as    *
+ * published by the Free Software Foundation - version 3 or          *
+ * (at your option) any later version.                               *
+ *                                                                   *
+ * This program is distributed in the hope that it will be useful,   *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of    *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the     *
+ * GNU General Public License in file COPYING for more details.      *
+ *                                                                   *
+ * You should have received a copy of the GNU General Public         *
+ * License along with this program; if not, write to the Free        *
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,       *
+ * Boston, MA 02111, USA.                                            *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Pondering: thinking on the opponent's time.
+ *
+ * After our move the engine would be idle until the opponent's reply
+ * arrives. Instead the interface calls ponder() repeatedly while it
+ * waits. The first call predicts a few likely replies by generating a
+ * move for the opponent. Each following call plays one of them and
+ * generates our answer, which is stored. If the opponent then plays
+ * a predicted move, genmove() returns the stored answer at once.
+ * Either way the persistent caches have been filled with the reading
+ * of the position.
+ *
+ * A call to ponder() is abandoned as soon as the opponent's move
+ * arrives, see interrupt.c.
+ */
+
+#include "gnugo.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "liberty.h"
+#include "sgftree.h"
+
+/* Number of replies to the opponent's predicted moves that we prepare. */
+#define MAX_PONDER_REPLIES 3
+
+/* The options which change the move generation. An answer is only
+ * used with the options it was prepared with, so that e.g.
+ * kgs-genmove_cleanup, which turns on capture_all_dead, does not get
+ * the answer of a plain genmove.
+ */
+struct ponder_options {
+  int level;
+  float komi;
+  int chinese_rules;
+  int ko_rule;
+  int suicide_rule;
+  int capture_all_dead;
+  int play_out_aftermath;
+  int doing_scoring;
+  int forced_moves;
+  int resign_allowed;
+  int fusekidb;
+  int disable_fuseki;
+  int josekidb;
+  int play_mirror_go;
+  int mirror_stones_limit;
+  int experimental_owl_ext;
+  int experimental_connections;
+  int alternate_connections;
+  int owl_threats;
+  int use_monte_carlo_genmove;
+  int mc_games_per_level;
+};
+
+/* Our answer in the position after a predicted move. */
+struct ponder_result {
+  Hash_data hash;
+  int color;
+  struct ponder_options options;
+  int move;
+  float value;
+  int resign;
+};
+
+static struct ponder_result ponder_results[MAX_PONDER_REPLIES];
+static int num_ponder_results = 0;
+
+/* The position we ponder on, with the opponent to move. */
+static int ponder_color = EMPTY;
+static Hash_data ponder_hash;
+static int ponder_movenum;
+
+/* The predicted moves, or num_ponder_moves == -1 if not known yet. */
+static int ponder_moves[MAX_PONDER_REPLIES];
+static int num_ponder_moves;
+static int next_ponder_move;
+
+
+/* Get the current options. The struct is cleared first so that it
+ * can be compared with memcmp().
+ */
+static void
+get_ponder_options(struct ponder_options *options)
+{
+  memset(options, 0, sizeof(*options));
+  options->level = get_level();
+  options->komi = komi;
+  options->chinese_rules = chinese_rules;
+  options->ko_rule = ko_rule;
+  options->suicide_rule = suicide_rule;
+  options->capture_all_dead = capture_all_dead;
+  options->play_out_aftermath = play_out_aftermath;
+  options->doing_scoring = doing_scoring;
+  options->forced_moves = forced_moves;
+  options->resign_allowed = resign_allowed;
+  options->fusekidb = fusekidb;
+  options->disable_fuseki = disable_fuseki;
+  options->josekidb = josekidb;
+  options->play_mirror_go = play_mirror_go;
+  options->mirror_stones_limit = mirror_stones_limit;
+  options->experimental_owl_ext = experimental_owl_ext;
+  options->experimental_connections = experimental_connections;
+  options->alternate_connections = alternate_connections;
+  options->owl_threats = owl_threats;
+  options->use_monte_carlo_genmove = use_monte_carlo_genmove;
+  options->mc_games_per_level = mc_games_per_level;
+}
+
+
+/* Start pondering in the current position, where color is the
+ * opponent to move. Answers prepared for an earlier position are
+ * forgotten.
+ */
+void
+ponder_start(int color)
+{
+  ponder_color = color;
+  ponder_hash = board_hash;
+  ponder_movenum = movenum;
+  num_ponder_moves = -1;
+  next_ponder_move = 0;
+  num_ponder_results = 0;
+}
+
+
+/* Predict the opponent's move by generating a move of his color.
+ * The top moves of the move valuation give the alternatives.
+ */
+static void
+predict_moves(void)
+{
+  int move = genmove(ponder_color, NULL, NULL);
+  int k;
+
+  num_ponder_moves = 0;
+  if (move != PASS_MOVE)
+    ponder_moves[num_ponder_moves++] = move;
+
+  for (k = 0; k < 10 && num_ponder_moves < MAX_PONDER_REPLIES; k++) {
+    if (best_moves[k] == NO_MOVE || best_move_values[k] <= 0.0)
+      break;
+    if (best_moves[k] != move && is_legal(best_moves[k], ponder_color))
+      ponder_moves[num_ponder_moves++] = best_moves[k];
+  }
+}
+
+
+/* Play the next predicted move and prepare our answer. */
+static void
+prepare_answer(void)
+{
+  int color = OTHER_COLOR(ponder_color);
+  struct ponder_result *result = &ponder_results[num_ponder_results];
+
+  play_move(ponder_moves[next_ponder_move], ponder_color);
+  result->hash = board_hash;
+  result->color = color;
+  get_ponder_options(&result->options);
+  result->move = genmove(color, &result->value, &result->resign);
+  undo_move(1);
+
+  num_ponder_results++;
+  next_ponder_move++;
+}
+
+
+/* One step of pondering, run by run_interruptible(). */
+static void
+ponder_step(void *data)
+{
+  UNUSED(data);
+
+  /* Ponder silently. A longjmp() must not happen in the worker
+   * processes of parallel.c, so the owl reading is done here. The
+   * options are restored by run_interruptible().
+   */
+  verbose = 0;
+  debug = 0;
+  printworms = 0;
+  printmoyo = 0;
+  printboard = 0;
+  showtime = 0;
+  showscore = 0;
+  sgf_dumptree = NULL;
+  count_variations = 0;
+  owl_workers = 0;
+
+  if (num_ponder_moves < 0)
+    predict_moves();
+  else
+    prepare_answer();
+}
+
+
+/* Do one step of pondering. Returns 1 if there is more to do, 0 if
+ * the work for this position is done, the position has changed since
+ * ponder_start(), or the step was interrupted.
+ *
+ * The interrupt callback, if not NULL, is polled during the step and
+ * abandons it by returning nonzero. So does interrupt_search().
+ */
+int
+ponder(int (*interrupt)(void))
+{
+  float save_white_score = white_score;
+  float save_black_score = black_score;
+  int finished;
+
+  if (ponder_color == EMPTY || stackp > 0)
+    return 0;
+
+  if (movenum != ponder_movenum
+      || !hashdata_is_equal(board_hash, ponder_hash)) {
+    ponder_color = EMPTY;
+    return 0;
+  }
+
+  if (num_ponder_moves >= 0 && next_ponder_move >= num_ponder_moves)
+    return 0;
+
+  genmove_trace_enable(0);
+  finished = run_interruptible(ponder_step, NULL, interrupt);
+  genmove_trace_enable(1);
+
+  /* The scores are reported to the user for the actual position. */
+  white_score = save_white_score;
+  black_score = save_black_score;
+
+  return finished && next_ponder_move < num_ponder_moves;
+}
+
+
+/* Look for an answer prepared by ponder() in the current position.
+ * Returns 1 and sets move, value and resign (the latter two if not
+ * NULL) if one is found.
+ */
+int
+ponder_lookup(int color, int *move, float *value, int *resign)
+{
+  struct ponder_options options;
+  int k;
+
+  get_ponder_options(&options);
+  for (k = 0; k < num_ponder_results; k++) {
+    struct ponder_result *result = &ponder_results[k];
+    if (result->color == color
+	&& memcmp(&result->options, &options, sizeof(options)) == 0
+	&& hashdata_is_equal(result->hash, board_hash)) {
+      *move = result->move;
+      if (value)
+	*value = result->value;
+      if (resign)
+	*resign = result->resign;
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+
+/* Get the predicted moves which have an answer prepared, at most
+ * max_moves of them. Returns their number.
+ */
+int
+ponder_prepared_moves(int *moves, int max_moves)
+{
+  int k;
+
+  for (k = 0; k < num_ponder_results && k < max_moves; k++)
+    moves[k] = ponder_moves[k];
+
+  return k;
+}
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * c-basic-offset: 2
+ * End:
+ */
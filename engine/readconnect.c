@@ -97,6 +97,9 @@ static signed char breakin_shadow[BOARDMAX];
 /* Statistics. */
 static int global_connection_node_counter = 0;
 
+/* Number of connection results taken from the caches. */
+static int connection_cached_results = 0;
+
 static void
 init_zone(zone *zn)
 {
@@ -1060,6 +1063,265 @@ quiescence_connect(int str1, int str2, int *move)
 }
 
 
+/* ================================================================ */
+/*                  Connection zone cache                           */
+/* ================================================================ */
+
+/* The result of a connection reading only depends on the stones close
+ * to the points where the reading played. The results of
+ * string_connect() and disconnect() are therefore cached together
+ * with the contents of this local zone, stored relative to the first
+ * string. A cached result is reused whenever the zone has the same
+ * contents, also after unrelated moves or for the same shape elsewhere
+ * on the board. The zone includes the edge points next to it, so a
+ * shape is only reused at the same distance from the edge.
+ *
+ * The zone consists of
+ * the points where a move was tried during the reading +
+ * the two strings and the result move +
+ * the neighbors of those points +
+ * all strings with a stone in the zone, with their liberties if they
+ * have at most four. Strings with more liberties are required to keep
+ * more than four.
+ */
+
+#define ZONE_CACHE_SIZE     64
+#define ZONE_CACHE_WAYS     4
+#define MAX_CACHED_ZONE     256
+#define ZONE_HIGH_LIBERTY   4
+
+struct zone_cache_entry {
+  unsigned int key;     /* 0 for an unused entry */
+  unsigned int last_used;
+  int routine;
+  int str2;             /* offsets from the first string */
+  int move;
+  int result;
+  int node_limit;
+  int remaining_depth;
+  int remaining_connect_depth;
+  int zone_size;
+  short zone_pos[MAX_CACHED_ZONE];
+  signed char zone_color[MAX_CACHED_ZONE]; /* color | ZONE_HIGH_LIBERTY */
+};
+
+static struct zone_cache_entry _EMBEDDED_BSS zone_cache[ZONE_CACHE_SIZE];
+static unsigned int zone_cache_clock = 0;
+
+
+/* The cache bucket for a query is chosen from properties of the two
+ * strings which do not depend on where they are on the board.
+ */
+static unsigned int
+zone_cache_key(int routine, int str1, int str2)
+{
+  unsigned int key = routine;
+  key = 31 * key + (str2 - str1 + BOARDMAX);
+  key = 31 * key + board[str1];
+  key = 31 * key + countstones(str1);
+  key = 31 * key + countstones(str2);
+  key = 31 * key + countlib(str1);
+  key = 31 * key + countlib(str2);
+  if (key == 0)
+    key = 1;
+  return key;
+}
+
+
+/* The zone cache is only used when the result can't depend on ko
+ * status or on reading traces.
+ */
+static int
+zone_cache_usable(void)
+{
+  return (get_komaster() == EMPTY
+	  && board_ko_pos == NO_MOVE
+	  && sgf_dumptree == NULL);
+}
+
+
+/* Look for a cached result of routine for the strings (str1) and
+ * (str2). Returns 1 and sets *result and *move if one is found.
+ */
+static int
+search_zone_cache(int routine, int str1, int str2, int *result, int *move)
+{
+  unsigned int key;
+  int first;
+  int k, r;
+
+  if (!zone_cache_usable())
+    return 0;
+
+  key = zone_cache_key(routine, str1, str2);
+  first = (key % (ZONE_CACHE_SIZE / ZONE_CACHE_WAYS)) * ZONE_CACHE_WAYS;
+  for (k = first; k < first + ZONE_CACHE_WAYS; k++) {
+    struct zone_cache_entry *entry = &zone_cache[k];
+    if (entry->key != key
+	|| entry->routine != routine
+	|| entry->str2 != str2 - str1
+	|| entry->node_limit != connection_node_limit
+	|| entry->remaining_depth != depth - stackp
+	|| entry->remaining_connect_depth != connect_depth2 - stackp)
+      continue;
+
+    for (r = 0; r < entry->zone_size; r++) {
+      int pos = str1 + entry->zone_pos[r];
+      int color = entry->zone_color[r];
+      if (pos < 0 || pos >= BOARDSIZE
+	  || board[pos] != (color & ~ZONE_HIGH_LIBERTY)
+	  || ((color & ZONE_HIGH_LIBERTY) && countlib(pos) <= 4))
+	break;
+    }
+    if (r < entry->zone_size)
+      continue;
+
+    entry->last_used = ++zone_cache_clock;
+    connection_cached_results++;
+    *result = entry->result;
+    if (entry->move == NO_MOVE)
+      *move = NO_MOVE;
+    else
+      *move = str1 + entry->move;
+    return 1;
+  }
+
+  return 0;
+}
+
+
+/* Number of results, tactical or connection, taken from the caches
+ * so far. A search during which this changed used results whose zone
+ * we don't know, so it must not be stored in the zone cache.
+ */
+static int
+zone_cached_results(void)
+{
+  return get_reading_cached_results() + connection_cached_results;
+}
+
+
+/* Add (pos) to the zone list unless it is there already. Returns 0 if
+ * the zone gets too large.
+ */
+static int
+add_cached_zone_point(int pos, signed char mark[BOARDSIZE],
+		      int zone[MAX_CACHED_ZONE], int *zone_size)
+{
+  if (mark[pos])
+    return 1;
+  if (*zone_size == MAX_CACHED_ZONE)
+    return 0;
+  mark[pos] = 1;
+  zone[(*zone_size)++] = pos;
+  return 1;
+}
+
+
+/* Store the result of routine for the strings (str1) and (str2),
+ * which was read after the shadow clock showed first_stamp and
+ * zone_cached_results() returned first_cached.
+ */
+static void
+store_zone_cache(int routine, int str1, int str2, int result, int move,
+		 unsigned int first_stamp, int first_cached)
+{
+  signed char mark[BOARDSIZE];
+  int zone[MAX_CACHED_ZONE];
+  int zone_size = 0;
+  int core_size;
+  unsigned int key;
+  struct zone_cache_entry *entry;
+  int first;
+  int pos;
+  int k, r;
+  int ok = 1;
+
+  if (!zone_cache_usable()
+      || zone_cached_results() != first_cached)
+    return;
+
+  memset(mark, 0, sizeof(mark));
+  for (pos = BOARDMIN; pos < BOARDMAX && ok; pos++)
+    if (ON_BOARD(pos)
+	&& shadow_stamp[pos] - first_stamp - 1 < shadow_clock - first_stamp)
+      ok = add_cached_zone_point(pos, mark, zone, &zone_size);
+
+  if (ON_BOARD(move) && ok)
+    ok = add_cached_zone_point(move, mark, zone, &zone_size);
+
+  for (r = 0; r < 2 && ok; r++) {
+    int stones[MAX_BOARD * MAX_BOARD];
+    int num_stones = findstones(r == 0 ? str1 : str2,
+				MAX_BOARD * MAX_BOARD, stones);
+    for (k = 0; k < num_stones && ok; k++)
+      ok = add_cached_zone_point(stones[k], mark, zone, &zone_size);
+  }
+
+  core_size = zone_size;
+  for (r = 0; r < core_size && ok; r++)
+    for (k = 0; k < 4 && ok; k++)
+      ok = add_cached_zone_point(zone[r] + delta[k], mark, zone, &zone_size);
+
+  /* Complete the strings in the zone. The list grows while we scan it,
+   * which also completes strings reached through liberties.
+   */
+  for (r = 0; r < zone_size && ok; r++) {
+    int stones[MAX_BOARD * MAX_BOARD];
+    int libs[4];
+    int num_stones;
+    int liberties;
+
+    if (!IS_STONE(board[zone[r]]) || mark[zone[r]] == 2)
+      continue;
+
+    num_stones = findstones(zone[r], MAX_BOARD * MAX_BOARD, stones);
+    for (k = 0; k < num_stones && ok; k++) {
+      ok = add_cached_zone_point(stones[k], mark, zone, &zone_size);
+      mark[stones[k]] = 2;
+    }
+
+    liberties = findlib(zone[r], 4, libs);
+    if (liberties <= 4)
+      for (k = 0; k < liberties && ok; k++)
+	ok = add_cached_zone_point(libs[k], mark, zone, &zone_size);
+  }
+
+  if (!ok)
+    return;
+
+  key = zone_cache_key(routine, str1, str2);
+  first = (key % (ZONE_CACHE_SIZE / ZONE_CACHE_WAYS)) * ZONE_CACHE_WAYS;
+  entry = &zone_cache[first];
+  for (k = first; k < first + ZONE_CACHE_WAYS; k++) {
+    if (zone_cache[k].key == 0) {
+      entry = &zone_cache[k];
+      break;
+    }
+    if (zone_cache[k].last_used < entry->last_used)
+      entry = &zone_cache[k];
+  }
+
+  entry->key = key;
+  entry->last_used = ++zone_cache_clock;
+  entry->routine = routine;
+  entry->str2 = str2 - str1;
+  entry->move = (ON_BOARD(move) ? move - str1 : NO_MOVE);
+  entry->result = result;
+  entry->node_limit = connection_node_limit;
+  entry->remaining_depth = depth - stackp;
+  entry->remaining_connect_depth = connect_depth2 - stackp;
+  entry->zone_size = zone_size;
+  for (r = 0; r < zone_size; r++) {
+    pos = zone[r];
+    entry->zone_pos[r] = pos - str1;
+    entry->zone_color[r] = board[pos];
+    if (IS_STONE(board[pos]) && countlib(pos) > 4)
+      entry->zone_color[r] |= ZONE_HIGH_LIBERTY;
+  }
+}
+
+
 /* A persistent connection cache has been implemented, but currently
  * (3.3.15) it does not have much impact on performance. Possible
  * explanations for this include:
@@ -1102,6 +1364,8 @@ string_connect(int str1, int str2, int *move)
     double start = 0;
     int tactical_nodes;
     int save_connection_node_limit = connection_node_limit;
+    unsigned int first_stamp;
+    int first_cached;
 #if USE_PERSISTENT_CONNECTION_CACHE == 1
     int result2 = -1;
     int move2;
@@ -1131,12 +1395,20 @@ string_connect(int str1, int str2, int *move)
 #endif
 
     connection_node_limit *= pow(1.45, -stackp + get_depth_modification());
+    if (search_zone_cache(CONNECT, str1, str2, &result, move)) {
+      connection_node_limit = save_connection_node_limit;
+      return result;
+    }
     save_verbose = verbose;
     if (verbose > 0)
       verbose--;
     start = gg_cputime();
+    first_stamp = shadow_clock;
+    first_cached = zone_cached_results();
     memset(connection_shadow, 0, sizeof(connection_shadow));
     result = recursive_connect2(str1, str2, move, 0);
+    store_zone_cache(CONNECT, str1, str2, result, *move, first_stamp,
+		     first_cached);
     verbose = save_verbose;
     tactical_nodes = get_reading_node_counter() - reading_nodes_when_called;
     connection_node_limit = save_connection_node_limit;
@@ -1287,6 +1559,8 @@ disconnect(int str1, int str2, int *move)
     int save_connection_node_limit = connection_node_limit;
     double start = 0;
     int tactical_nodes;
+    unsigned int first_stamp;
+    int first_cached;
 #if USE_PERSISTENT_CONNECTION_CACHE == 1
     int result2 = -1;
     int move2;
@@ -1316,12 +1590,20 @@ disconnect(int str1, int str2, int *move)
 #endif
 
     connection_node_limit *= pow(1.5, -stackp + get_depth_modification());
+    if (search_zone_cache(DISCONNECT, str1, str2, &result, move)) {
+      connection_node_limit = save_connection_node_limit;
+      return result;
+    }
     save_verbose = verbose;
     if (verbose > 0)
       verbose--;
     start = gg_cputime();
+    first_stamp = shadow_clock;
+    first_cached = zone_cached_results();
     memset(connection_shadow, 0, sizeof(connection_shadow));
     result = recursive_disconnect2(str1, str2, move, 0);
+    store_zone_cache(DISCONNECT, str1, str2, result, *move, first_stamp,
+		   first_cached);
     verbose = save_verbose;
     tactical_nodes = get_reading_node_counter() - reading_nodes_when_called;
     connection_node_limit = save_connection_node_limit;
@@ -1382,6 +1664,12 @@ fast_disconnect(int str1, int str2, int *move)
   int result;
   int save_limit = connection_node_limit;
   int save_verbose = verbose;
+  int dummy_move;
+  unsigned int first_stamp;
+  int first_cached;
+
+  if (move == NULL)
+    move = &dummy_move;
 
   if (board[str1] == EMPTY || board[str2] == EMPTY)
     return WIN;
@@ -1396,9 +1684,19 @@ fast_disconnect(int str1, int str2, int *move)
   modify_depth_values(-3);
   connection_node_limit /= 4;
 
+  if (search_zone_cache(DISCONNECT, str1, str2, &result, move)) {
+    connection_node_limit = save_limit;
+    modify_depth_values(3);
+    return result;
+  }
+
   if (verbose > 0)
     verbose--;
+  first_stamp = shadow_clock;
+  first_cached = zone_cached_results();
   result = recursive_disconnect2(str1, str2, move, 0);
+  store_zone_cache(DISCONNECT, str1, str2, result, *move, first_stamp,
+		   first_cached);
   verbose = save_verbose;
 
   connection_node_limit = save_limit;
@@ -1906,6 +2204,14 @@ get_connection_node_counter()
 }
 
 
+/* Add the connection nodes read by a worker process. */
+void
+add_connection_node_counter(int nodes)
+{
+  global_connection_node_counter += nodes;
+}
+
+
 /*********************************************************
  *
  * Alternate connection reading algorithm.
@@ -2013,6 +2319,7 @@ recursive_connect2(int str1, int str2, int *move, int has_passed)
       && tt_get(&ttable, CONNECT, str1, str2, depth - stackp, NULL,
 		&value, NULL, &xpos) == 2) {
     TRACE_CACHED_RESULT2(value, value, xpos);
+    connection_cached_results++;
     if (value != 0)
       if (move)
 	*move = xpos;
@@ -2182,6 +2489,7 @@ recursive_disconnect2(int str1, int str2, int *move, int has_passed)
 		depth - stackp, NULL,
 		&value, NULL, &xpos) == 2) {
     TRACE_CACHED_RESULT2(value, value, xpos);
+    connection_cached_results++;
     if (value != 0)
       if (move)
 	*move = xpos;
@@ -2712,7 +3020,7 @@ init_connection_data(int color, const signed char goal[BOARDMAX],
 		     struct connection_data *conn, int speculative)
 {
   int pos;
-  signed char mark[BOARDMAX];
+  signed char mark[BOARDSIZE];
 
   memset(mark, 0, BOARDMAX);
   VALGRIND_MAKE_WRITABLE(conn, sizeof(conn));
@@ -129,19 +129,26 @@
 
 
 /* Play a collected batch of moves and see if any of them works.  This
- * is a defense version.
+ * is a defense version.  Moves clear of the threat zone of an earlier
+ * failure are skipped, see start_threat_zone().
  */
 #define DEFEND_TRY_MOVES(no_deep_branching, attack_hint)		\
   do {									\
     int k;								\
+    struct threat_zone zone;						\
 									\
+    zone.valid = 0;							\
     for (k = moves.num_tried; k < moves.num; k++) {			\
       int ko_move;							\
       int dpos = moves.pos[k];						\
 									\
-      if (komaster_trymove(dpos, color, moves.message[k], str, &ko_move,\
-			   stackp <= ko_depth && savecode == 0)) {	\
-	int acode = do_attack(str, (attack_hint));			\
+      if ((!zone.valid || in_threat_zone(&zone, dpos, color))	\
+	  && komaster_trymove(dpos, color, moves.message[k], str,	\
+			      &ko_move,					\
+			      stackp <= ko_depth && savecode == 0)) {	\
+	int acode;							\
+	start_threat_zone(&zone, str);					\
+	acode = do_attack(str, (attack_hint));				\
 	popgo();							\
 									\
 	if (!ko_move) {							\
@@ -154,6 +161,8 @@
 	    savecode = KO_B;						\
 	  }								\
 	}								\
+									\
+	finish_threat_zone(&zone, !ko_move && acode == WIN, dpos, color); \
       }									\
 									\
       if ((no_deep_branching) && stackp >= branch_depth)		\
@@ -171,19 +180,25 @@
 #define ATTACK_TRY_MOVES(no_deep_branching, defense_hint)		\
   do {									\
     int k;								\
+    struct threat_zone zone;						\
 									\
+    zone.valid = 0;							\
     for (k = moves.num_tried; k < moves.num; k++) {			\
       int ko_move;							\
       int apos = moves.pos[k];						\
 									\
       if ((board_ko_pos != NO_MOVE || !send_two_return_one(apos, other))\
+	  && (!zone.valid || in_threat_zone(&zone, apos, other))	\
 	  && komaster_trymove(apos, other, moves.message[k],            \
                               str, &ko_move,                            \
 			      stackp <= ko_depth && savecode == 0)) {	\
-	int dcode = do_find_defense(str, (defense_hint));		\
+	int dcode;							\
+	int acode = WIN;						\
+	start_threat_zone(&zone, str);					\
+	dcode = do_find_defense(str, (defense_hint));			\
 									\
 	if (REVERSE_RESULT(dcode) > savecode				\
-	    && do_attack(str, NULL)) {	\
+	    && (acode = do_attack(str, NULL)) != 0) {			\
 	  if (!ko_move) {						\
 	    if (dcode == 0) {						\
 	      popgo();							\
@@ -200,6 +215,8 @@
 	}								\
 									\
 	popgo();							\
+	finish_threat_zone(&zone, !ko_move && (dcode == WIN || acode == 0), \
+			   apos, other);				\
       }									\
 									\
       if ((no_deep_branching) && stackp >= branch_depth)		\
@@ -220,6 +237,15 @@ struct reading_moves
   int num_tried;
 };
 
+/* The refutation of a failed move, see start_threat_zone(). */
+struct threat_zone
+{
+  int valid;
+  int str;
+  unsigned int first_stamp;
+  int cached_results;
+};
+
 /*
  * The functions in reading.c are used to read whether groups 
  * can be captured or not. See the Texinfo documentation 
@@ -302,12 +328,22 @@ static void order_moves(int str, struct reading_moves *moves,
 			int color, const char *funcname, int killer);
 static int simple_ladder_defend(int str, int *move);
 static int in_list(int move, int num_moves, int *moves);
+static void start_threat_zone(struct threat_zone *zone, int str);
+static void finish_threat_zone(struct threat_zone *zone, int failed,
+			       int move, int color);
+static int in_threat_zone(struct threat_zone *zone, int move, int color);
+static void shadow_fast_defense(int move, int lunch);
 
 
 /* Statistics. */
 static int reading_node_counter = 0;
 static int nodes_when_called = 0;
 
+/* Number of results taken from the caches. A search which used a
+ * cached result has an unknown shadow.
+ */
+static int cached_results = 0;
+
  
 
 /* ================================================================ */  
@@ -364,6 +400,7 @@ attack(int str, int *move)
 
   origin = find_origin(str);
   if (search_persistent_reading_cache(ATTACK, origin, &result, &the_move)) {
+    cached_results++;
     if (move)
       *move = the_move;
     return result;
@@ -435,6 +472,7 @@ find_defense(int str, int *move)
   origin = find_origin(str);
   if (search_persistent_reading_cache(FIND_DEFENSE, origin, 
 				      &result, &the_move)) {
+    cached_results++;
     if (move)
       *move = the_move;
     return result;
@@ -1191,6 +1229,7 @@ do_find_defense(int str, int *move)
      */
     TRACE_CACHED_RESULT(retval, xpos);
     SGFTRACE(xpos, retval, "cached");
+    cached_results++;
     if (move)
       *move = xpos;
     return retval;
@@ -1293,6 +1332,7 @@ fast_defense(int str, int liberties, int *libs, int *move)
      * probably because it catches more cases.
      */
     if (accuratelib(libs[k], color, goal_liberties, NULL) >= goal_liberties) {
+      shadow_fast_defense(libs[k], NO_MOVE);
       *move = libs[k];
       return 1;
     }
@@ -1327,6 +1367,7 @@ fast_defense(int str, int liberties, int *libs, int *move)
     num_adjacent_stones = count_adjacent_stones(adjs[j], str, missing);
     if (!liberty_of_string(lib, str)
 	&& num_adjacent_stones >= missing) {
+      shadow_fast_defense(lib, adjs[j]);
       *move = lib;
       return 1;
     }
@@ -1381,6 +1422,7 @@ fast_defense(int str, int liberties, int *libs, int *move)
 	continue;
       }
 
+      shadow_fast_defense(lib, adjs[j]);
       *move = lib;
       return 1;
     }
@@ -1389,6 +1431,35 @@ fast_defense(int str, int liberties, int *libs, int *move)
   return 0;
 }
 
+
+/* fast_defense() finds its move without playing it, so the points it
+ * depends on never get into the reading shadow. Stamp the move with
+ * its neighbors, which decide the liberties it gets, and the stones of
+ * the captured string (lunch), if any. Otherwise a threat zone would
+ * not see that filling a liberty next to the move spoils the defense.
+ *
+ * Only shadow_stamp[] is updated, not shadow[]. The latter gives the
+ * active area of the persistent reading cache, which stays as it was
+ * before the threat zones.
+ */
+static void
+shadow_fast_defense(int move, int lunch)
+{
+  int stones[MAX_BOARD * MAX_BOARD];
+  int num_stones = 0;
+  int k;
+
+  if (lunch != NO_MOVE)
+    num_stones = findstones(lunch, MAX_BOARD * MAX_BOARD, stones);
+  for (k = 0; k < num_stones; k++)
+    shadow_stamp[stones[k]] = ++shadow_clock;
+
+  shadow_stamp[move] = ++shadow_clock;
+  for (k = 0; k < 4; k++)
+    if (ON_BOARD(move + delta[k]))
+      shadow_stamp[move + delta[k]] = ++shadow_clock;
+}
+
 /* If str points to a string with exactly one liberty, defend1 
  * determines whether it can be saved by extending or capturing
  * a boundary chain having one liberty. The function returns WIN if the string
@@ -2831,6 +2902,7 @@ do_attack(int str, int *move)
 		&retval, NULL, &xpos) == 2) {
     TRACE_CACHED_RESULT(retval, xpos);
     SGFTRACE(xpos, retval, "cached");
+    cached_results++;
     if (move)
       *move = xpos;
     return retval;
@@ -5501,6 +5573,24 @@ get_reading_node_counter()
   return reading_node_counter;
 }
 
+
+/* Add nodes read elsewhere, e.g. by a worker process (see parallel.c). */
+void
+add_reading_node_counter(int nodes)
+{
+  reading_node_counter += nodes;
+}
+
+
+/* Number of results taken from the caches so far. A search during
+ * which this changed has an unknown shadow.
+ */
+int
+get_reading_cached_results()
+{
+  return cached_results;
+}
+
 /* ============ Reading shadow =============== */
 
 /* Draw the reading shadow, for debugging purposes */
@@ -5542,10 +5632,506 @@ draw_reading_shadow()
 }
 
 
+/* ============ Threat zones =============== */
+
+/* Threat zones let the move loops skip candidates which provably
+ * fail. Suppose a move fails, i.e. the string is still captured after
+ * a defense move or still defended after an attacking move, and the
+ * reading which refuted it never came near the move itself. Then the
+ * refutation works as well without the move, and it also refutes any
+ * other move which stays clear of the refutation.
+ *
+ * "Near" means inside the threat zone: the points shadowed by the
+ * refutation and the attacked string, their neighbors, and the strings
+ * next to these. A move which captures anything is always considered
+ * to be near. The zone is only set up when the refutation got no
+ * results from the caches, since we cannot know what those looked at.
+ */
+
+/* Start watching the refutation of a move just played against (str). */
+static void
+start_threat_zone(struct threat_zone *zone, int str)
+{
+  if (zone->valid)
+    return;
+  zone->str = str;
+  zone->first_stamp = shadow_clock;
+  zone->cached_results = cached_results;
+}
+
+
+/* The move by (color) at (move) has been taken back. If it failed
+ * and its refutation stayed clear of it, the refutation becomes the
+ * threat zone for the remaining moves.
+ */
+static void
+finish_threat_zone(struct threat_zone *zone, int failed, int move, int color)
+{
+  if (zone->valid
+      || !failed
+      || cached_results != zone->cached_results)
+    return;
+
+  zone->valid = 1;
+  if (in_threat_zone(zone, move, color))
+    zone->valid = 0;
+}
+
+
+/* Is (pos) shadowed by the refutation, or part of the attacked
+ * string? The stamps are compared modulo wraparound of the clock.
+ */
+static int
+in_zone_core(struct threat_zone *zone, int pos)
+{
+  if (shadow_stamp[pos] - zone->first_stamp - 1
+      < shadow_clock - zone->first_stamp)
+    return 1;
+  return board[pos] == board[zone->str] && same_string(pos, zone->str);
+}
+
+
+/* Is a move by (color) at (move) near the refutation of the zone? */
+static int
+in_threat_zone(struct threat_zone *zone, int move, int color)
+{
+  int stones[MAX_BOARD * MAX_BOARD];
+  int k, r;
+
+  if (does_capture_something(move, color)
+      || in_zone_core(zone, move))
+    return 1;
+
+  for (k = 0; k < 4; k++) {
+    int pos = move + delta[k];
+    int num_stones;
+
+    if (!ON_BOARD(pos))
+      continue;
+    if (in_zone_core(zone, pos))
+      return 1;
+    if (!IS_STONE(board[pos]))
+      continue;
+
+    num_stones = findstones(pos, MAX_BOARD * MAX_BOARD, stones);
+    for (r = 0; r < num_stones; r++) {
+      int stone = stones[r];
+      if (in_zone_core(zone, stone)
+	  || (ON_BOARD(SOUTH(stone)) && in_zone_core(zone, SOUTH(stone)))
+	  || (ON_BOARD(WEST(stone)) && in_zone_core(zone, WEST(stone)))
+	  || (ON_BOARD(NORTH(stone)) && in_zone_core(zone, NORTH(stone)))
+	  || (ON_BOARD(EAST(stone)) && in_zone_core(zone, EAST(stone))))
+	return 1;
+    }
+  }
+
+  return 0;
+}
+
+
 /* ================================================================ */
 /*              Code for special purposes.                          */
 /* ================================================================ */
 
+/* ============ Ladder fast path =============== */
+
+/* Most ladders involve no captures and no ko at all. Then
+ * simple_ladder() only needs the liberties of the chased string and
+ * of the strings next to it, and the functions below read such
+ * ladders on a private copy of the points they look at, without
+ * trymove() and the move generation machinery. As soon as a capture
+ * becomes possible, or anything else which needs the full rules, they
+ * give up with LADDER_UNKNOWN and simple_ladder() reads the move the
+ * usual way.
+ *
+ * The result only depends on the points read, which are recorded
+ * together with their contents as the ladder zone. Results are cached
+ * under the attacked string and the first attacking move, and reused
+ * whenever all points of the zone are unchanged, also after unrelated
+ * moves elsewhere on the board. The points of the zone are put into
+ * the reading shadow, also when the result comes from the cache, so
+ * that the persistent caches and the threat and connection zones
+ * depend on them.
+ */
+
+#define LADDER_UNKNOWN     -1
+#define MAX_LADDER_ZONE    128
+#define LADDER_CACHE_SIZE  128
+
+/* Zone points are stored as 4 * pos + color. */
+struct ladder_cache_entry {
+  int str;
+  int apos;
+  int result;
+  int depth;
+  int zone_size;
+  unsigned short zone[MAX_LADDER_ZONE];
+};
+
+static struct ladder_cache_entry _EMBEDDED_BSS ladder_cache[LADDER_CACHE_SIZE];
+
+static signed char _EMBEDDED_HOT ladder_board[BOARDSIZE];
+static unsigned int _EMBEDDED_HOT ladder_seen[BOARDSIZE];
+static unsigned int _EMBEDDED_HOT ladder_mark[BOARDSIZE];
+static unsigned int _EMBEDDED_HOT ladder_checked[BOARDSIZE];
+static int _EMBEDDED_HOT ladder_stones[MAX_BOARD * MAX_BOARD];
+static int _EMBEDDED_HOT ladder_neighbor_stones[MAX_BOARD * MAX_BOARD];
+static unsigned int ladder_seen_id = 0;
+static unsigned int ladder_mark_id = 0;
+static unsigned int ladder_checked_id = 0;
+static unsigned short ladder_zone[MAX_LADDER_ZONE];
+static int ladder_zone_size;
+static int ladder_depth;
+static int ladder_max_depth;
+
+
+/* Step one of the stamps above, clearing the array when it wraps. */
+static unsigned int
+next_ladder_id(unsigned int *id, unsigned int stamps[BOARDSIZE])
+{
+  if (++(*id) == 0) {
+    memset(stamps, 0, BOARDSIZE * sizeof(stamps[0]));
+    *id = 1;
+  }
+  return *id;
+}
+
+
+/* Mark (pos) in the reading shadow, like trymove() does for the
+ * moves it plays.
+ */
+static void
+ladder_shadow(int pos)
+{
+  if (board[pos] != GRAY) {
+    shadow[pos] = 1;
+    shadow_stamp[pos] = ++shadow_clock;
+  }
+}
+
+
+/* The contents of (pos) on the ladder board. The first time a point
+ * is read it is copied from the real board, added to the zone and
+ * shadowed.
+ */
+static int
+ladder_color(int pos)
+{
+  if (ladder_seen[pos] != ladder_seen_id) {
+    ladder_seen[pos] = ladder_seen_id;
+    ladder_board[pos] = board[pos];
+    if (ladder_zone_size < MAX_LADDER_ZONE)
+      ladder_zone[ladder_zone_size] = 4 * pos + board[pos];
+    ladder_zone_size++;
+    ladder_shadow(pos);
+  }
+  return ladder_board[pos];
+}
+
+
+/* Find the stones of the string at (str) on the ladder board and
+ * store them in stones[]. The number of liberties is returned in
+ * (*liberties) and up to maxlib of them in libs[]. Returns the number
+ * of stones.
+ */
+static int
+ladder_string(int str, int stones[], int *liberties, int libs[], int maxlib)
+{
+  int color = ladder_color(str);
+  unsigned int mark = next_ladder_id(&ladder_mark_id, ladder_mark);
+  int num_stones = 1;
+  int r, k;
+
+  stones[0] = str;
+  ladder_mark[str] = mark;
+  *liberties = 0;
+
+  for (r = 0; r < num_stones; r++)
+    for (k = 0; k < 4; k++) {
+      int pos = stones[r] + delta[k];
+      int c;
+      if (ladder_mark[pos] == mark)
+	continue;
+      c = ladder_color(pos);
+      if (c == color) {
+	ladder_mark[pos] = mark;
+	stones[num_stones++] = pos;
+      }
+      else if (c == EMPTY) {
+	ladder_mark[pos] = mark;
+	if (*liberties < maxlib)
+	  libs[*liberties] = pos;
+	(*liberties)++;
+      }
+    }
+
+  return num_stones;
+}
+
+
+/* Number of liberties of the string at (str) on the ladder board. */
+static int
+ladder_countlib(int str)
+{
+  int liberties;
+  ladder_string(str, ladder_neighbor_stones, &liberties, NULL, 0);
+  return liberties;
+}
+
+
+/* Like approxlib(): the number of liberties a stone of (color) at
+ * (pos) would get, not counting captures.
+ */
+static int
+ladder_approxlib(int pos, int color)
+{
+  int liberties;
+
+  ladder_board[pos] = color;
+  liberties = ladder_countlib(pos);
+  ladder_board[pos] = EMPTY;
+
+  return liberties;
+}
+
+
+/* Play (color) at (pos) on the ladder board. Returns 1 if the move
+ * was played, 0 if it is illegal, and LADDER_UNKNOWN if it captures
+ * or would overflow the move stack.
+ */
+static int
+ladder_play(int pos, int color)
+{
+  int other = OTHER_COLOR(color);
+  int k;
+
+  if (ladder_color(pos) != EMPTY)
+    return 0;
+  if (ladder_depth >= MAXSTACK - 2)
+    return LADDER_UNKNOWN;
+
+  ladder_board[pos] = color;
+  for (k = 0; k < 4; k++)
+    if (ladder_color(pos + delta[k]) == other
+	&& ladder_countlib(pos + delta[k]) == 0) {
+      ladder_board[pos] = EMPTY;
+      return LADDER_UNKNOWN;
+    }
+
+  if (ladder_countlib(pos) == 0) {
+    ladder_board[pos] = EMPTY;
+    return 0;
+  }
+
+  ladder_depth++;
+  if (ladder_depth > ladder_max_depth)
+    ladder_max_depth = ladder_depth;
+  return 1;
+}
+
+
+static void
+ladder_undo(int pos)
+{
+  ladder_board[pos] = EMPTY;
+  ladder_depth--;
+}
+
+
+/* Is any opponent string at or next to one of the num_points points
+ * in points[] in atari?
+ */
+static int
+ladder_neighbor_in_atari(int points[], int num_points, int color)
+{
+  int other = OTHER_COLOR(color);
+  unsigned int checked = next_ladder_id(&ladder_checked_id, ladder_checked);
+  int r, k, s;
+
+  for (r = 0; r < num_points; r++)
+    for (k = 0; k < 5; k++) {
+      int pos = (k < 4 ? points[r] + delta[k] : points[r]);
+      int liberties;
+      int num_neighbor_stones;
+
+      if (ladder_checked[pos] == checked || ladder_color(pos) != other)
+	continue;
+      num_neighbor_stones = ladder_string(pos, ladder_neighbor_stones,
+					  &liberties, NULL, 0);
+      if (liberties == 1)
+	return 1;
+      for (s = 0; s < num_neighbor_stones; s++)
+	ladder_checked[ladder_neighbor_stones[s]] = checked;
+    }
+
+  return 0;
+}
+
+
+static int ladder_defend(int str, int last_attack, int last_defense,
+			 int old_size);
+
+/* The ladder board version of simple_ladder(). (str) has two
+ * liberties after the defender extended at (last_defense) from a
+ * string of old_size stones.
+ */
+static int
+ladder_attack(int str, int last_defense, int old_size)
+{
+  int color = ladder_color(str);
+  int other = OTHER_COLOR(color);
+  int libs[2];
+  int liberties;
+  int moves[2];
+  int num_moves = 0;
+  int result = 0;
+  int k;
+
+  reading_node_counter++;
+  ladder_string(str, ladder_stones, &liberties, libs, 2);
+  gg_assert(liberties == 2);
+
+  if (ladder_approxlib(libs[0], color) <= 3)
+    moves[num_moves++] = libs[1];
+  if (ladder_approxlib(libs[1], color) <= 3)
+    moves[num_moves++] = libs[0];
+
+  for (k = 0; k < num_moves; k++) {
+    int played = ladder_play(moves[k], other);
+    int dcode;
+
+    if (played == 0)
+      continue;
+    if (played == LADDER_UNKNOWN) {
+      result = LADDER_UNKNOWN;
+      continue;
+    }
+
+    dcode = ladder_defend(str, moves[k], last_defense, old_size);
+    ladder_undo(moves[k]);
+    if (dcode == 0)
+      return WIN;
+    if (dcode == LADDER_UNKNOWN)
+      result = LADDER_UNKNOWN;
+  }
+
+  return result;
+}
+
+
+/* The ladder board version of simple_ladder_defend(). (str) has one
+ * liberty after the attacker played (last_attack), answering the
+ * defender's extension at (last_defense) from a string of old_size
+ * stones. At the start of the ladder (last_defense) is NO_MOVE.
+ */
+static int
+ladder_defend(int str, int last_attack, int last_defense, int old_size)
+{
+  int color = ladder_color(str);
+  int lib;
+  int liberties;
+  int num_stones;
+  int played;
+  int result;
+
+  reading_node_counter++;
+  num_stones = ladder_string(str, ladder_stones, &liberties, &lib, 1);
+  gg_assert(liberties == 1);
+
+  /* Capturing a neighbor is left to the full reader. When the previous
+   * defense node found no neighbor in atari and the extension did not
+   * join another string, only strings next to the two moves played
+   * since then can have lost liberties or become neighbors. Such a
+   * string in atari is not always next to (str), but then giving up is
+   * merely conservative.
+   */
+  if (last_defense == NO_MOVE || num_stones != old_size + 1) {
+    if (ladder_neighbor_in_atari(ladder_stones, num_stones, color))
+      return LADDER_UNKNOWN;
+  }
+  else {
+    int points[2];
+    points[0] = last_attack;
+    points[1] = last_defense;
+    if (ladder_neighbor_in_atari(points, 2, color))
+      return LADDER_UNKNOWN;
+  }
+
+  played = ladder_play(lib, color);
+  if (played != 1)
+    return played;
+
+  liberties = ladder_countlib(str);
+  if (liberties > 2)
+    result = WIN;
+  else if (liberties < 2)
+    result = 0;
+  else {
+    result = ladder_attack(str, lib, num_stones);
+    if (result != LADDER_UNKNOWN)
+      result = REVERSE_RESULT(result);
+  }
+
+  ladder_undo(lib);
+  return result;
+}
+
+
+/* Read the ladder after the attacker plays (apos) against (str), which
+ * has two liberties. Returns WIN if the ladder works, 0 if not, and
+ * LADDER_UNKNOWN if the fast path cannot tell.
+ */
+static int
+fast_ladder(int str, int apos)
+{
+  struct ladder_cache_entry *entry;
+  int result;
+  int k;
+
+  if (get_komaster() != EMPTY || board_ko_pos != NO_MOVE)
+    return LADDER_UNKNOWN;
+
+  entry = &ladder_cache[(str * 31 + apos) % LADDER_CACHE_SIZE];
+  if (entry->str == str
+      && entry->apos == apos
+      && stackp + entry->depth < MAXSTACK - 2) {
+    for (k = 0; k < entry->zone_size; k++)
+      if (board[entry->zone[k] / 4] != entry->zone[k] % 4)
+	break;
+    if (k == entry->zone_size) {
+      /* The result depends on the zone as if it had been read again. */
+      for (k = 0; k < entry->zone_size; k++)
+	ladder_shadow(entry->zone[k] / 4);
+      return entry->result;
+    }
+  }
+
+  next_ladder_id(&ladder_seen_id, ladder_seen);
+  ladder_zone_size = 0;
+  ladder_depth = stackp;
+  ladder_max_depth = stackp;
+
+  result = ladder_play(apos, OTHER_COLOR(board[str]));
+  if (result == 1) {
+    result = ladder_defend(str, apos, NO_MOVE, 0);
+    ladder_undo(apos);
+    if (result != LADDER_UNKNOWN)
+      result = REVERSE_RESULT(result);
+  }
+
+  if (ladder_zone_size <= MAX_LADDER_ZONE) {
+    entry->str = str;
+    entry->apos = apos;
+    entry->result = result;
+    entry->depth = ladder_max_depth - stackp;
+    entry->zone_size = ladder_zone_size;
+    memcpy(entry->zone, ladder_zone, ladder_zone_size * sizeof(ladder_zone[0]));
+  }
+
+  return result;
+}
+
+
 /* simple_ladder(str, &move) tries to capture a string (str)
  * with exactly two liberties under simplified assumptions, which are
  * adequate in a ladder. The rules are as follows:
@@ -5641,6 +6227,20 @@ simple_ladder(int str, int *move)
     int ko_move;
 
     apos = moves.pos[k];
+
+    /* Try the fast path first, unless we need the full trace. */
+    if (!sgf_dumptree) {
+      int acode = fast_ladder(str, apos);
+      if (acode == WIN) {
+	SGFTRACE(apos, WIN, "attack effective");
+	if (move)
+	  *move = apos;
+	return WIN;
+      }
+      if (acode == 0)
+	continue;
+    }
+
     if (komaster_trymove(apos, other, moves.message[k], str,
 			 &ko_move, savecode == 0)) {
       if (!ko_move) {
@@ -28,10 +28,12 @@
 #include "gnugo.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "liberty.h"
 #include "sgftree.h"
+#include "gg_utils.h"
 
 
 /* 
@@ -666,6 +668,405 @@ decide_oracle(Gameinfo *gameinfo, char *infilename, char *untilstring)
 #endif
 
 
+
+/* ================================================================ */
+/*                 Batch evaluation of many positions               */
+/* ================================================================ */
+
+/* decide_batch() reads queries from a stream, one per line:
+ *
+ *   <sgf file> <query> <target>[/<target>] [<until>]
+ *
+ * where query is "string", "connection" or "owl", and until is
+ * interpreted as the -L option. Empty lines and lines starting with
+ * '#' are ignored. For each query one line of JSON is written, in the
+ * order of the input.
+ *
+ * Consecutive queries on the same file and move are answered from
+ * the same loaded position, sharing the reading caches. These groups
+ * of queries are run in up to workers processes (see parallel.c), so
+ * the pattern databases and caches are set up only once per batch.
+ */
+
+#define BATCH_LINE_LENGTH 1024
+#define BATCH_GROUP_SIZE  24
+#define BATCH_CHUNK_SIZE  512
+
+enum batch_query_type {
+  BATCH_STRING,
+  BATCH_CONNECTION,
+  BATCH_OWL
+};
+
+static const char *batch_query_names[] = {"string", "connection", "owl"};
+
+enum batch_error {
+  BATCH_OK,
+  BATCH_SYNTAX_ERROR,
+  BATCH_UNREADABLE,
+  BATCH_UNLOADABLE,
+  BATCH_BAD_TARGET,
+  BATCH_EMPTY_TARGET,
+  BATCH_COLOR_MISMATCH
+};
+
+static const char *batch_error_names[] = {
+  NULL,
+  "syntax error",
+  "cannot read sgf file",
+  "cannot load position",
+  "invalid coordinate",
+  "empty vertex",
+  "strings of different colors"
+};
+
+struct batch_query {
+  char *buffer;    /* The fields below point into this copy of the line. */
+  char *file;
+  char *until;
+  char *target;
+  char *target2;
+  enum batch_query_type type;
+  enum batch_error error;
+};
+
+/* Result of a query, as passed back from a worker process. For a
+ * connection query the two results are for string_connect() and
+ * disconnect(), otherwise for attack and defense.
+ */
+struct batch_result {
+  enum batch_error error;
+  int code[2];
+  char move[2][5];  /* Empty if there is no move. */
+  int certain;
+  int nodes;
+};
+
+struct batch_group {
+  int first;
+  int num_queries;
+};
+
+static struct batch_query *batch_queries;
+static struct batch_group *batch_groups;
+
+
+/* Parse a query line into a freshly allocated buffer, to which the
+ * string fields of query point. Returns 0 for lines without a query.
+ */
+static int
+parse_batch_query(const char *line, struct batch_query *query)
+{
+  char *buffer = pool_malloc(POOL_ENGINE, strlen(line) + 1);
+  char *type;
+  char *targets;
+
+  gg_assert(buffer != NULL);
+  strcpy(buffer, line);
+
+  memset(query, 0, sizeof(*query));
+  query->buffer = buffer;
+  query->file = strtok(buffer, " \t\r\n");
+  if (!query->file || query->file[0] == '#') {
+    pool_free(buffer);
+    return 0;
+  }
+
+  type = strtok(NULL, " \t\r\n");
+  targets = strtok(NULL, " \t\r\n");
+  query->until = strtok(NULL, " \t\r\n");
+
+  if (!type || !targets || strtok(NULL, " \t\r\n")) {
+    query->error = BATCH_SYNTAX_ERROR;
+    return 1;
+  }
+
+  if (strcmp(type, "string") == 0)
+    query->type = BATCH_STRING;
+  else if (strcmp(type, "connection") == 0)
+    query->type = BATCH_CONNECTION;
+  else if (strcmp(type, "owl") == 0)
+    query->type = BATCH_OWL;
+  else
+    query->error = BATCH_SYNTAX_ERROR;
+
+  query->target = strtok(targets, "/");
+  query->target2 = strtok(NULL, "/");
+  if (!query->target
+      || (query->type == BATCH_CONNECTION) != (query->target2 != NULL))
+    query->error = BATCH_SYNTAX_ERROR;
+
+  return 1;
+}
+
+
+/* Do two queries refer to the same position? */
+static int
+same_batch_position(struct batch_query *a, struct batch_query *b)
+{
+  if (strcmp(a->file, b->file) != 0)
+    return 0;
+  if (a->until == NULL || b->until == NULL)
+    return a->until == b->until;
+  return strcmp(a->until, b->until) == 0;
+}
+
+
+/* Answer a single query on the current position. */
+static void
+run_batch_query(struct batch_query *query, struct batch_result *result,
+		int *dragons_examined)
+{
+  int apos = string_to_location(board_size, query->target);
+  int bpos = NO_MOVE;
+  int move[2] = {NO_MOVE, NO_MOVE};
+  int attack_certain;
+  int defense_certain;
+  int kworm;
+  int k;
+
+  if (query->type == BATCH_CONNECTION)
+    bpos = string_to_location(board_size, query->target2);
+
+  if (apos == NO_MOVE || (query->type == BATCH_CONNECTION && bpos == NO_MOVE)) {
+    result->error = BATCH_BAD_TARGET;
+    return;
+  }
+  if (board[apos] == EMPTY
+      || (query->type == BATCH_CONNECTION && board[bpos] == EMPTY)) {
+    result->error = BATCH_EMPTY_TARGET;
+    return;
+  }
+
+  switch (query->type) {
+  case BATCH_STRING:
+    reset_reading_node_counter();
+    result->code[0] = attack(apos, &move[0]);
+    result->code[1] = find_defense(apos, &move[1]);
+    result->nodes = get_reading_node_counter();
+    break;
+
+  case BATCH_CONNECTION:
+    if (board[apos] != board[bpos]) {
+      result->error = BATCH_COLOR_MISMATCH;
+      return;
+    }
+    reset_connection_node_counter();
+    result->code[0] = string_connect(apos, bpos, &move[0]);
+    result->code[1] = disconnect(apos, bpos, &move[1]);
+    result->nodes = get_connection_node_counter();
+    break;
+
+  case BATCH_OWL:
+    if (!*dragons_examined) {
+      silent_examine_position(EXAMINE_DRAGONS_WITHOUT_OWL);
+      *dragons_examined = 1;
+    }
+    reset_owl_node_counter();
+    result->code[0] = owl_attack(apos, &move[0], &attack_certain,
+				 &kworm);
+    result->code[1] = owl_defend(apos, &move[1], &defense_certain,
+				 &kworm);
+    result->certain = attack_certain && defense_certain;
+    result->nodes = get_owl_node_counter();
+    break;
+  }
+
+  /* The moves are converted here, where the board size is known. */
+  for (k = 0; k < 2; k++)
+    if (result->code[k] != 0 && move[k] != NO_MOVE)
+      location_to_buffer(move[k], result->move[k]);
+}
+
+
+/* Job for run_parallel_jobs(): load the position of group j and
+ * answer its queries.
+ */
+static void
+run_batch_group(int j, void *results)
+{
+  struct batch_group *group = &batch_groups[j];
+  struct batch_query *first = &batch_queries[group->first];
+  struct batch_result *result = results;
+  enum batch_error load_error = BATCH_OK;
+  int dragons_examined = 0;
+  Gameinfo gameinfo;
+  SGFTree tree;
+  int k;
+
+  memset(result, 0, BATCH_GROUP_SIZE * sizeof(*result));
+
+  sgftree_clear(&tree);
+  gameinfo_clear(&gameinfo);
+  if (!sgftree_readfile(&tree, first->file))
+    load_error = BATCH_UNREADABLE;
+  else {
+    if (gameinfo_play_sgftree(&gameinfo, &tree, first->until) == EMPTY)
+      load_error = BATCH_UNLOADABLE;
+    sgfFreeNode(tree.root);
+  }
+
+  reset_engine();
+
+  for (k = 0; k < group->num_queries; k++) {
+    struct batch_query *query = &batch_queries[group->first + k];
+    if (query->error != BATCH_OK)
+      result[k].error = query->error;
+    else if (load_error != BATCH_OK)
+      result[k].error = load_error;
+    else
+      run_batch_query(query, &result[k], &dragons_examined);
+  }
+}
+
+
+/* Write s as a JSON string. */
+static void
+print_json_string(FILE *output, const char *s)
+{
+  fputc('"', output);
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\')
+      fprintf(output, "\\%c", *s);
+    else if ((unsigned char) *s < 0x20)
+      fprintf(output, "\\u%04x", (unsigned char) *s);
+    else
+      fputc(*s, output);
+  }
+  fputc('"', output);
+}
+
+
+static void
+print_json_move(FILE *output, const char *name, const char *move)
+{
+  fprintf(output, ", \"%s_move\": ", name);
+  if (move[0] == '\0')
+    fprintf(output, "null");
+  else
+    print_json_string(output, move);
+}
+
+
+static void
+print_batch_result(FILE *output, struct batch_query *query,
+		   struct batch_result *result)
+{
+  const char *names[2];
+
+  if (query->type == BATCH_CONNECTION) {
+    names[0] = "connect";
+    names[1] = "disconnect";
+  }
+  else {
+    names[0] = "attack";
+    names[1] = "defense";
+  }
+
+  fprintf(output, "{\"file\": ");
+  print_json_string(output, query->file);
+  if (query->error == BATCH_SYNTAX_ERROR) {
+    fprintf(output, ", \"error\": \"%s\"}\n",
+	    batch_error_names[query->error]);
+    return;
+  }
+  if (query->until) {
+    fprintf(output, ", \"until\": ");
+    print_json_string(output, query->until);
+  }
+  fprintf(output, ", \"query\": \"%s\", \"target\": ",
+	  batch_query_names[query->type]);
+  print_json_string(output, query->target);
+  if (query->target2) {
+    fprintf(output, ", \"target2\": ");
+    print_json_string(output, query->target2);
+  }
+
+  if (result->error != BATCH_OK)
+    fprintf(output, ", \"error\": \"%s\"}\n", batch_error_names[result->error]);
+  else {
+    int k;
+    for (k = 0; k < 2; k++) {
+      fprintf(output, ", \"%s\": \"%s\"", names[k],
+	      result_to_string(result->code[k]));
+      print_json_move(output, names[k], result->move[k]);
+    }
+    if (query->type == BATCH_OWL)
+      fprintf(output, ", \"certain\": %s",
+	      result->certain ? "true" : "false");
+    fprintf(output, ", \"nodes\": %d}\n", result->nodes);
+  }
+}
+
+
+/* Answer the queries read so far and free them. */
+static void
+run_batch_chunk(FILE *output, int workers, int num_queries)
+{
+  struct batch_result *results;
+  int num_groups = 0;
+  int k;
+
+  for (k = 0; k < num_queries; k++) {
+    if (num_groups == 0
+	|| batch_groups[num_groups - 1].num_queries == BATCH_GROUP_SIZE
+	|| !same_batch_position(&batch_queries[k],
+				&batch_queries[batch_groups[num_groups - 1].first])) {
+      batch_groups[num_groups].first = k;
+      batch_groups[num_groups].num_queries = 0;
+      num_groups++;
+    }
+    batch_groups[num_groups - 1].num_queries++;
+  }
+
+  results = pool_malloc(POOL_ENGINE,
+			num_groups * BATCH_GROUP_SIZE * sizeof(*results));
+  gg_assert(results != NULL);
+  run_parallel_jobs(num_groups, workers, run_batch_group, results,
+		    BATCH_GROUP_SIZE * sizeof(*results));
+
+  for (k = 0; k < num_groups; k++) {
+    int i;
+    for (i = 0; i < batch_groups[k].num_queries; i++)
+      print_batch_result(output, &batch_queries[batch_groups[k].first + i],
+			 &results[k * BATCH_GROUP_SIZE + i]);
+  }
+  fflush(output);
+
+  for (k = 0; k < num_queries; k++)
+    pool_free(batch_queries[k].buffer);
+  pool_free(results);
+}
+
+
+void
+decide_batch(FILE *input, FILE *output, int workers)
+{
+  char line[BATCH_LINE_LENGTH];
+  int num_queries = 0;
+
+  batch_queries = pool_malloc(POOL_ENGINE,
+			      BATCH_CHUNK_SIZE * sizeof(*batch_queries));
+  batch_groups = pool_malloc(POOL_ENGINE,
+			     BATCH_CHUNK_SIZE * sizeof(*batch_groups));
+  gg_assert(batch_queries != NULL && batch_groups != NULL);
+
+  while (fgets(line, sizeof(line), input)) {
+    if (parse_batch_query(line, &batch_queries[num_queries]))
+      num_queries++;
+    if (num_queries == BATCH_CHUNK_SIZE) {
+      run_batch_chunk(output, workers, num_queries);
+      num_queries = 0;
+    }
+  }
+  if (num_queries > 0)
+    run_batch_chunk(output, workers, num_queries);
+
+  pool_free(batch_queries);
+  pool_free(batch_groups);
+}
+
+
 /*
  * Local Variables:
  * tab-width: 8
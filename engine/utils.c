@@ -28,6 +28,7 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <math.h>
+#include <time.h>
 
 #include "liberty.h"
 #include "sgftree.h"
@@ -1940,6 +1941,214 @@ time_report(int n, const char *occupation, int move, double mintime)
   return dt;
 }
 
+
+/* Per-phase profile of move generation. do_genmove() brackets its
+ * work with genmove_trace_start() and genmove_trace_finish(), and
+ * genmove_trace_phase() charges the time and nodes spent since the
+ * previous switch to the phase being left. Unlike the timers above
+ * this is always on, at the cost of reading the clocks at each switch.
+ *
+ * The CPU time is that of the engine process. Reading done in worker
+ * processes (see parallel.c) only shows up in the wall time, and its
+ * nodes are not counted.
+ */
+void (*genmove_trace_hook)(const struct genmove_trace *trace) = NULL;
+
+static const char *genmove_phase_names[NUM_GENMOVE_PHASES] = {
+  "setup",
+  "worms",
+  "influence",
+  "dragons",
+  "owl",
+  "move reasons",
+  "shapes",
+  "review",
+  "value moves",
+  "blunder check",
+  "monte carlo",
+  "aftermath"
+};
+
+static struct genmove_trace current_trace;
+static struct genmove_trace last_trace;
+static int have_last_trace = 0;
+static int trace_active = 0;
+static int trace_enabled = 1;
+static int current_phase = GENMOVE_SETUP;
+
+/* Clocks and node counters at the last phase switch. */
+static double phase_cpu_start;
+static double phase_wall_start;
+static int phase_reading_start;
+static int phase_owl_start;
+static int phase_connection_start;
+
+
+/* CPU time with a finer resolution than gg_cputime() where possible. */
+static double
+trace_cputime(void)
+{
+#if HAVE_CLOCK_GETTIME && defined(CLOCK_PROCESS_CPUTIME_ID)
+  struct timespec t;
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t) == 0)
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+#endif
+#ifdef ESP_PLATFORM
+  /* There are no process times, but the engine runs in a single task. */
+  return gg_gettimeofday();
+#else
+  return gg_cputime();
+#endif
+}
+
+
+/* Charge what was spent since the last switch to the current phase. */
+static void
+charge_phase(void)
+{
+  struct genmove_phase_data *p = &current_trace.phase[current_phase];
+  double cpu = trace_cputime();
+  double wall = gg_gettimeofday();
+  int reading_nodes = get_reading_node_counter();
+  int owl_nodes = get_owl_node_counter();
+  int connection_nodes = get_connection_node_counter();
+
+  p->cpu_time += cpu - phase_cpu_start;
+  p->wall_time += wall - phase_wall_start;
+  p->reading_nodes += reading_nodes - phase_reading_start;
+  p->owl_nodes += owl_nodes - phase_owl_start;
+  p->connection_nodes += connection_nodes - phase_connection_start;
+
+  phase_cpu_start = cpu;
+  phase_wall_start = wall;
+  phase_reading_start = reading_nodes;
+  phase_owl_start = owl_nodes;
+  phase_connection_start = connection_nodes;
+}
+
+
+/* Start the trace of a move generation for color. A trace left
+ * unfinished, because pondering was interrupted, is dropped.
+ */
+void
+genmove_trace_start(int color)
+{
+  memset(&current_trace, 0, sizeof(current_trace));
+  current_trace.color = color;
+  current_trace.movenum = movenum;
+  current_trace.level = get_level();
+  current_phase = GENMOVE_SETUP;
+  trace_active = 1;
+
+  phase_cpu_start = trace_cputime();
+  phase_wall_start = gg_gettimeofday();
+  phase_reading_start = get_reading_node_counter();
+  phase_owl_start = get_owl_node_counter();
+  phase_connection_start = get_connection_node_counter();
+}
+
+
+/* Switch to another phase. Returns the phase left, so that code
+ * which may be called in different phases can switch back.
+ */
+int
+genmove_trace_phase(int phase)
+{
+  int previous = current_phase;
+
+  gg_assert(phase >= 0 && phase < NUM_GENMOVE_PHASES);
+  if (!trace_active)
+    return previous;
+
+  charge_phase();
+  current_phase = phase;
+  return previous;
+}
+
+
+/* Finish the trace with the generated move. It becomes the one
+ * returned by get_genmove_trace() and is passed to genmove_trace_hook,
+ * unless traces are disabled.
+ */
+void
+genmove_trace_finish(int move, float value, int pondered)
+{
+  int k;
+
+  if (!trace_active)
+    return;
+
+  charge_phase();
+  trace_active = 0;
+
+  current_trace.move = move;
+  current_trace.value = value;
+  current_trace.pondered = pondered;
+  for (k = 0; k < NUM_GENMOVE_PHASES; k++) {
+    current_trace.cpu_time += current_trace.phase[k].cpu_time;
+    current_trace.wall_time += current_trace.phase[k].wall_time;
+  }
+
+  if (!trace_enabled)
+    return;
+
+  last_trace = current_trace;
+  have_last_trace = 1;
+  clock_learn_move_cost(&last_trace);
+  if (genmove_trace_hook)
+    genmove_trace_hook(&last_trace);
+}
+
+
+/* Traces are disabled while pondering, the moves generated then are
+ * not played.
+ */
+void
+genmove_trace_enable(int enable)
+{
+  trace_enabled = enable;
+}
+
+
+/* The trace of the last move generation, or NULL if there was none. */
+const struct genmove_trace *
+get_genmove_trace(void)
+{
+  if (!have_last_trace)
+    return NULL;
+  return &last_trace;
+}
+
+
+const char *
+genmove_phase_name(int phase)
+{
+  gg_assert(phase >= 0 && phase < NUM_GENMOVE_PHASES);
+  return genmove_phase_names[phase];
+}
+
+
+/* Print the trace with one line per phase. */
+void
+print_genmove_trace(FILE *outfile, const struct genmove_trace *trace)
+{
+  int k;
+
+  gfprintf(outfile, "%C %1m at move %d, level %d, value %f%s\n",
+	   trace->color, trace->move, trace->movenum + 1, trace->level,
+	   trace->value, trace->pondered ? ", pondered" : "");
+  fprintf(outfile, "%-14s %9s %9s %9s %9s %9s\n",
+	  "phase", "cpu", "wall", "reading", "owl", "connection");
+  for (k = 0; k < NUM_GENMOVE_PHASES; k++) {
+    const struct genmove_phase_data *p = &trace->phase[k];
+    fprintf(outfile, "%-14s %9.4f %9.4f %9d %9d %9d\n",
+	    genmove_phase_names[k], p->cpu_time, p->wall_time,
+	    p->reading_nodes, p->owl_nodes, p->connection_nodes);
+  }
+  fprintf(outfile, "%-14s %9.4f %9.4f\n", "total",
+	  trace->cpu_time, trace->wall_time);
+}
+
 void
 clearstats()
 {
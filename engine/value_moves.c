@@ -286,6 +286,13 @@ find_more_attack_and_defense_moves(int color)
 }
 
 
+/* Set while find_more_owl_attack_and_defense_moves() only collects
+ * the owl questions it is going to ask, to read them ahead in worker
+ * processes.
+ */
+static int reading_owl_ahead = 0;
+
+
 /* Do the real job of find_more_owl_attack_and_defense_moves() with given
  * move reason at given position and for given target (`what').  This
  * function is used from induce_secondary_move_reasons() for upgrading
@@ -359,14 +366,18 @@ do_find_more_owl_attack_and_defense_moves(int color, int pos,
 	 || (move_reason_type == VITAL_EYE_MOVE
 	     && board[dd] == OTHER_COLOR(color)))
 	&& !owl_attack_move_reason_known(pos, dd)) {
-      int kworm = NO_MOVE;
-      int acode = owl_does_attack(pos, dd, &kworm);
-
-      if (acode >= DRAGON2(dd).owl_attack_code) {
-	add_owl_attack_move(pos, dd, kworm, acode);
-	if (save_verbose)
-	  gprintf("Move at %1m upgraded to owl attack on %1m (%s).\n",
-		  pos, dd, result_to_string(acode));
+      if (reading_owl_ahead)
+	add_owl_query(OWL_DOES_ATTACK, pos, dd, NO_MOVE);
+      else {
+	int kworm = NO_MOVE;
+	int acode = owl_does_attack(pos, dd, &kworm);
+
+	if (acode >= DRAGON2(dd).owl_attack_code) {
+	  add_owl_attack_move(pos, dd, kworm, acode);
+	  if (save_verbose)
+	    gprintf("Move at %1m upgraded to owl attack on %1m (%s).\n",
+		    pos, dd, result_to_string(acode));
+	}
       }
     }
 
@@ -378,18 +389,22 @@ do_find_more_owl_attack_and_defense_moves(int color, int pos,
 	 || (move_reason_type == VITAL_EYE_MOVE
 	     && board[dd] == color))
 	&& !owl_defense_move_reason_known(pos, dd)) {
-      int kworm = NO_MOVE;
-      /* FIXME: Better use owl_connection_defend() for CONNECT_MOVE ? */
-      int dcode = owl_does_defend(pos, dd, &kworm);
-
-      if (dcode >= DRAGON2(dd).owl_defense_code) {
-	if (dcode == LOSS)
-	  add_loss_move(pos, dd, kworm);
-	else
-	  add_owl_defense_move(pos, dd, dcode);
-	if (save_verbose)
-	  gprintf("Move at %1m upgraded to owl defense for %1m (%s).\n",
-		  pos, dd, result_to_string(dcode));
+      if (reading_owl_ahead)
+	add_owl_query(OWL_DOES_DEFEND, pos, dd, NO_MOVE);
+      else {
+	int kworm = NO_MOVE;
+	/* FIXME: Better use owl_connection_defend() for CONNECT_MOVE ? */
+	int dcode = owl_does_defend(pos, dd, &kworm);
+
+	if (dcode >= DRAGON2(dd).owl_defense_code) {
+	  if (dcode == LOSS)
+	    add_loss_move(pos, dd, kworm);
+	  else
+	    add_owl_defense_move(pos, dd, dcode);
+	  if (save_verbose)
+	    gprintf("Move at %1m upgraded to owl defense for %1m (%s).\n",
+		    pos, dd, result_to_string(dcode));
+	}
       }
     }
   }
@@ -555,29 +570,19 @@ find_large_scale_owl_attack_moves(int color)
   }
 }
 
-/* Test certain moves to see whether they (too) can owl-attack or
- * defend an owl critical dragon. Tested moves are
- * 1. Strategical attacks or defenses for the dragon.
- * 2. Vital eye points for the dragon.
- * 3. Tactical attacks or defenses for a part of the dragon.
- * 4. Moves connecting the dragon to something else.
+/* Upgrade the strategical attacks and defenses and the vital eye
+ * moves of owl critical dragons to owl attacks and defenses.
  */
 static void
-find_more_owl_attack_and_defense_moves(int color)
+upgrade_to_owl_moves(int color)
 {
-  int pos, pos2;
+  int pos;
   int k;
-  int dd = NO_MOVE;
-  int worth_trying;
-  int save_verbose;
   struct eye_data *our_eyes;
   struct eye_data *your_eyes;
   struct vital_eye_points *our_vital_points;
   struct vital_eye_points *your_vital_points;
 
-  if (verbose)
-    gprintf("\nTrying to upgrade strategical attack and defense moves.\n");
-
   for (pos = BOARDMIN; pos < BOARDMAX; pos++) {
     if (!ON_BOARD(pos))
       continue;
@@ -636,14 +641,24 @@ find_more_owl_attack_and_defense_moves(int color)
       }
     }
   }
+}
+
+/* If two critical dragons are adjacent, test whether a move to owl
+ * attack or defend one also is effective on the other.
+ */
+static void
+try_owl_moves_on_neighbors(int color)
+{
+  int pos, pos2;
+  int k;
+  int dd = NO_MOVE;
+  int worth_trying;
+  int save_verbose;
 
   save_verbose = verbose;
   if (verbose > 0)
     verbose--;
 
-  /* If two critical dragons are adjacent, test whether a move to owl
-   * attack or defend one also is effective on the other.
-   */
   for (pos = BOARDMIN; pos < BOARDMAX; pos++) {
     if (IS_STONE(board[pos])
 	&& dragon[pos].origin == pos
@@ -678,7 +693,12 @@ find_more_owl_attack_and_defense_moves(int color)
 	  if (board[pos] == color
 	      && !owl_defense_move_reason_known(pos2, pos)) {
 	    int kworm = NO_MOVE;
-	    int dcode = owl_does_defend(pos2, pos, &kworm);
+	    int dcode;
+	    if (reading_owl_ahead) {
+	      add_owl_query(OWL_DOES_DEFEND, pos2, pos, NO_MOVE);
+	      continue;
+	    }
+	    dcode = owl_does_defend(pos2, pos, &kworm);
 	    if (dcode >= DRAGON2(pos).owl_defense_code) {
 	      if (dcode == LOSS)
 		add_loss_move(pos2, pos, kworm);
@@ -693,7 +713,12 @@ find_more_owl_attack_and_defense_moves(int color)
 	  else if (board[pos] != color
 		   && !owl_attack_move_reason_known(pos2, pos)) {
 	    int kworm = NO_MOVE;
-	    int acode = owl_does_attack(pos2, pos, &kworm);
+	    int acode;
+	    if (reading_owl_ahead) {
+	      add_owl_query(OWL_DOES_ATTACK, pos2, pos, NO_MOVE);
+	      continue;
+	    }
+	    acode = owl_does_attack(pos2, pos, &kworm);
 	    if (acode >= DRAGON2(pos).owl_attack_code) {
 	      add_owl_attack_move(pos2, pos, kworm, acode);
 	      if (save_verbose)
@@ -709,6 +734,41 @@ find_more_owl_attack_and_defense_moves(int color)
   verbose = save_verbose;
 }
 
+/* Test certain moves to see whether they (too) can owl-attack or
+ * defend an owl critical dragon. Tested moves are
+ * 1. Strategical attacks or defenses for the dragon.
+ * 2. Vital eye points for the dragon.
+ * 3. Tactical attacks or defenses for a part of the dragon.
+ * 4. Moves connecting the dragon to something else.
+ *
+ * With --owl-workers the owl questions of each step are first read
+ * ahead in worker processes (see read_owl_queries()).
+ */
+static void
+find_more_owl_attack_and_defense_moves(int color)
+{
+  int read_ahead = use_worker_processes(owl_workers);
+
+  if (verbose)
+    gprintf("\nTrying to upgrade strategical attack and defense moves.\n");
+
+  if (read_ahead) {
+    reading_owl_ahead = 1;
+    upgrade_to_owl_moves(color);
+    reading_owl_ahead = 0;
+    read_owl_queries();
+  }
+  upgrade_to_owl_moves(color);
+
+  if (read_ahead) {
+    reading_owl_ahead = 1;
+    try_owl_moves_on_neighbors(color);
+    reading_owl_ahead = 0;
+    read_owl_queries();
+  }
+  try_owl_moves_on_neighbors(color);
+}
+
 /* Tests whether the potential semeai move at (pos) with details given via
  * (*reason) works, and adds a semeai move if applicable.
  */
@@ -2489,8 +2549,9 @@ estimate_territorial_value(int pos, int color, float our_score,
 					   OPPOSITE_INFLUENCE(color),
 					   safety_hash)) {
 
-      compute_influence(OTHER_COLOR(color), safe_stones, strength, 
-	  		&move_influence, pos, "after move");
+      compute_move_influence(OPPOSITE_INFLUENCE(color), OTHER_COLOR(color),
+			     safe_stones, strength, &move_influence,
+			     pos, "after move");
       increase_depth_values();
       break_territories(OTHER_COLOR(color), &move_influence, 0, pos);
       decrease_depth_values();
@@ -3732,7 +3793,9 @@ find_best_move(int *the_move, float *value, int color,
      */
     else if (best_value > 0.0) {
       if (!blunder_tested[best_move]) {
+	int phase = genmove_trace_phase(GENMOVE_BLUNDER_CHECK);
 	float blunder_size = value_moves_get_blunder_size(best_move, color);
+	genmove_trace_phase(phase);
 	if (blunder_size > 0.0) {
 	  TRACE("Move at %1m is a blunder, subtracting %f.\n", best_move,
 		blunder_size);
@@ -3784,6 +3847,7 @@ review_move_reasons(int *the_move, float *value, int color,
 		    int use_thrashing_dragon_heuristics)
 {
   int save_verbose;
+  int phase;
 
   current_color = color;
   
@@ -3819,9 +3883,11 @@ review_move_reasons(int *the_move, float *value, int color,
     list_move_reasons(stderr, NO_MOVE);
 
   /* Evaluate all moves with move reasons. */
+  phase = genmove_trace_phase(GENMOVE_VALUE_MOVES);
   value_moves(color, pure_threat_value, our_score,
       	      use_thrashing_dragon_heuristics);
   time_report(2, "  value_moves", NO_MOVE, 1.0);
+  genmove_trace_phase(phase);
 
   /* Perform point redistribution */
   redistribute_points();
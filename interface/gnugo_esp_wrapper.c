@@ -24,10 +24,16 @@ static int sgf_initialized = 0;
 static int passes = 0;
 static int game_is_over = 0;
 static bool undo_allowed = false;
+// Set once esp_gnugo_ponder() has worked on the game. The dragon data
+// may then belong to another position.
+static bool pondered = false;
 
-// memstream allowing us to use file operations to write to a RAM buffer
+// memstream allowing us to use file operations to write to a RAM buffer.
+// The game record is appended to it one node at a time by sgf_writer.
 static char *sgf_outptr = NULL;
 static size_t sgf_outbuf_len = 0;
+static FILE *sgf_outfd = NULL;
+static SGFWriter sgf_writer;
 
 static void
 init_sgf(Gameinfo *ginfo)
@@ -72,6 +78,8 @@ static void esp_gnugo_update_board_state()
         if (passes == 2)
         {
             game_state.last_event = ESP_GNUGO_EVENT_WIN;
+            if (pondered)
+                silent_examine_position(EXAMINE_DRAGONS);
             for (int pos = BOARDMIN; pos < BOARDMAX; pos++)
             {
                 if (!IS_STONE(board[pos]))
@@ -125,14 +133,17 @@ static void esp_gnugo_update_board_state()
     game_state.black_captured = black_captured;
     game_state.white_captured = white_captured;
 
-    // Buffer up existing SGF to file.
-    if (sgf_outptr)
-        free(sgf_outptr);
-    FILE *sgf_outfd = open_memstream(&sgf_outptr, &sgf_outbuf_len);
-    assert(sgf_outfd != NULL);
+    // Buffer up existing SGF to file. Only the nodes added since the
+    // last update are written.
+    if (sgf_outfd == NULL)
+    {
+        sgf_outfd = open_memstream(&sgf_outptr, &sgf_outbuf_len);
+        assert(sgf_outfd != NULL);
+        sgfwriter_init(&sgf_writer, sgf_outfd);
+    }
     init_sgf(gameinfo);
-    writesgf_fd(sgftree.root, sgf_outfd);
-    fclose(sgf_outfd);
+    sgfwriter_sync(&sgf_writer, sgftree.root);
+    sgfwriter_finalize(&sgf_writer);
 
     if (update_cb != NULL)
         update_cb(&game_state);
@@ -142,6 +153,10 @@ static void esp_gnugo_update_board_state()
 static void esp_gnugo_init_board_state(char *infile, bool player_is_white, int requested_handicap, int requested_level)
 {
     gameinfo_clear(gameinfo);
+    pondered = false;
+    // The old tree is gone and its nodes may be reused for the new one.
+    if (sgf_outfd != NULL)
+        sgfwriter_truncate(&sgf_writer, 0);
     int did_load = 0;
     if (infile)
     {
@@ -210,6 +225,53 @@ void esp_gnugo_set_level(int level)
     set_level(level);
 }
 
+// Replace compiled in pattern databases by those in a binary image
+// written by `mkpat -B', e.g. a memory mapped flash partition. The
+// image is used in place and must stay mapped while the engine runs.
+int esp_gnugo_load_patterns(const void *image, size_t size)
+{
+    return load_pattern_image(image, size);
+}
+
+// With CONFIG_FIXED_MEMORY, put the memory pools into the given block,
+// e.g. in PSRAM, instead of taking memory_mb from the heap. Must be
+// called before esp_gnugo_start().
+void esp_gnugo_set_memory(void *memory, size_t size)
+{
+#ifdef CONFIG_FIXED_MEMORY
+    mempool_init(memory, size);
+#else
+    UNUSED(memory);
+    UNUSED(size);
+#endif
+}
+
+// Print the size and high-water mark of each memory pool.
+void esp_gnugo_memory_report(FILE *out)
+{
+#ifdef CONFIG_FIXED_MEMORY
+    mempool_report(out);
+#else
+    fprintf(out, "No fixed memory pools.\n");
+#endif
+}
+
+// Have the callback called with the time and nodes spent in each phase
+// of every computer move (see struct genmove_trace in gnugo.h), e.g.
+// to find out what made a move slow. NULL turns it off.
+void esp_gnugo_set_trace_callback(void (*callback)(const struct genmove_trace *))
+{
+    genmove_trace_hook = callback;
+}
+
+// Time allowance in seconds, as with the GTP command time_settings.
+// With autolevel on, the level is chosen from the time left and the
+// measured cost of each level (see engine/clock.c).
+void esp_gnugo_set_time_settings(int main_time, int byo_time, int byo_stones)
+{
+    clock_settings(main_time, byo_time, byo_stones);
+}
+
 static esp_gnugo_game_init_t i_p;
 esp_gnugo_state_t esp_gnugo_start(esp_gnugo_game_init_t init_params, bool *player_is_white_)
 {
@@ -318,14 +380,36 @@ void esp_gnugo_restart(int requested_level, bool player_is_white)
 esp_gnugo_state_t esp_gnugo_get_computer_move()
 {
     init_sgf(gameinfo);
-    adjust_level_offset(gameinfo->to_move);
+    if (autolevel_on)
+        adjust_level_offset(gameinfo->to_move);
     int resign = 0;
     float move_value;
     int move = genmove(gameinfo->to_move, &move_value, &resign);
     process_move(move, resign);
+    if (game_state.state == ESP_GNUGO_STATE_WAITING_FOR_PLAYER)
+        ponder_start(gameinfo->to_move);
     return game_state.state;
 }
 
+// Think on the player's time. Call this repeatedly while waiting for
+// the player's move; it returns false when there is nothing more to
+// do. Each call may take as long as a computer move unless interrupt
+// returns nonzero, which it is polled for regularly, or
+// esp_gnugo_stop_pondering() is called from another task. Neither
+// the engine nor the game may otherwise be used until it has returned.
+bool esp_gnugo_ponder(int (*interrupt)(void))
+{
+    if (game_state.state != ESP_GNUGO_STATE_WAITING_FOR_PLAYER)
+        return false;
+    pondered = true;
+    return ponder(interrupt);
+}
+
+void esp_gnugo_stop_pondering()
+{
+    interrupt_search();
+}
+
 int esp_gnugo_pos_from_xy(int x, int y)
 {
     return POS(x, y);
@@ -96,6 +96,8 @@ typedef struct
 esp_gnugo_state_t esp_gnugo_start(esp_gnugo_game_init_t, bool*);
 void esp_gnugo_restart(int level, bool player_is_white);
 esp_gnugo_state_t esp_gnugo_get_computer_move();
+bool esp_gnugo_ponder(int (*interrupt)(void));
+void esp_gnugo_stop_pondering();
 int esp_gnugo_set_player_command(engine_signal_t);
 // void esp_gnugo_set_level(int level);
 // int esp_gnugo_set_player_move(char *);
@@ -104,4 +106,10 @@ esp_gnugo_game_state_t *esp_gnugo_get_game_state();
 esp_gnugo_state_t esp_gnugo_get_state();
 void esp_gnugo_dump_sgf(char* sgfname);
 void esp_gnugo_play_gtp(FILE *gtp_input, FILE *gtp_output);
+int esp_gnugo_load_patterns(const void *image, size_t size);
+void esp_gnugo_set_memory(void *memory, size_t size);
+void esp_gnugo_memory_report(FILE *out);
+struct genmove_trace;
+void esp_gnugo_set_time_settings(int main_time, int byo_time, int byo_stones);
+void esp_gnugo_set_trace_callback(void (*callback)(const struct genmove_trace *));
 #endif
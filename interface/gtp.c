@@ -63,6 +63,12 @@ static int gtp_boardsize = -1;
 static gtp_transform_ptr vertex_transform_input_hook = NULL;
 static gtp_transform_ptr vertex_transform_output_hook = NULL;
 
+/* Idle hook. */
+static gtp_idle_ptr idle_hook = NULL;
+
+/* Input hook, fgets() if NULL. */
+static gtp_read_ptr read_hook = NULL;
+
 /* Current id number. We keep track of this internally rather than
  * pass it to the functions processing the commands, since those can't
  * do anything useful with it anyway.
@@ -91,8 +97,18 @@ gtp_main_loop(struct gtp_command commands[],
   gtp_output_file = gtp_output;
 
   while (status == GTP_OK) {
+    /* Give the program a chance to use the time until the next command
+     * arrives.
+     */
+    if (idle_hook != NULL)
+      (*idle_hook)(gtp_input);
+
     /* Read a line from gtp_input. */
-    if (!fgets(line, GTP_BUFSIZE, gtp_input))
+    if (read_hook != NULL) {
+      if (!(*read_hook)(line, GTP_BUFSIZE, gtp_input))
+	break; /* EOF or some error */
+    }
+    else if (!fgets(line, GTP_BUFSIZE, gtp_input))
       break; /* EOF or some error */
 
     if (gtp_dump_commands) {
@@ -170,6 +186,27 @@ gtp_set_vertex_transform_hooks(gtp_transform_ptr in, gtp_transform_ptr out)
   vertex_transform_output_hook = out;
 }
 
+/* The idle hook is called before each command is read. It may do
+ * some work in the meantime, but should return as soon as input is
+ * available on gtp_input. Notice that input already read into the
+ * stdio buffer of gtp_input cannot be seen by select() and similar
+ * functions, so the caller may want to make the stream unbuffered.
+ */
+void
+gtp_set_idle_hook(gtp_idle_ptr idle)
+{
+  idle_hook = idle;
+}
+
+/* The read hook replaces fgets() for reading commands, e.g. to read
+ * ahead while a command is executed. It must work like fgets().
+ */
+void
+gtp_set_read_hook(gtp_read_ptr read)
+{
+  read_hook = read;
+}
+
 /*
  * This function works like printf, except that it only understands
  * very few of the standard formats, to be precise %c, %d, %f, %s.
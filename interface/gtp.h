@@ -62,6 +62,12 @@ typedef int (*gtp_fn_ptr)(char *s);
 /* Function pointer for vertex transform functions. */
 typedef void (*gtp_transform_ptr)(int ai, int aj, int *bi, int *bj);
 
+/* Function pointer for the idle function. */
+typedef void (*gtp_idle_ptr)(FILE *gtp_input);
+
+/* Function pointer for a replacement of fgets(). */
+typedef char *(*gtp_read_ptr)(char *line, int size, FILE *gtp_input);
+
 /* Elements in the array of commands required by gtp_main_loop. */
 struct gtp_command {
   const char *name;
@@ -73,6 +79,8 @@ void gtp_main_loop(struct gtp_command commands[],
 void gtp_internal_set_boardsize(int size);
 void gtp_set_vertex_transform_hooks(gtp_transform_ptr in,
 				    gtp_transform_ptr out);
+void gtp_set_idle_hook(gtp_idle_ptr idle);
+void gtp_set_read_hook(gtp_read_ptr read);
 void gtp_mprintf(const char *format, ...);
 void gtp_printf(const char *format, ...);
 void gtp_start_response(int status);
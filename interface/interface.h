@@ -39,6 +39,7 @@ void play_gtp(FILE *gtp_input, FILE *gtp_output, FILE *gtp_dump_commands,
 void play_gmp(Gameinfo *gameinfo, int simplified);
 void play_solo(Gameinfo *gameinfo, int benchmark);
 void play_replay(SGFTree *tree, int color_to_test);
+void play_benchmark(const char *list, const char *baseline_file);
 
 void load_and_analyze_sgf_file(Gameinfo *gameinfo);
 void load_and_score_sgf_file(SGFTree *tree, Gameinfo *gameinfo,
@@ -35,6 +35,11 @@
 #include <io.h>
 #endif
 
+#ifdef HAVE_FORK
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
 #if TIME_WITH_SYS_TIME
 # include <sys/time.h>
 # include <time.h>
@@ -67,7 +72,11 @@ static void socket_connect_to(const char *host_name, unsigned int port,
 static void socket_listen_at(const char *host_name, unsigned int port,
 			     FILE **input_file, FILE **output_file);
 static void socket_close_connection(FILE *input_file, FILE *output_file);
-static void socket_stop_listening(FILE *input_file, FILE *output_file);
+static void socket_stop_listening(FILE *input_file, FILE *output_file,
+				  int last_client);
+
+static int fork_session(void);
+static void wait_for_sessions(int max_running);
 
 
 /* long options which have no short form */
@@ -86,11 +95,15 @@ enum {OPT_BOARDSIZE = 127,
       OPT_GTP_INPUT,
       OPT_GTP_CONNECT,
       OPT_GTP_LISTEN,
+      OPT_GTP_CLIENTS,
+      OPT_GTP_SESSIONS,
       OPT_GTP_DUMP_COMMANDS,
       OPT_GTP_INITIAL_ORIENTATION,
       OPT_GTP_VERSION,
       OPT_SHOWCOPYRIGHT,
       OPT_REPLAY_GAME,
+      OPT_BENCHMARK_GAMES,
+      OPT_BENCHMARK_BASELINE,
       OPT_DECIDE_STRING,
       OPT_DECIDE_CONNECTION,
       OPT_DECIDE_OWL,
@@ -99,6 +112,8 @@ enum {OPT_BOARDSIZE = 127,
       OPT_DECIDE_SURROUNDED,
       OPT_DECIDE_TACTICAL_SEMEAI,
       OPT_DECIDE_ORACLE,
+      OPT_DECIDE_BATCH,
+      OPT_BATCH_WORKERS,
       OPT_EXPERIMENTAL_SEMEAI,
       OPT_EXPERIMENTAL_OWL_EXT,
       OPT_SEMEAI_NODE_LIMIT,
@@ -162,7 +177,11 @@ enum {OPT_BOARDSIZE = 127,
       OPT_MC_GAMES_PER_LEVEL,
       OPT_MC_PATTERNS,
       OPT_MC_LIST_PATTERNS,
-      OPT_MC_LOAD_PATTERNS
+      OPT_MC_LOAD_PATTERNS,
+      OPT_LOAD_PATTERNS,
+      OPT_OWL_WORKERS,
+      OPT_PONDER,
+      OPT_FORCED_MOVES
 };
 
 /* names of playing modes */
@@ -179,6 +198,7 @@ enum mode {
   MODE_LOAD_AND_PRINT,
   MODE_SOLO,
   MODE_REPLAY,
+  MODE_BENCHMARK,
   MODE_DECIDE_STRING,
   MODE_DECIDE_CONNECTION,
   MODE_DECIDE_OWL,
@@ -189,7 +209,8 @@ enum mode {
   MODE_DECIDE_EYE,
   MODE_DECIDE_COMBINATION,
   MODE_DECIDE_SURROUNDED,
-  MODE_DECIDE_ORACLE
+  MODE_DECIDE_ORACLE,
+  MODE_DECIDE_BATCH
 };
 
 
@@ -209,6 +230,8 @@ static struct gg_option const long_options[] =
   {"gtp-input",      required_argument, 0, OPT_GTP_INPUT},
   {"gtp-connect",    required_argument, 0, OPT_GTP_CONNECT},
   {"gtp-listen",     required_argument, 0, OPT_GTP_LISTEN},
+  {"gtp-clients",    required_argument, 0, OPT_GTP_CLIENTS},
+  {"gtp-sessions",   required_argument, 0, OPT_GTP_SESSIONS},
   {"gtp-dump-commands", required_argument, 0, OPT_GTP_DUMP_COMMANDS},
   {"orientation",    required_argument, 0, OPT_GTP_INITIAL_ORIENTATION},
   {"gtp-initial-orientation",
@@ -281,6 +304,8 @@ static struct gg_option const long_options[] =
   {"worms",          no_argument,       0, 'w'},
   {"moyo",           required_argument, 0, 'm'},
   {"benchmark",      required_argument, 0, 'b'},
+  {"benchmark-games", required_argument, 0, OPT_BENCHMARK_GAMES},
+  {"benchmark-baseline", required_argument, 0, OPT_BENCHMARK_BASELINE},
   {"statistics",     no_argument,       0, 'S'},
   {"trace",          no_argument,       0, 't'},
   {"seed",           required_argument, 0, 'r'},
@@ -296,6 +321,8 @@ static struct gg_option const long_options[] =
   {"decide-eye",     required_argument, 0, OPT_DECIDE_EYE},
   {"decide-combination", no_argument,   0, OPT_DECIDE_COMBINATION},
   {"decide-oracle",  no_argument,       0, OPT_DECIDE_ORACLE},
+  {"decide-batch",   required_argument, 0, OPT_DECIDE_BATCH},
+  {"batch-workers",  required_argument, 0, OPT_BATCH_WORKERS},
   {"nofusekidb",     no_argument,       0, OPT_NOFUSEKIDB},
   {"nofuseki",       no_argument,       0, OPT_NOFUSEKI},
   {"nojosekidb",     no_argument,       0, OPT_NOJOSEKIDB},
@@ -315,6 +342,10 @@ static struct gg_option const long_options[] =
   {"mc-patterns",    required_argument, 0, OPT_MC_PATTERNS},
   {"mc-list-patterns", no_argument,     0, OPT_MC_LIST_PATTERNS},
   {"mc-load-patterns", required_argument, 0, OPT_MC_LOAD_PATTERNS},
+  {"load-patterns",  required_argument, 0, OPT_LOAD_PATTERNS},
+  {"owl-workers",    required_argument, 0, OPT_OWL_WORKERS},
+  {"ponder",         no_argument,       0, OPT_PONDER},
+  {"forced-moves",   no_argument,       0, OPT_FORCED_MOVES},
   {NULL, 0, NULL, 0}
 };
 
@@ -332,6 +363,8 @@ main(int argc, char *argv[])
   
   char *infilename = NULL;
   char *untilstring = NULL;
+  char *batch_filename = NULL;
+  int batch_workers = 1;
   char *scoringmode = NULL;
   char *outfile = NULL;
   char *outflags = NULL;
@@ -339,6 +372,8 @@ main(int argc, char *argv[])
   char *gtp_dump_commands_file = NULL;
   int gtp_tcp_ip_mode = 0;
   char *gtp_tcp_ip_address = NULL;
+  int gtp_clients = -1;   /* Not given, depends on gtp_sessions. */
+  int gtp_sessions = 1;
   
   char *printsgffile = NULL;
   
@@ -347,11 +382,14 @@ main(int argc, char *argv[])
   char debuginfluence_move[4] = "\0";
   
   int benchmark = 0;  /* benchmarking mode (-b) */
+  char *benchmark_games = NULL;
+  char *benchmark_baseline = NULL;
   FILE *output_check;
   int orientation = 0;
 
   char mc_pattern_name[40] = "";
   char mc_pattern_filename[320] = "";
+  char pattern_filename[320] = "";
 
   float memory = (float) DEFAULT_MEMORY; /* Megabytes used for hash table. */
 
@@ -451,6 +489,29 @@ main(int argc, char *argv[])
 
 	break;
 
+      case OPT_GTP_CLIENTS:
+	gtp_clients = atoi(gg_optarg);
+	if (gtp_clients < 0) {
+	  fprintf(stderr, "Invalid number of GTP clients: %s\n", gg_optarg);
+	  exit(EXIT_FAILURE);
+	}
+	break;
+
+      case OPT_GTP_SESSIONS:
+	gtp_sessions = atoi(gg_optarg);
+	if (gtp_sessions < 1) {
+	  fprintf(stderr, "Invalid number of GTP sessions: %s\n", gg_optarg);
+	  exit(EXIT_FAILURE);
+	}
+#ifndef HAVE_FORK
+	if (gtp_sessions > 1) {
+	  fprintf(stderr,
+		  "gnugo: no fork() on this system, serving one client at a time\n");
+	  gtp_sessions = 1;
+	}
+#endif
+	break;
+
       case OPT_GTP_DUMP_COMMANDS:
 	gtp_dump_commands_file = gg_optarg;
 	break;
@@ -681,6 +742,26 @@ main(int argc, char *argv[])
 	break;
 #endif
 
+      case OPT_LOAD_PATTERNS:
+	if (strlen(gg_optarg) >= sizeof(pattern_filename)) {
+	  fprintf(stderr, "Too long name given as value to --load-patterns option.\n");
+	  exit(EXIT_FAILURE);
+	}
+	strcpy(pattern_filename, gg_optarg);
+	break;
+
+      case OPT_OWL_WORKERS:
+	owl_workers = atoi(gg_optarg);
+	break;
+
+      case OPT_PONDER:
+	ponder_on = 1;
+	break;
+
+      case OPT_FORCED_MOVES:
+	forced_moves = 1;
+	break;
+
       case OPT_MODE: 
 	if (strcmp(gg_optarg, "ascii") == 0)
 	  playmode = MODE_ASCII;
@@ -808,6 +889,19 @@ main(int argc, char *argv[])
 	playmode = MODE_DECIDE_ORACLE;
 	break;
 	
+      case OPT_DECIDE_BATCH:
+	batch_filename = gg_optarg;
+	playmode = MODE_DECIDE_BATCH;
+	break;
+	
+      case OPT_BATCH_WORKERS:
+	batch_workers = atoi(gg_optarg);
+	if (batch_workers < 1) {
+	  fprintf(stderr, "Invalid number of batch workers: %s\n", gg_optarg);
+	  return EXIT_FAILURE;
+	}
+	break;
+	
       case OPT_BRANCH_DEPTH:
 	mandated_branch_depth = atoi(gg_optarg);
 	break;
@@ -918,6 +1012,15 @@ main(int argc, char *argv[])
 	}
 	break;
 	
+      case OPT_BENCHMARK_GAMES:
+	playmode = MODE_BENCHMARK;
+	benchmark_games = gg_optarg;
+	break;
+
+      case OPT_BENCHMARK_BASELINE:
+	benchmark_baseline = gg_optarg;
+	break;
+	
       case OPT_SCORE:
 	scoringmode = gg_optarg;
 	if (playmode == MODE_UNKNOWN)
@@ -1016,12 +1119,25 @@ main(int argc, char *argv[])
     gnugo_clear_board(requested_boardsize);
   }
   
-  /* Start random number seed. */
+  /* Start random number seed. The replay benchmark must be
+   * repeatable.
+   */
   if (!seed_specified)
-    seed = time(0);
+    seed = (playmode == MODE_BENCHMARK ? 1 : time(0));
   
   /* Initialize the GNU Go engine. */
   init_gnugo(memory, seed);
+#ifdef PROFILE_PLACEMENT
+  placement_profile_start();
+#endif
+
+  /* Replace compiled in pattern databases by those in a binary
+   * pattern file, if one has been specified.
+   */
+  if (strlen(pattern_filename) > 0) {
+    if (!load_pattern_file(pattern_filename))
+      return EXIT_FAILURE;
+  }
 
 #ifndef CONFIG_DISABLE_MONTE_CARLO
   /* Load Monte Carlo patterns if one has been specified. Either
@@ -1122,6 +1238,10 @@ main(int argc, char *argv[])
     }
     play_replay(&sgftree, replay_color);
     break;
+
+  case MODE_BENCHMARK:
+    play_benchmark(benchmark_games, benchmark_baseline);
+    break;
     
   case MODE_LOAD_AND_ANALYZE:
     if (mandated_color != EMPTY)
@@ -1385,11 +1505,37 @@ main(int argc, char *argv[])
     }
 #endif
 
+  case MODE_DECIDE_BATCH:
+    {
+      FILE *batch_file = stdin;
+
+      if (strcmp(batch_filename, "-") != 0) {
+	batch_file = fopen(batch_filename, "r");
+	if (!batch_file) {
+	  fprintf(stderr, "gnugo: cannot open %s\n", batch_filename);
+	  return EXIT_FAILURE;
+	}
+      }
+
+      decide_batch(batch_file, stdout, batch_workers);
+
+      if (batch_file != stdin)
+	fclose(batch_file);
+      break;
+    }
+
   case MODE_GTP:
     {
       FILE *gtp_input_FILE = stdin;
       FILE *gtp_output_FILE = stdout;
       FILE *gtp_dump_commands_FILE = NULL;
+      unsigned int port = 65536;
+      const char *host_name = NULL;
+      int initial_board_size = board_size;
+      float initial_komi = komi;
+      int initial_level = get_level();
+      int client;
+      int board_used = 0;
 
       if (gtpfile != NULL) {
 	gtp_input_FILE = fopen(gtpfile, "r");
@@ -1399,9 +1545,7 @@ main(int argc, char *argv[])
 	}
       }
       else if (gtp_tcp_ip_mode != 0) {
-	unsigned int port = 65536;
 	char *port_string = strchr(gtp_tcp_ip_address, ':');
-	const char *host_name = NULL;
 
 	if (port_string) {
 	  host_name = gtp_tcp_ip_address;
@@ -1421,10 +1565,6 @@ main(int argc, char *argv[])
 	  socket_connect_to(host_name, port,
 			    &gtp_input_FILE, &gtp_output_FILE);
 	}
-	else {
-	  socket_listen_at(host_name, port,
-			   &gtp_input_FILE, &gtp_output_FILE);
-	}
       }
 
       if (gtp_dump_commands_file != NULL) {
@@ -1436,16 +1576,65 @@ main(int argc, char *argv[])
 	}
       }
 
-      play_gtp(gtp_input_FILE, gtp_output_FILE, gtp_dump_commands_FILE,
-	       orientation);
+      /* When listening, serve the clients one after the other, so
+       * that the engine is only initialized once. With several
+       * sessions each client is served by a process forked from the
+       * initialized engine, which shares the pattern data with it.
+       * Sessions serve any number of clients unless told otherwise.
+       */
+      if (gtp_clients < 0)
+	gtp_clients = (gtp_sessions > 1 ? 0 : 1);
+
+      for (client = 0; gtp_clients == 0 || client < gtp_clients; client++) {
+	int last_client = (gtp_clients != 0 && client == gtp_clients - 1);
+	int session = -1;
+
+	if (gtp_tcp_ip_mode == OPT_GTP_LISTEN) {
+	  /* Each client starts out like the first one, also when an
+	   * earlier one was served here because no session process
+	   * could be started.
+	   */
+	  if (board_used) {
+	    board_size = initial_board_size;
+	    komi = initial_komi;
+	    set_level(initial_level);
+	    gnugo_clear_board(board_size);
+	    board_used = 0;
+	  }
+	  wait_for_sessions(gtp_sessions);
+	  socket_listen_at(host_name, port,
+			   &gtp_input_FILE, &gtp_output_FILE);
+	  if (gtp_sessions > 1) {
+	    session = fork_session();
+	    if (session == 1) {
+	      socket_close_connection(gtp_input_FILE, gtp_output_FILE);
+	      continue;
+	    }
+	    /* Unless a seed was given, the sessions play different games. */
+	    if (session == 0 && !seed_specified)
+	      set_random_seed(seed + client);
+	  }
+	}
+
+	play_gtp(gtp_input_FILE, gtp_output_FILE, gtp_dump_commands_FILE,
+		 orientation);
+	board_used = 1;
+
+	if (gtp_tcp_ip_mode != OPT_GTP_LISTEN)
+	  break;
+	socket_stop_listening(gtp_input_FILE, gtp_output_FILE,
+			      last_client || session == 0);
+	if (session == 0 && gtp_sessions > 1)
+	  break;
+      }
+
+      wait_for_sessions(1);
 
       if (gtp_dump_commands_FILE)
 	fclose(gtp_dump_commands_FILE);
 
       if (gtp_tcp_ip_mode == OPT_GTP_CONNECT)
 	socket_close_connection(gtp_input_FILE, gtp_output_FILE);
-      else if (gtp_tcp_ip_mode == OPT_GTP_LISTEN)
-	socket_stop_listening(gtp_input_FILE, gtp_output_FILE);
     }
 
     break;
@@ -1572,6 +1761,13 @@ Connection options\n\
    --gtp-listen [HOST:]PORT\n\
                      Wait for the first TCP/IP connection on the given port\n\
                      (if HOST is specified, only to that host)\n\
+   --gtp-clients <n> With --gtp-listen, serve n connections in turn\n\
+                     (default 1, or no limit with --gtp-sessions;\n\
+                     0 for no limit)\n\
+   --gtp-sessions <n>\n\
+                     Serve up to n connections at the same time, each in\n\
+                     its own process (default 1). -M is the cache size of\n\
+                     each session\n\
    --gtp-version\n\
 \n\
 "
@@ -1584,6 +1780,9 @@ Experimental options:\n\
    --no-cosmic-gnugo       don't use center oriented influence (default)\n\
    --large-scale           look for large scale captures\n\
    --no-large-scale        don't seek large scale captures (default)\n\
+   --owl-workers <n>       read owl questions ahead in n processes\n\
+   --ponder                think on the opponent's time in GTP mode\n\
+   --forced-moves          answer forced moves without full move generation\n\
    --nofusekidb            turn off fuseki database\n\
    --nofuseki              turn off fuseki moves entirely\n\
    --nojosekidb            turn off joseki database\n\
@@ -1594,6 +1793,7 @@ Experimental options:\n\
    --mc-list-patterns      list names of builtin Monte Carlo patterns\n\
    --mc-patterns <name>    choose a built in Monte Carlo pattern database\n\
    --mc-load-patterns <filename> read Monte Carlo patterns from file\n\
+   --load-patterns <filename> read pattern databases from a binary file\n\
    --alternate-connections\n\
    --experimental-connections\n\
    --experimental-owl-ext\n\
@@ -1644,6 +1844,8 @@ Debugging Options:\n\
    -m, --moyo <level>            moyo debugging, show moyo board\n\
        --debug-influence <move>   print influence map after making a move\n\
    -b, --benchmark num           benchmarking mode - can be used with -l\n\
+       --benchmark-games <file>  replay benchmark on the positions listed\n\
+       --benchmark-baseline <file>  compare with an earlier benchmark result\n\
    -S, --statistics              print statistics (for debugging purposes)\n\n\
        --profile-patterns        print statistics for pattern usage\n\
        --showtime                print timing diagnostic\n\
@@ -1693,6 +1895,9 @@ Options providing detailed reading results etc.:\n\
    --decide-semeai\n\
    --decide-tactical-semeai\n\
    --decide-surrounded\n\
+   --decide-batch <file>        answer reading queries in file, or - for\n\
+                                stdin, as JSON lines\n\
+   --batch-workers <n>          processes for --decide-batch (default 1)\n\
    --limit-search\n\
 \n\
 "
@@ -1771,6 +1976,26 @@ init_sockets(void)
 #endif	/* on Windows */
 
 
+static void
+socket_open_connection(int connection_socket,
+		       FILE **input_file, FILE **output_file)
+{
+#if !USE_WINDOWS_SOCKET_CLUDGE
+
+  *input_file  = fdopen(connection_socket, "r");
+  *output_file = fdopen(dup(connection_socket), "w");
+
+#else	/* USE_WINDOWS_SOCKET_CLUDGE */
+
+  winsocket_activate(connection_socket);
+
+  *input_file  = NULL;
+  *output_file = NULL;
+
+#endif	/* USE_WINDOWS_SOCKET_CLUDGE */
+}
+
+
 static void
 socket_connect_to(const char *host_name, unsigned int port,
 		  FILE **input_file, FILE **output_file)
@@ -1816,30 +2041,33 @@ socket_connect_to(const char *host_name, unsigned int port,
     exit(EXIT_FAILURE);
   }
 
-#if !USE_WINDOWS_SOCKET_CLUDGE
-
-  *input_file  = fdopen(connection_socket, "r");
-  *output_file = fdopen(dup(connection_socket), "w");
-
-#else	/* USE_WINDOWS_SOCKET_CLUDGE */
-
-  winsocket_activate(connection_socket);
-
-  *input_file  = NULL;
-  *output_file = NULL;
-
-#endif	/* USE_WINDOWS_SOCKET_CLUDGE */
+  socket_open_connection(connection_socket, input_file, output_file);
 }
 
 
+/* The socket stays open between clients, see socket_stop_listening(). */
+static int listening_socket = -1;
+
 static void
 socket_listen_at(const char *host_name, unsigned int port,
 		 FILE **input_file, FILE **output_file)
 {
   struct sockaddr_in address;
-  int listening_socket;
   int connection_socket;
 
+  if (listening_socket != -1) {
+    if (verbose)
+      fprintf(stderr, "Waiting for the next connection...\n");
+    connection_socket = accept(listening_socket, NULL, NULL);
+    if (connection_socket == -1) {
+      fprintf(stderr, "Failed to accept a connection\n");
+      closesocket(listening_socket);
+      exit(EXIT_FAILURE);
+    }
+    socket_open_connection(connection_socket, input_file, output_file);
+    return;
+  }
+
   init_sockets();
 
   if (host_name) {
@@ -1880,7 +2108,7 @@ socket_listen_at(const char *host_name, unsigned int port,
 
   if (bind(listening_socket,
 	   (struct sockaddr *) &address, sizeof address) == -1
-      || listen(listening_socket, 0) == -1
+      || listen(listening_socket, SOMAXCONN) == -1
       || (connection_socket = accept(listening_socket, NULL, NULL)) == -1) {
     if (host_name)
       fprintf(stderr, "Failed to listen on %s:%u\n", host_name, port);
@@ -1891,21 +2119,7 @@ socket_listen_at(const char *host_name, unsigned int port,
     exit(EXIT_FAILURE);
   }
 
-  closesocket(listening_socket);
-
-#if !USE_WINDOWS_SOCKET_CLUDGE
-
-  *input_file  = fdopen(connection_socket, "r");
-  *output_file = fdopen(dup(connection_socket), "w");
-
-#else	/* USE_WINDOWS_SOCKET_CLUDGE */
-
-  winsocket_activate(connection_socket);
-
-  *input_file  = NULL;
-  *output_file = NULL;
-
-#endif	/* USE_WINDOWS_SOCKET_CLUDGE */
+  socket_open_connection(connection_socket, input_file, output_file);
 }
 
 
@@ -1919,7 +2133,7 @@ socket_close_connection(FILE *input_file, FILE *output_file)
 
 
 static void
-socket_stop_listening(FILE *input_file, FILE *output_file)
+socket_stop_listening(FILE *input_file, FILE *output_file, int last_client)
 {
   int buffer[0x1000];
 
@@ -1935,6 +2149,11 @@ socket_stop_listening(FILE *input_file, FILE *output_file)
 
   fclose(input_file);
   fclose(output_file);
+
+  if (last_client) {
+    closesocket(listening_socket);
+    listening_socket = -1;
+  }
 }
 
 
@@ -1978,16 +2197,79 @@ socket_close_connection(FILE *input_file, FILE *output_file)
 
 
 static void
-socket_stop_listening(FILE *input_file, FILE *output_file)
+socket_stop_listening(FILE *input_file, FILE *output_file, int last_client)
 {
   UNUSED(input_file);
   UNUSED(output_file);
+  UNUSED(last_client);
 }
 
 
 #endif	/* not ENABLE_SOCKET_SUPPORT */
 
 
+
+#ifdef HAVE_FORK
+
+/* Number of running session processes. */
+static int running_sessions = 0;
+
+/* Start a process to serve a new session. Returns 1 in the main
+ * process, 0 in the session process and -1 if no process could be
+ * started, in which case the main process serves the session itself.
+ */
+static int
+fork_session(void)
+{
+  pid_t pid;
+
+  /* Otherwise pending output is written once by every process. */
+  fflush(NULL);
+
+  pid = fork();
+  if (pid == -1)
+    return -1;
+  if (pid == 0) {
+    running_sessions = 0;
+    return 0;
+  }
+
+  running_sessions++;
+  return 1;
+}
+
+
+/* Collect the finished session processes and wait until fewer than
+ * max_running are left.
+ */
+static void
+wait_for_sessions(int max_running)
+{
+  while (running_sessions > 0) {
+    int options = (running_sessions < max_running ? WNOHANG : 0);
+    if (waitpid(-1, NULL, options) <= 0)
+      break;
+    running_sessions--;
+  }
+}
+
+#else	/* not HAVE_FORK */
+
+static int
+fork_session(void)
+{
+  return -1;
+}
+
+static void
+wait_for_sessions(int max_running)
+{
+  UNUSED(max_running);
+}
+
+#endif	/* not HAVE_FORK */
+
+
 /*
  * Local Variables:
  * tab-width: 8
@@ -28,6 +28,14 @@
 #include <ctype.h>
 #include <string.h>
 #include <math.h>
+#include <signal.h>
+
+#ifdef HAVE_SELECT
+#include <sys/types.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
 
 #include "interface.h"
 #include "liberty.h"
@@ -37,11 +45,22 @@
 /* Internal state that's not part of the engine. */
 static int report_uncertainty = 0;
 static int gtp_orientation = 0;
+static volatile int gtp_command_running = 0;
+static int interrupt_countdown = 0;  /* see gtp_interrupt_after() */
 
 static void gtp_print_code(int c);
 static void gtp_print_vertices2(int n, int *moves);
 static void rotate_on_input(int ai, int aj, int *bi, int *bj);
 static void rotate_on_output(int ai, int aj, int *bi, int *bj);
+static int interruptible_genmove(int color, int conservative,
+				 int *move, int *resign);
+static int gtp_poll_interrupt(void);
+static void gtp_sigint_handler(int sig);
+#ifdef HAVE_SELECT
+static void reset_async_input(FILE *gtp_input);
+static char *read_async_input(char *line, int size, FILE *gtp_input);
+static void gtp_idle_ponder(FILE *gtp_input);
+#endif
 
 
 #define DECLARE(func) static int func(char *s)
@@ -94,6 +113,7 @@ DECLARE(gtp_fixed_handicap);
 DECLARE(gtp_followup_influence);
 DECLARE(gtp_genmove);
 DECLARE(gtp_genmove_black);
+DECLARE(gtp_genmove_trace);
 DECLARE(gtp_genmove_white);
 DECLARE(gtp_get_connection_node_counter);
 DECLARE(gtp_get_handicap);
@@ -105,9 +125,11 @@ DECLARE(gtp_get_reading_node_counter);
 DECLARE(gtp_get_trymove_counter);
 DECLARE(gtp_gg_genmove);
 DECLARE(gtp_gg_undo);
+DECLARE(gtp_gogui_interrupt);
 DECLARE(gtp_half_eye_data);
 DECLARE(gtp_increase_depths);
 DECLARE(gtp_initial_influence);
+DECLARE(gtp_interrupt_after);
 DECLARE(gtp_invariant_hash);
 DECLARE(gtp_invariant_hash_for_moves);
 DECLARE(gtp_is_legal);
@@ -120,6 +142,7 @@ DECLARE(gtp_limit_search);
 DECLARE(gtp_list_commands);
 DECLARE(gtp_list_stones);
 DECLARE(gtp_loadsgf);
+DECLARE(gtp_memory_pools);
 DECLARE(gtp_move_influence);
 DECLARE(gtp_move_probabilities);
 DECLARE(gtp_move_reasons);
@@ -134,10 +157,13 @@ DECLARE(gtp_owl_does_defend);
 DECLARE(gtp_owl_substantial);
 DECLARE(gtp_owl_threaten_attack);
 DECLARE(gtp_owl_threaten_defense);
+DECLARE(gtp_pattern_statistics);
+DECLARE(gtp_pattern_statistics_csv);
 DECLARE(gtp_place_free_handicap);
 DECLARE(gtp_play);
 DECLARE(gtp_playblack);
 DECLARE(gtp_playwhite);
+DECLARE(gtp_ponder);
 DECLARE(gtp_popgo);
 DECLARE(gtp_printsgf);
 DECLARE(gtp_program_version);
@@ -150,6 +176,7 @@ DECLARE(gtp_report_uncertainty);
 DECLARE(gtp_reset_connection_node_counter);
 DECLARE(gtp_reset_life_node_counter);
 DECLARE(gtp_reset_owl_node_counter);
+DECLARE(gtp_reset_pattern_statistics);
 DECLARE(gtp_reset_reading_node_counter);
 DECLARE(gtp_reset_search_mask);
 DECLARE(gtp_reset_trymove_counter);
@@ -236,6 +263,7 @@ static struct gtp_command commands[] = {
   {"followup_influence",      gtp_followup_influence},
   {"genmove",                 gtp_genmove},
   {"genmove_black",           gtp_genmove_black},
+  {"genmove_trace",           gtp_genmove_trace},
   {"genmove_white",           gtp_genmove_white},
   {"get_connection_node_counter", gtp_get_connection_node_counter},
   {"get_handicap",   	      gtp_get_handicap},
@@ -247,10 +275,12 @@ static struct gtp_command commands[] = {
   {"get_trymove_counter",     gtp_get_trymove_counter},
   {"gg-undo",                 gtp_gg_undo},
   {"gg_genmove",              gtp_gg_genmove},
+  {"gogui-interrupt",         gtp_gogui_interrupt},
   {"half_eye_data",           gtp_half_eye_data},
   {"help",                    gtp_list_commands},
   {"increase_depths",  	      gtp_increase_depths},
   {"initial_influence",       gtp_initial_influence},
+  {"interrupt_after",         gtp_interrupt_after},
   {"invariant_hash_for_moves",gtp_invariant_hash_for_moves},
   {"invariant_hash",   	      gtp_invariant_hash},
   {"is_legal",         	      gtp_is_legal},
@@ -265,6 +295,7 @@ static struct gtp_command commands[] = {
   {"list_commands",    	      gtp_list_commands},
   {"list_stones",    	      gtp_list_stones},
   {"loadsgf",          	      gtp_loadsgf},
+  {"memory_pools",            gtp_memory_pools},
   {"move_influence",          gtp_move_influence},
   {"move_probabilities",      gtp_move_probabilities},
   {"move_reasons",            gtp_move_reasons},
@@ -281,8 +312,11 @@ static struct gtp_command commands[] = {
   {"owl_substantial", 	      gtp_owl_substantial},
   {"owl_threaten_attack",     gtp_owl_threaten_attack},
   {"owl_threaten_defense",    gtp_owl_threaten_defense},
+  {"pattern_statistics",      gtp_pattern_statistics},
+  {"pattern_statistics_csv",  gtp_pattern_statistics_csv},
   {"place_free_handicap",     gtp_place_free_handicap},
   {"play",            	      gtp_play},
+  {"ponder",                  gtp_ponder},
   {"popgo",            	      gtp_popgo},
   {"printsgf",         	      gtp_printsgf},
   {"protocol_version",        gtp_protocol_version},
@@ -294,6 +328,7 @@ static struct gtp_command commands[] = {
   {"reset_connection_node_counter", gtp_reset_connection_node_counter},
   {"reset_life_node_counter", gtp_reset_life_node_counter},
   {"reset_owl_node_counter",  gtp_reset_owl_node_counter},
+  {"reset_pattern_statistics", gtp_reset_pattern_statistics},
   {"reset_reading_node_counter", gtp_reset_reading_node_counter},
   {"reset_search_mask",       gtp_reset_search_mask},
   {"reset_trymove_counter",   gtp_reset_trymove_counter},
@@ -344,6 +379,14 @@ play_gtp(FILE *gtp_input, FILE *gtp_output, FILE *gtp_dump_commands,
   gtp_orientation = gtp_initial_orientation;
   gtp_set_vertex_transform_hooks(rotate_on_input, rotate_on_output);
 
+#ifdef HAVE_SELECT
+  reset_async_input(gtp_input);
+  gtp_set_read_hook(read_async_input);
+  if (ponder_on)
+    gtp_set_idle_hook(gtp_idle_ponder);
+#endif
+  signal(SIGINT, gtp_sigint_handler);
+
   /* Initialize time handling. */
   init_timers();
   
@@ -351,6 +394,7 @@ play_gtp(FILE *gtp_input, FILE *gtp_output, FILE *gtp_dump_commands,
   reset_engine();
   clearstats();
   gtp_main_loop(commands, gtp_input, gtp_output, gtp_dump_commands);
+  signal(SIGINT, SIG_DFL);
   if (showstatistics)
     showstats();
 }
@@ -2507,7 +2551,8 @@ gtp_genmove_black(char *s)
   if (stackp > 0)
     return gtp_failure("genmove cannot be called when stackp > 0");
 
-  move = genmove(BLACK, NULL, NULL);
+  if (!interruptible_genmove(BLACK, 0, &move, NULL))
+    return gtp_failure("interrupted");
 
   gnugo_play_move(move, BLACK);
 
@@ -2532,7 +2577,8 @@ gtp_genmove_white(char *s)
   if (stackp > 0)
     return gtp_failure("genmove cannot be called when stackp > 0");
 
-  move = genmove(WHITE, NULL, NULL);
+  if (!interruptible_genmove(WHITE, 0, &move, NULL))
+    return gtp_failure("interrupted");
 
   gnugo_play_move(move, WHITE);
 
@@ -2564,12 +2610,15 @@ gtp_genmove(char *s)
     return gtp_failure("genmove cannot be called when stackp > 0");
 
   adjust_level_offset(color);
-  move = genmove(color, NULL, &resign);
+  if (!interruptible_genmove(color, 0, &move, &resign))
+    return gtp_failure("interrupted");
 
   if (resign)
     return gtp_success("resign");
 
   gnugo_play_move(move, color);
+  if (ponder_on)
+    ponder_start(OTHER_COLOR(color));
 
   gtp_start_response(GTP_SUCCESS);
   gtp_print_vertex(I(move), J(move));
@@ -2590,6 +2639,7 @@ gtp_reg_genmove(char *s)
   int move;
   int color;
   int n;
+  int interrupted;
   unsigned int saved_random_seed = get_random_seed();
 
   n = gtp_decode_color(s, &color);
@@ -2606,9 +2656,11 @@ gtp_reg_genmove(char *s)
    */
   set_random_seed(0);
   
-  move = genmove_conservative(color, NULL);
+  interrupted = !interruptible_genmove(color, 1, &move, NULL);
 
   set_random_seed(saved_random_seed);
+  if (interrupted)
+    return gtp_failure("interrupted");
   gtp_start_response(GTP_SUCCESS);
   gtp_print_vertex(I(move), J(move));
   return gtp_finish_response();
@@ -2627,6 +2679,7 @@ gtp_gg_genmove(char *s)
   int move;
   int color;
   int n;
+  int interrupted;
   unsigned int saved_random_seed = get_random_seed();
   unsigned int seed;
 
@@ -2647,8 +2700,10 @@ gtp_gg_genmove(char *s)
   sscanf(s+n, "%u", &seed);
   set_random_seed(seed);
   
-  move = genmove_conservative(color, NULL);
+  interrupted = !interruptible_genmove(color, 1, &move, NULL);
   set_random_seed(saved_random_seed);
+  if (interrupted)
+    return gtp_failure("interrupted");
   gtp_start_response(GTP_SUCCESS);
   gtp_print_vertex(I(move), J(move));
   return gtp_finish_response();
@@ -2729,6 +2784,7 @@ gtp_kgs_genmove_cleanup(char *s)
   int move;
   int color;
   int n;
+  int interrupted;
   int save_capture_all_dead = capture_all_dead;
 
   n = gtp_decode_color(s, &color);
@@ -2744,9 +2800,11 @@ gtp_kgs_genmove_cleanup(char *s)
   capture_all_dead = 1;
   
   adjust_level_offset(color);
-  move = genmove(color, NULL, NULL);
+  interrupted = !interruptible_genmove(color, 0, &move, NULL);
 
   capture_all_dead = save_capture_all_dead;
+  if (interrupted)
+    return gtp_failure("interrupted");
   
   gnugo_play_move(move, color);
 
@@ -2756,6 +2814,103 @@ gtp_kgs_genmove_cleanup(char *s)
 }
 
 
+/* Function:  Announce that a line "# interrupt" interrupts the move
+ *            generation commands.
+ * Arguments: none
+ * Fails:     never
+ * Returns:   nothing
+ *
+ * Status:    GoGui specific command.
+ *
+ * The interrupted command fails with "interrupted" and leaves the
+ * board unchanged. SIGINT has the same effect.
+ */
+static int
+gtp_gogui_interrupt(char *s)
+{
+  UNUSED(s);
+  return gtp_success("");
+}
+
+
+/* Function:  Interrupt the next interruptible command, like genmove,
+ *            when it polls for an interrupt for the nth time.
+ * Arguments: number of polls, or 0 to interrupt at the first trial move
+ * Fails:     invalid number
+ * Returns:   nothing
+ *
+ * This makes interrupts reproducible for the regression tests. The
+ * interrupt is polled for every few hundred trial moves, see
+ * interrupt.c.
+ */
+static int
+gtp_interrupt_after(char *s)
+{
+  int polls;
+
+  if (sscanf(s, "%d", &polls) < 1 || polls < 0)
+    return gtp_failure("invalid number");
+
+  interrupt_countdown = polls;
+  if (polls == 0)
+    interrupt_search();
+
+  return gtp_success("");
+}
+
+
+/* Function:  Ponder as --ponder does while waiting for the opponent.
+ * Arguments: color to move, maximum number of steps
+ * Fails:     invalid color, invalid number of steps
+ * Returns:   the predicted moves which have an answer prepared
+ *
+ * The first step predicts the moves of color and each further step
+ * prepares the answer to one of them, see ponder.c. If one of them
+ * is played, the answer is used by the next genmove. With 0 steps
+ * the prepared answers are only forgotten. The command can be
+ * interrupted, which ends pondering early.
+ */
+static int
+gtp_ponder(char *s)
+{
+  int color;
+  int steps;
+  int moves[MAX_BOARD * MAX_BOARD];
+  int num_moves;
+  int n;
+  int k;
+  unsigned int saved_random_seed = get_random_seed();
+
+  n = gtp_decode_color(s, &color);
+  if (!n)
+    return gtp_failure("invalid color");
+
+  if (sscanf(s + n, "%d", &steps) < 1 || steps < 0)
+    return gtp_failure("invalid number of steps");
+
+  if (stackp > 0)
+    return gtp_failure("ponder cannot be called when stackp > 0");
+
+  /* Like reg_genmove, this is deterministic. */
+  set_random_seed(0);
+
+  ponder_start(color);
+  gtp_command_running = 1;
+  for (k = 0; k < steps; k++)
+    if (!ponder(gtp_poll_interrupt))
+      break;
+  gtp_command_running = 0;
+  interrupt_countdown = 0;
+
+  set_random_seed(saved_random_seed);
+
+  num_moves = ponder_prepared_moves(moves, MAX_BOARD * MAX_BOARD);
+  gtp_start_response(GTP_SUCCESS);
+  gtp_print_vertices2(num_moves, moves);
+  return gtp_finish_response();
+}
+
+
 /* Function : List the move reasons for a move.
  * Arguments: vertex
  * Fails:   : invalid vertex, occupied vertex
@@ -3423,6 +3578,112 @@ gtp_get_reading_node_counter(char *s)
 }
 
 
+/* Function:  Reset the pattern database statistics and start collecting
+ *            them.
+ * Arguments: none
+ * Fails:     never
+ * Returns:   nothing
+ */
+static int
+gtp_reset_pattern_statistics(char *s)
+{
+  UNUSED(s);
+  reset_pattern_statistics();
+  return gtp_success("");
+}
+
+
+/* Function:  List the calls, anchors, DFA hits, matches, constraint
+ *            evaluations, reading nodes and time spent for each pattern
+ *            database since reset_pattern_statistics.
+ * Arguments: none
+ * Fails:     never
+ * Returns:   Table of pattern database statistics.
+ */
+static int
+gtp_pattern_statistics(char *s)
+{
+  UNUSED(s);
+  gtp_start_response(GTP_SUCCESS);
+  print_pattern_statistics(gtp_output_file, 0);
+  gtp_printf("\n");
+  return GTP_OK;
+}
+
+
+/* Function:  List the size, current use, high-water mark and failed
+ *            allocations of each memory pool.
+ * Arguments: none
+ * Fails:     unless compiled with CONFIG_FIXED_MEMORY
+ * Returns:   Table of memory pools.
+ */
+static int
+gtp_memory_pools(char *s)
+{
+  UNUSED(s);
+#ifdef CONFIG_FIXED_MEMORY
+  gtp_start_response(GTP_SUCCESS);
+  mempool_report(gtp_output_file);
+  gtp_printf("\n");
+  return GTP_OK;
+#else
+  return gtp_failure("no fixed memory pools");
+#endif
+}
+
+
+/* Function:  Write the pattern database statistics as comma separated
+ *            values to filename, or as output if filename is missing
+ *            or "-".
+ * Arguments: optional filename
+ * Fails:     if the file cannot be opened
+ * Returns:   nothing if filename, otherwise the statistics
+ */
+static int
+gtp_pattern_statistics_csv(char *s)
+{
+  char filename[GTP_BUFSIZE];
+  FILE *outfile;
+
+  if (sscanf(s, "%s", filename) < 1 || strcmp(filename, "-") == 0) {
+    gtp_start_response(GTP_SUCCESS);
+    print_pattern_statistics(gtp_output_file, 1);
+    gtp_printf("\n");
+    return GTP_OK;
+  }
+
+  outfile = fopen(filename, "w");
+  if (!outfile)
+    return gtp_failure("cannot open '%s'", filename);
+  print_pattern_statistics(outfile, 1);
+  fclose(outfile);
+  return gtp_success("");
+}
+
+
+/* Function:  List the CPU and wall time in seconds and the reading, owl
+ *            and connection nodes spent in each phase of the last move
+ *            generation.
+ * Arguments: none
+ * Fails:     if no move has been generated
+ * Returns:   Table of move generation phases.
+ */
+static int
+gtp_genmove_trace(char *s)
+{
+  const struct genmove_trace *trace = get_genmove_trace();
+  UNUSED(s);
+
+  if (!trace)
+    return gtp_failure("no move generated");
+
+  gtp_start_response(GTP_SUCCESS);
+  print_genmove_trace(gtp_output_file, trace);
+  gtp_printf("\n");
+  return GTP_OK;
+}
+
+
 /* Function:  Reset the count of trymoves/trykos.
  * Arguments: none
  * Fails:     never
@@ -4410,6 +4671,263 @@ rotate_on_output(int ai, int aj, int *bi, int *bj)
 }
 
 
+/**********************
+ * asynchronous input *
+ **********************/
+
+#ifdef HAVE_SELECT
+
+/* Commands are read from the input file descriptor whenever some
+ * input is available, also while a long command like genmove is
+ * executed, and are queued until the main loop asks for them. This
+ * lets the engine see an interrupt while it is busy, and ponder until
+ * the next command actually arrives. The stdio buffer of the input
+ * file is never used.
+ */
+
+#define GTP_INPUT_QUEUE_SIZE 16
+
+static FILE *async_input;
+static char input_buffer[GTP_BUFSIZE];
+static int input_length;
+static char input_queue[GTP_INPUT_QUEUE_SIZE][GTP_BUFSIZE];
+static int input_queue_start;
+static int input_queue_length;
+static int input_eof;
+
+
+static void
+reset_async_input(FILE *gtp_input)
+{
+  async_input = gtp_input;
+  input_length = 0;
+  input_queue_start = 0;
+  input_queue_length = 0;
+  input_eof = 0;
+}
+
+
+/* Following GoGui, a line "# interrupt" asks to interrupt the current
+ * command. It is dropped like any other comment when nothing runs.
+ */
+static int
+is_interrupt_line(const char *line)
+{
+  while (*line == ' ' || *line == '\t')
+    line++;
+  if (*line != '#')
+    return 0;
+  line++;
+  while (*line == ' ' || *line == '\t')
+    line++;
+  return strncmp(line, "interrupt", 9) == 0;
+}
+
+
+/* Move the complete lines of input_buffer to the queue, as far as
+ * there is room. A line which does not fit into the buffer is split,
+ * like fgets() does. Interrupt lines are taken out of the buffer also
+ * behind lines waiting for room in the queue, so that they reach a
+ * running command.
+ */
+static void
+queue_input_lines(void)
+{
+  static char line[GTP_BUFSIZE];
+  int offset = 0;
+
+  while (offset < input_length) {
+    char *next = input_buffer + offset;
+    char *end = memchr(next, '\n', input_length - offset);
+    int length;
+
+    if (end)
+      length = end - next + 1;
+    else if (input_length == GTP_BUFSIZE - 1 || input_eof)
+      length = input_length - offset;
+    else
+      return;
+
+    memcpy(line, next, length);
+    line[length] = 0;
+
+    if (is_interrupt_line(line)) {
+      if (gtp_command_running)
+	interrupt_search();
+    }
+    else if (offset == 0 && input_queue_length < GTP_INPUT_QUEUE_SIZE) {
+      strcpy(input_queue[(input_queue_start + input_queue_length)
+			 % GTP_INPUT_QUEUE_SIZE], line);
+      input_queue_length++;
+    }
+    else {
+      offset += length;
+      continue;
+    }
+
+    input_length -= length;
+    memmove(next, next + length, input_length - offset);
+  }
+}
+
+
+/* Read whatever input is available without blocking. Returns 1 if a
+ * command is waiting in the queue or the input has ended.
+ */
+static int
+poll_async_input(void)
+{
+  int fd = fileno(async_input);
+
+  /* Lines may have been left in the buffer when the queue was full. */
+  queue_input_lines();
+
+  while (!input_eof && input_length < GTP_BUFSIZE - 1) {
+    fd_set ready;
+    struct timeval timeout;
+    int n;
+
+    FD_ZERO(&ready);
+    FD_SET(fd, &ready);
+    timeout.tv_sec = 0;
+    timeout.tv_usec = 0;
+    if (select(fd + 1, &ready, NULL, NULL, &timeout) <= 0)
+      break;
+
+    n = read(fd, input_buffer + input_length,
+	     GTP_BUFSIZE - 1 - input_length);
+    if (n <= 0)
+      input_eof = 1;
+    else
+      input_length += n;
+    queue_input_lines();
+  }
+
+  return input_queue_length > 0 || input_eof;
+}
+
+
+/* Read hook: take the next command from the queue, waiting for it if
+ * necessary.
+ */
+static char *
+read_async_input(char *line, int size, FILE *gtp_input)
+{
+  UNUSED(gtp_input);
+
+  queue_input_lines();
+  while (input_queue_length == 0 && !input_eof) {
+    fd_set ready;
+    int fd = fileno(async_input);
+
+    FD_ZERO(&ready);
+    FD_SET(fd, &ready);
+    select(fd + 1, &ready, NULL, NULL, NULL);
+    poll_async_input();
+  }
+
+  if (input_queue_length == 0)
+    return NULL;
+
+  gg_assert(size >= GTP_BUFSIZE);
+  strcpy(line, input_queue[input_queue_start]);
+  input_queue_start = (input_queue_start + 1) % GTP_INPUT_QUEUE_SIZE;
+  input_queue_length--;
+
+  return line;
+}
+
+
+/* Idle hook: ponder until the next command arrives or there is
+ * nothing more to do.
+ */
+static void
+gtp_idle_ponder(FILE *gtp_input)
+{
+  UNUSED(gtp_input);
+  while (!poll_async_input() && ponder(poll_async_input))
+    ;
+}
+
+#endif
+
+
+/* Interrupt callback while a command runs. An interrupt line from
+ * the input is raised by queue_input_lines().
+ */
+static int
+gtp_poll_interrupt(void)
+{
+#ifdef HAVE_SELECT
+  poll_async_input();
+#endif
+  return interrupt_countdown > 0 && --interrupt_countdown == 0;
+}
+
+
+/* Out-of-band interrupt. SIGINT interrupts the current command, and
+ * only terminates the program as usual when no command runs.
+ */
+static void
+gtp_sigint_handler(int sig)
+{
+  if (gtp_command_running) {
+    interrupt_search();
+    signal(sig, gtp_sigint_handler);
+  }
+  else {
+    signal(sig, SIG_DFL);
+    raise(sig);
+  }
+}
+
+
+/* Arguments and result of the genmove job below. */
+struct gtp_genmove_data {
+  int color;
+  int conservative;
+  int move;
+  int resign;
+};
+
+static void
+gtp_genmove_job(void *data)
+{
+  struct gtp_genmove_data *d = data;
+  if (d->conservative)
+    d->move = genmove_conservative(d->color, NULL);
+  else
+    d->move = genmove(d->color, NULL, &d->resign);
+}
+
+
+/* Generate a move with genmove(), or genmove_conservative() if
+ * conservative is set, so that the client can interrupt it. Returns
+ * 0 if it was interrupted.
+ */
+static int
+interruptible_genmove(int color, int conservative, int *move, int *resign)
+{
+  struct gtp_genmove_data data;
+  int finished;
+
+  data.color = color;
+  data.conservative = conservative;
+  data.move = PASS_MOVE;
+  data.resign = 0;
+
+  gtp_command_running = 1;
+  finished = run_interruptible(gtp_genmove_job, &data, gtp_poll_interrupt);
+  gtp_command_running = 0;
+  interrupt_countdown = 0;
+
+  *move = data.move;
+  if (resign)
+    *resign = data.resign;
+  return finished;
+}
+
+
 /***************
  * random seed *
  ***************/
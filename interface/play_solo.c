@@ -28,6 +28,11 @@
 #include <string.h>
 #include <math.h>
 
+#ifdef HAVE_GETRUSAGE
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
 #include "interface.h"
 
 #include "liberty.h" /* to get to the stats */
@@ -315,6 +320,461 @@ load_and_score_sgf_file(SGFTree *tree, Gameinfo *gameinfo,
 }
 
 
+
+/* ================================================================ */
+
+
+/*
+ * Replay benchmark.
+ *
+ * Each line of the list file names an sgf file, relative to the
+ * directory of the list file, followed by the move numbers at which
+ * a move is generated:
+ *
+ *   ../games/9x9-1.sgf 10 20 30 40
+ *
+ * Lines starting with '#' are comments. Every position is loaded
+ * afresh and starts from a cleared reading cache and the same random
+ * seed (see reset_engine()), so the moves and node counts depend only
+ * on the engine and the list, while the times measure the machine.
+ *
+ * The results are written to stdout as JSON with one line per
+ * position. A result file saved from an earlier run can be given as
+ * baseline, and then the positions found in both are compared.
+ */
+
+#define MAX_BENCHMARK_POSITIONS 1000
+
+struct benchmark_position {
+  char game[80];
+  int move_number;
+  char color[8];
+  char move[8];
+  double cpu;
+  double wall;
+  int reading_nodes;
+  int owl_nodes;
+  int connection_nodes;
+};
+
+struct benchmark_summary {
+  int positions;
+  double cpu[5];	/* Total, median, 90%, 99% and maximum. */
+  double wall[5];
+  long reading_nodes;
+  long owl_nodes;
+  long connection_nodes;
+};
+
+#define BENCHMARK_POSITION_FORMAT \
+  "    {\"game\": \"%s\", \"move_number\": %d, \"color\": \"%s\", " \
+  "\"move\": \"%s\", \"cpu\": %.4f, \"wall\": %.4f, " \
+  "\"reading_nodes\": %d, \"owl_nodes\": %d, \"connection_nodes\": %d}"
+
+#define BENCHMARK_POSITION_SCAN_FORMAT \
+  " {\"game\": \"%79[^\"]\", \"move_number\": %d, \"color\": \"%7[^\"]\", " \
+  "\"move\": \"%7[^\"]\", \"cpu\": %lf, \"wall\": %lf, " \
+  "\"reading_nodes\": %d, \"owl_nodes\": %d, \"connection_nodes\": %d}"
+
+
+/* Generate a move before the given move number of the game. */
+static int
+run_benchmark_position(SGFTree *tree, const char *game, int move_number,
+		       struct benchmark_position *position)
+{
+  Gameinfo gameinfo;
+  char until[16];
+  int color;
+  int move;
+  float value;
+  double cpu;
+  double wall;
+
+  gameinfo_clear(&gameinfo);
+  gg_snprintf(until, sizeof(until), "%d", move_number);
+  color = gameinfo_play_sgftree(&gameinfo, tree, until);
+  if (color == EMPTY)
+    return 0;
+
+  reset_engine();
+  reset_owl_node_counter();
+  reset_connection_node_counter();
+
+  cpu = gg_cputime();
+  wall = gg_gettimeofday();
+  move = genmove(color, &value, NULL);
+  position->cpu = gg_cputime() - cpu;
+  position->wall = gg_gettimeofday() - wall;
+
+  gg_snprintf(position->game, sizeof(position->game), "%s", game);
+  position->move_number = move_number;
+  gg_snprintf(position->color, sizeof(position->color), "%s",
+	      color == WHITE ? "white" : "black");
+  location_to_buffer(move, position->move);
+  position->reading_nodes = stats.nodes;
+  position->owl_nodes = get_owl_node_counter();
+  position->connection_nodes = get_connection_node_counter();
+
+  return 1;
+}
+
+
+/* Run the positions of the list. Returns the number of positions, or
+ * -1 if the list cannot be read.
+ */
+static int
+run_benchmark_list(const char *list, struct benchmark_position *positions)
+{
+  FILE *listfile = fopen(list, "r");
+  const char *slash = strrchr(list, '/');
+  int dir_length = slash ? slash - list + 1 : 0;
+  char line[1024];
+  int num_positions = 0;
+
+  if (!listfile) {
+    fprintf(stderr, "Cannot open benchmark list %s\n", list);
+    return -1;
+  }
+
+  while (fgets(line, sizeof(line), listfile)) {
+    char game[80];
+    char filename[1024];
+    SGFTree tree;
+    char *numbers;
+    int offset;
+
+    if (line[0] == '#' || sscanf(line, "%79s%n", game, &offset) != 1)
+      continue;
+
+    if (game[0] == '/')
+      gg_snprintf(filename, sizeof(filename), "%s", game);
+    else
+      gg_snprintf(filename, sizeof(filename), "%.*s%s",
+		  dir_length, list, game);
+
+    sgftree_clear(&tree);
+    if (!sgftree_readfile(&tree, filename)) {
+      fprintf(stderr, "Cannot open or parse %s\n", filename);
+      continue;
+    }
+
+    numbers = line + offset;
+    while (num_positions < MAX_BENCHMARK_POSITIONS) {
+      struct benchmark_position *position = &positions[num_positions];
+      int move_number;
+      int length;
+
+      if (sscanf(numbers, "%d%n", &move_number, &length) != 1)
+	break;
+      numbers += length;
+
+      if (!run_benchmark_position(&tree, game, move_number, position)) {
+	fprintf(stderr, "Cannot load %s at move %d\n", game, move_number);
+	continue;
+      }
+      if (!quiet)
+	fprintf(stderr, "%s %d: %s %s %.3f s\n", game, move_number,
+		position->color, position->move, position->cpu);
+      num_positions++;
+    }
+
+    sgfFreeNode(tree.root);
+  }
+
+  fclose(listfile);
+  return num_positions;
+}
+
+
+static int
+compare_times(const void *a, const void *b)
+{
+  double ta = *(const double *) a;
+  double tb = *(const double *) b;
+
+  if (ta < tb)
+    return -1;
+  return ta > tb;
+}
+
+
+/* Total, median, 90th and 99th percentile, and maximum. */
+static void
+time_percentiles(double *times, int n, double *result)
+{
+  static const int percents[3] = {50, 90, 99};
+  int k;
+
+  result[0] = 0.0;
+  for (k = 0; k < n; k++)
+    result[0] += times[k];
+
+  qsort(times, n, sizeof(times[0]), compare_times);
+  for (k = 0; k < 3; k++) {
+    /* Nearest rank. */
+    int rank = (n * percents[k] + 99) / 100;
+    result[k + 1] = rank > 0 ? times[rank - 1] : 0.0;
+  }
+  result[4] = n > 0 ? times[n - 1] : 0.0;
+}
+
+
+static void
+summarize_benchmark(struct benchmark_position **positions, int n,
+		    struct benchmark_summary *summary)
+{
+  double *times = malloc((n + 1) * sizeof(*times));
+  int k;
+
+  memset(summary, 0, sizeof(*summary));
+  summary->positions = n;
+  if (!times)
+    return;
+
+  for (k = 0; k < n; k++) {
+    summary->reading_nodes += positions[k]->reading_nodes;
+    summary->owl_nodes += positions[k]->owl_nodes;
+    summary->connection_nodes += positions[k]->connection_nodes;
+    times[k] = positions[k]->cpu;
+  }
+  time_percentiles(times, n, summary->cpu);
+
+  for (k = 0; k < n; k++)
+    times[k] = positions[k]->wall;
+  time_percentiles(times, n, summary->wall);
+
+  free(times);
+}
+
+
+/* Read the positions of an earlier result. Returns the number of
+ * positions, or -1 if the file cannot be read.
+ */
+static int
+read_benchmark_baseline(const char *filename,
+			struct benchmark_position *positions, long *peak_rss)
+{
+  FILE *baseline = fopen(filename, "r");
+  char line[1024];
+  int num_positions = 0;
+
+  if (!baseline) {
+    fprintf(stderr, "Cannot open benchmark baseline %s\n", filename);
+    return -1;
+  }
+
+  *peak_rss = -1;
+  while (fgets(line, sizeof(line), baseline)
+	 && num_positions < MAX_BENCHMARK_POSITIONS) {
+    struct benchmark_position *p = &positions[num_positions];
+    if (sscanf(line, BENCHMARK_POSITION_SCAN_FORMAT, p->game,
+	       &p->move_number, p->color, p->move, &p->cpu, &p->wall,
+	       &p->reading_nodes, &p->owl_nodes, &p->connection_nodes) == 9)
+      num_positions++;
+    else
+      sscanf(line, " \"peak_rss_kb\": %ld", peak_rss);
+  }
+
+  fclose(baseline);
+  return num_positions;
+}
+
+
+static long
+peak_rss_kb(void)
+{
+#ifdef HAVE_GETRUSAGE
+  struct rusage usage;
+
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss;
+#endif
+  return -1;
+}
+
+
+static void
+print_benchmark_times(const char *name, double *times)
+{
+  printf("  \"%s\": {\"total\": %.4f, \"p50\": %.4f, \"p90\": %.4f, "
+	 "\"p99\": %.4f, \"max\": %.4f},\n",
+	 name, times[0], times[1], times[2], times[3], times[4]);
+}
+
+
+static void
+compare_benchmark_value(const char *name, double baseline, double current,
+			int last)
+{
+  double change = 0.0;
+
+  if (baseline > 0.0)
+    change = 100.0 * (current - baseline) / baseline;
+  if (fabs(change) < 0.05)
+    change = 0.0;
+
+  printf("    \"%s\": {\"baseline\": %.4f, \"current\": %.4f, "
+	 "\"change\": %.1f}%s\n", name, baseline, current, change,
+	 last ? "" : ",");
+  fprintf(stderr, "%-20s %12.3f %12.3f %+7.1f%%\n",
+	  name, baseline, current, change);
+}
+
+
+/* Compare the positions found in both the current run and the
+ * baseline.
+ */
+static void
+compare_benchmark(const char *filename,
+		  struct benchmark_position *positions, int num_positions,
+		  long peak_rss)
+{
+  struct benchmark_position *baseline;
+  struct benchmark_position **current_matched;
+  struct benchmark_position **baseline_matched;
+  struct benchmark_summary current_summary;
+  struct benchmark_summary baseline_summary;
+  long baseline_peak_rss;
+  int num_baseline;
+  int matched = 0;
+  int changed_moves = 0;
+  int k;
+  int l;
+
+  baseline = malloc(MAX_BENCHMARK_POSITIONS * sizeof(*baseline));
+  current_matched = malloc((num_positions + 1) * sizeof(*current_matched));
+  baseline_matched = malloc((num_positions + 1) * sizeof(*baseline_matched));
+  if (!baseline || !current_matched || !baseline_matched)
+    num_baseline = -1;
+  else
+    num_baseline = read_benchmark_baseline(filename, baseline,
+					   &baseline_peak_rss);
+
+  if (num_baseline >= 0) {
+    for (k = 0; k < num_positions; k++)
+      for (l = 0; l < num_baseline; l++)
+	if (positions[k].move_number == baseline[l].move_number
+	    && strcmp(positions[k].game, baseline[l].game) == 0) {
+	  current_matched[matched] = &positions[k];
+	  baseline_matched[matched] = &baseline[l];
+	  matched++;
+	  if (strcmp(positions[k].move, baseline[l].move) != 0) {
+	    changed_moves++;
+	    fprintf(stderr, "%s %d: %s, baseline %s\n", positions[k].game,
+		    positions[k].move_number, positions[k].move,
+		    baseline[l].move);
+	  }
+	  break;
+	}
+
+    summarize_benchmark(current_matched, matched, &current_summary);
+    summarize_benchmark(baseline_matched, matched, &baseline_summary);
+
+    printf(",\n  \"comparison\": {\n");
+    printf("    \"baseline\": \"%s\",\n", filename);
+    printf("    \"positions\": %d,\n", matched);
+    printf("    \"changed_moves\": %d,\n", changed_moves);
+    fprintf(stderr, "%d positions compared, %d moves changed\n",
+	    matched, changed_moves);
+    fprintf(stderr, "%-20s %12s %12s %8s\n",
+	    "", "baseline", "current", "change");
+    compare_benchmark_value("cpu_total", baseline_summary.cpu[0],
+			    current_summary.cpu[0], 0);
+    compare_benchmark_value("cpu_p50", baseline_summary.cpu[1],
+			    current_summary.cpu[1], 0);
+    compare_benchmark_value("cpu_p90", baseline_summary.cpu[2],
+			    current_summary.cpu[2], 0);
+    compare_benchmark_value("cpu_p99", baseline_summary.cpu[3],
+			    current_summary.cpu[3], 0);
+    compare_benchmark_value("cpu_max", baseline_summary.cpu[4],
+			    current_summary.cpu[4], 0);
+    compare_benchmark_value("wall_total", baseline_summary.wall[0],
+			    current_summary.wall[0], 0);
+    compare_benchmark_value("reading_nodes", baseline_summary.reading_nodes,
+			    current_summary.reading_nodes, 0);
+    compare_benchmark_value("owl_nodes", baseline_summary.owl_nodes,
+			    current_summary.owl_nodes, 0);
+    compare_benchmark_value("connection_nodes",
+			    baseline_summary.connection_nodes,
+			    current_summary.connection_nodes, 0);
+    compare_benchmark_value("peak_rss_kb", baseline_peak_rss, peak_rss, 1);
+    printf("  }");
+  }
+
+  free(baseline);
+  free(current_matched);
+  free(baseline_matched);
+}
+
+
+/* Run the replay benchmark on the positions of the list file and
+ * write the results as JSON to stdout. If baseline_file is not NULL,
+ * compare with the results in that file.
+ */
+void
+play_benchmark(const char *list, const char *baseline_file)
+{
+  struct benchmark_position *positions;
+  struct benchmark_position **all;
+  struct benchmark_summary summary;
+  int num_positions;
+  long peak_rss;
+  int k;
+
+  positions = malloc(MAX_BENCHMARK_POSITIONS * sizeof(*positions));
+  all = malloc(MAX_BENCHMARK_POSITIONS * sizeof(*all));
+  if (!positions || !all) {
+    fprintf(stderr, "play_benchmark: out of memory\n");
+    free(positions);
+    free(all);
+    return;
+  }
+
+  num_positions = run_benchmark_list(list, positions);
+  if (num_positions < 0) {
+    free(positions);
+    free(all);
+    return;
+  }
+
+  for (k = 0; k < num_positions; k++)
+    all[k] = &positions[k];
+  summarize_benchmark(all, num_positions, &summary);
+  peak_rss = peak_rss_kb();
+
+  printf("{\n");
+  printf("  \"version\": \"%s\",\n", VERSION);
+  printf("  \"level\": %d,\n", get_level());
+  printf("  \"seed\": %u,\n", get_random_seed());
+  printf("  \"positions\": %d,\n", num_positions);
+  print_benchmark_times("cpu", summary.cpu);
+  print_benchmark_times("wall", summary.wall);
+  printf("  \"reading_nodes\": %ld,\n", summary.reading_nodes);
+  printf("  \"owl_nodes\": %ld,\n", summary.owl_nodes);
+  printf("  \"connection_nodes\": %ld,\n", summary.connection_nodes);
+#ifdef CONFIG_FIXED_MEMORY
+  printf("  \"pool_peak_bytes\": %lu,\n", (unsigned long) mempool_peak());
+#endif
+  printf("  \"peak_rss_kb\": %ld,\n", peak_rss);
+  printf("  \"moves\": [\n");
+  for (k = 0; k < num_positions; k++) {
+    struct benchmark_position *p = &positions[k];
+    printf(BENCHMARK_POSITION_FORMAT "%s\n", p->game, p->move_number,
+	   p->color, p->move, p->cpu, p->wall, p->reading_nodes,
+	   p->owl_nodes, p->connection_nodes,
+	   k < num_positions - 1 ? "," : "");
+  }
+  printf("  ]");
+
+  if (baseline_file)
+    compare_benchmark(baseline_file, positions, num_positions, peak_rss);
+  printf("\n}\n");
+
+  free(positions);
+  free(all);
+}
+
+
 /*
  * Local Variables:
  * tab-width: 8
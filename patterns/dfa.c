@@ -29,6 +29,7 @@
 #include "patterns.h"
 #include "dfa-mkpat.h"
 #include "random.h"
+#include "gg_utils.h"
 
 #include <assert.h>
 #include <stdlib.h>
@@ -158,15 +159,20 @@ compactify_att(dfa_t *pdfa)
   int k;
   int last = 0;
   int save_last = pdfa->last_index;
+  int max_val = save_last;
   int *map;
   int *search_first;
   int *search_next;
   int size = (save_last + 1) * sizeof(int);
 
+  /* Attribute values of joint dfas may exceed the number of entries. */
+  for (k = 1; k <= save_last; k++)
+    if (max_val < pdfa->indexes[k].val)
+      max_val = pdfa->indexes[k].val;
+
   map = malloc(size);
   map[0] = 0;
-  search_first = malloc(size);
-  memset(search_first, 0, size);
+  search_first = calloc(max_val + 1, sizeof(int));
   search_next = malloc(size);
   memset(search_next, 0, size);
 
@@ -383,10 +389,10 @@ copy_dfa(dfa_t *p_to, dfa_t *p_from)
 {
   assert(p_to != p_from);
 
-  if (p_to->max_states < p_from->last_state)
+  if (p_to->max_states <= p_from->last_state)
     resize_dfa(p_to, p_from->max_states, p_to->max_indexes);
 
-  if (p_to->max_indexes < p_from->last_index)
+  if (p_to->max_indexes <= p_from->last_index)
     resize_dfa(p_to, p_to->max_states, p_from->max_indexes);
 
   clean_dfa(p_to);
@@ -401,6 +407,108 @@ copy_dfa(dfa_t *p_to, dfa_t *p_from)
 }
 
 
+/*
+ * Save a dfa in a simple text format which can be read back by
+ * load_dfa().
+ */
+
+void
+save_dfa(const char *f_name, dfa_t *pdfa)
+{
+  int i;
+  FILE *f = fopen(f_name, "w");
+
+  if (f == NULL) {
+    fprintf(stderr, "Error: Cannot write to file %s\n", f_name);
+    exit(EXIT_FAILURE);
+  }
+
+  fprintf(f, "dfa %s\n", pdfa->name);
+  fprintf(f, "%d %d\n", pdfa->last_state, pdfa->last_index);
+  for (i = 0; i <= pdfa->last_state; i++)
+    fprintf(f, "%d %d %d %d %d\n", pdfa->states[i].att,
+	    pdfa->states[i].next[0], pdfa->states[i].next[1],
+	    pdfa->states[i].next[2], pdfa->states[i].next[3]);
+  for (i = 0; i <= pdfa->last_index; i++)
+    fprintf(f, "%d %d\n", pdfa->indexes[i].val, pdfa->indexes[i].next);
+
+  fclose(f);
+}
+
+
+/*
+ * Load a dfa written by save_dfa() from file `f_name' in directory
+ * `f_path' (which may be NULL).  If *ppdfa is NULL a new dfa is
+ * allocated.  Returns the dfa or NULL if the file could not be read.
+ */
+
+dfa_t *
+load_dfa(const char *f_path, const char *f_name, dfa_t **ppdfa)
+{
+  char path[1024];
+  char name[sizeof((*ppdfa)->name)];
+  int last_state, last_index;
+  int i;
+  FILE *f;
+
+  if (f_path != NULL)
+    gg_snprintf(path, sizeof(path), "%s/%s", f_path, f_name);
+  else
+    gg_snprintf(path, sizeof(path), "%s", f_name);
+
+  f = fopen(path, "r");
+  if (f == NULL)
+    return NULL;
+
+  if (fscanf(f, "dfa %14s", name) != 1
+      || fscanf(f, "%d %d", &last_state, &last_index) != 2
+      || last_state < 1 || last_index < 0) {
+    fclose(f);
+    return NULL;
+  }
+
+  if (*ppdfa == NULL) {
+    *ppdfa = malloc(sizeof(dfa_t));
+    if (*ppdfa == NULL) {
+      fclose(f);
+      return NULL;
+    }
+    new_dfa(*ppdfa, name);
+  }
+  else
+    strcpy((*ppdfa)->name, name);
+
+  if ((*ppdfa)->max_states <= last_state
+      || (*ppdfa)->max_indexes <= last_index)
+    resize_dfa(*ppdfa, gg_max((*ppdfa)->max_states, last_state + 1),
+	       gg_max((*ppdfa)->max_indexes, last_index + 1));
+  clean_dfa(*ppdfa);
+
+  for (i = 0; i <= last_state; i++) {
+    state_t *state = &(*ppdfa)->states[i];
+    if (fscanf(f, "%d %d %d %d %d", &state->att, &state->next[0],
+	       &state->next[1], &state->next[2], &state->next[3]) != 5)
+      break;
+  }
+  if (i == last_state + 1) {
+    for (i = 0; i <= last_index; i++) {
+      attrib_t *index = &(*ppdfa)->indexes[i];
+      if (fscanf(f, "%d %d", &index->val, &index->next) != 2)
+	break;
+    }
+  }
+  fclose(f);
+
+  if (i != last_index + 1)
+    return NULL;
+
+  (*ppdfa)->last_state = last_state;
+  (*ppdfa)->last_index = last_index;
+
+  return *ppdfa;
+}
+
+
 /*
  * print c dfa:
  * print the dfa in c format.
@@ -450,7 +558,7 @@ print_c_dfa(FILE *of, const char *name, dfa_t *pdfa)
   fprintf(of, "};\n\n");
 
 
-  fprintf(of, "static const attrib_rt_t idx_%s[%d] = {\n",
+  fprintf(of, "static const attrib_rt_t _EMBEDDED_HOT_CONST idx_%s[%d] = {\n",
 	  name, pdfa->last_index + 1);
   for (i = 0; i != pdfa->last_index + 1; i++)
     fprintf(of, "{%d,%d},%s", pdfa->indexes[i].val, pdfa->indexes[i].next,
@@ -969,6 +1077,31 @@ dfa_finalize(dfa_t *pdfa)
   compactify_att(pdfa);
 }
 
+/*
+ * Add the patterns recognized by `pdfa' to the joint dfa `pjoint'.
+ * The attributes of `pdfa' are tagged with the database number `db'
+ * (see DFA_JOINT_VAL() in dfa.h), so that a single scan with the
+ * joint dfa tells which database each matched pattern belongs to.
+ */
+void
+dfa_join(dfa_t *pjoint, dfa_t *pdfa, int db)
+{
+  int k;
+
+  assert(dfa_was_initialized > 0);
+  assert(db >= 0 && db < DFA_MAX_JOINT);
+
+  for (k = 1; k <= pdfa->last_index; k++) {
+    assert(pdfa->indexes[k].val >= 0
+	   && pdfa->indexes[k].val < (1 << DFA_JOINT_SHIFT));
+    pdfa->indexes[k].val = DFA_JOINT_VAL(db, pdfa->indexes[k].val);
+  }
+
+  sync_product(&aux_temp, pjoint, pdfa);
+  copy_dfa(pjoint, &aux_temp);
+  compactify_att(pjoint);
+}
+
 /*
  * Add a new string with attribute att_val into the dfa.
  * if the new size of the dfa respect some size conditions
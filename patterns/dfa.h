@@ -46,6 +46,16 @@
 /* Maximum pattern matched at one positions. */
 #define DFA_MAX_MATCHED		(8 * 24)
 
+/* A joint DFA recognizes the patterns of several databases at once.
+ * Its attribute values carry the number of the database in the high
+ * bits and the pattern index in the low bits.
+ */
+#define DFA_JOINT_SHIFT		12
+#define DFA_MAX_JOINT		(1 << (15 - DFA_JOINT_SHIFT))
+#define DFA_JOINT_VAL(db, index) (((db) << DFA_JOINT_SHIFT) | (index))
+#define DFA_JOINT_DB(val)	((val) >> DFA_JOINT_SHIFT)
+#define DFA_JOINT_INDEX(val)	((val) & ((1 << DFA_JOINT_SHIFT) - 1))
+
 
 /* DFA spiral order. */
 extern int spiral[DFA_MAX_ORDER][8];
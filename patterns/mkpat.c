@@ -50,6 +50,9 @@ Usage : mkpat [options] <prefix>\n\
 	-i = one or more input files (typically *.db)\n\
 	-o = output file (typically *.c)\n\
 	-t = DFA transformations file (typically *.dtr)\n\
+	-s = also save the DFA to a file (typically *.dfa), see -J\n\
+	-B = also write the database in binary form (typically *.gpd),\n\
+	     which can be loaded at run time with --load-patterns\n\
 	-v = verbose\n\
 	-V <level> = DFA verbiage level\n\
   Database type:\n\
@@ -57,6 +60,8 @@ Usage : mkpat [options] <prefix>\n\
 	-c = compile connections database\n\
 	-C = compile a corner pattern database\n\
 	-D = compile a DFA database (allows fast matching)\n\
+	-J = join DFAs saved with -s into one DFA, which matches all\n\
+	     the databases in a single scan (input files are *.dfa)\n\
 	-d <iterations> = don't generate database, but optimize a DFA\n\
 			  transformation file instead\n\
   Pattern generation options:\n\
@@ -87,12 +92,14 @@ If output file is not specified, writes to stdout.\n\
 #include "gg_utils.h"
 
 #include "dfa-mkpat.h"
+#include "patfile.h"
 
 
 #define DB_GENERAL	((int) 'p')
 #define DB_CONNECTIONS	((int) 'c')
 #define DB_CORNER	((int) 'C')
 #define DB_DFA		((int) 'D')
+#define DB_JOINT	((int) 'J')
 #define OPTIMIZE_DFA	((int) 'd')
 
 /* code assumes that ATT_O and ATT_X are 1 and 2 (in either order)
@@ -176,6 +183,14 @@ static char helper_fn_names[MAXPATNO][MAXNAME]; /* helper fn names here */
 static char autohelper_code[MAXPATNO*300]; /* code for automatically generated */
 					   /* helper functions here */
 static char *code_pos;              /* current position in code buffer */
+
+/* Pattern elements collected for the binary database (-B). */
+static int binary_output = 0;
+static struct patfile_patval *binary_patvals = NULL;
+static int binary_num_patvals = 0;
+static int binary_max_patvals = 0;
+static int binary_patn[MAXPATNO];
+
 struct autohelper_func {
   const char *name;
   int params;
@@ -1764,6 +1779,27 @@ struct element_node {
   struct element_node *next;
 };
 
+
+/* Store an element of the current pattern for the binary database. */
+static void
+binary_add_patval(int offset, int att)
+{
+  if (binary_num_patvals == binary_max_patvals) {
+    binary_max_patvals = binary_max_patvals ? 2 * binary_max_patvals : 4096;
+    binary_patvals = realloc(binary_patvals,
+			     binary_max_patvals * sizeof(*binary_patvals));
+    if (!binary_patvals) {
+      fprintf(stderr, "Error : Out of memory\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  binary_patvals[binary_num_patvals].offset = offset;
+  binary_patvals[binary_num_patvals].att = att;
+  binary_patvals[binary_num_patvals].pad = 0;
+  binary_num_patvals++;
+}
+
 /* flush out the pattern stored in elements[]. Don't forget
  * that elements[].{x,y} and min/max{i,j} are still relative
  * to the top-left corner of the original ascii pattern, and
@@ -1783,6 +1819,7 @@ write_elements(FILE *outfile)
   gg_sort(elements, el, sizeof(struct patval_b), compare_elements);
 
   fprintf(outfile, "static " _CONST_DECLS " struct patval %s%d[] = {", prefix, patno);
+  binary_patn[patno] = binary_num_patvals;
 
   for (node = 0; node < el; node++) {
     int x = elements[node].x;
@@ -1837,13 +1874,18 @@ write_elements(FILE *outfile)
 
     TRANSFORM2(x - ci, y - cj, &dx, &dy, transformation_hint);
     fprintf(outfile, "{%d,%d}", OFFSET(dx, dy), att);
+    if (binary_output)
+      binary_add_patval(OFFSET(dx, dy), att);
   }
 
   /* This may happen if we have discarded all
    * the elements as unneeded by the matcher.
    */
-  if (!used_nodes)
+  if (!used_nodes) {
     fprintf(outfile, "{0,-1}}; /* Dummy element, not used. */\n\n");
+    if (binary_output)
+      binary_add_patval(0, -1);
+  }
   else
     fprintf(outfile, "\n};\n\n");
 
@@ -2214,6 +2256,37 @@ corner_write_variations(struct corner_variation_b *variation, FILE *outfile)
 
 
 
+/* Signature of the autohelper code and the helper functions of the
+ * database, stored in the pattern_db and in the binary database. This
+ * is the 32 bit FNV-1a hash of the code and of the helper names.
+ */
+static unsigned int
+hash_string(unsigned int hash, const char *s)
+{
+  for (; *s; s++) {
+    hash ^= (unsigned char) *s;
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+static unsigned int
+helper_signature(void)
+{
+  unsigned int signature = hash_string(2166136261U, autohelper_code);
+  char buf[MAXNAME + 16];
+  int j;
+
+  for (j = 0; j < patno; j++)
+    if (strcmp(helper_fn_names[j], "NULL") != 0) {
+      sprintf(buf, "%d %s", j, helper_fn_names[j]);
+      signature = hash_string(signature, buf);
+    }
+
+  return signature;
+}
+
+
 static void
 write_attributes(FILE *outfile)
 {
@@ -2447,11 +2520,250 @@ write_pattern_db(FILE *outfile)
     fprintf(outfile, " ,& dfa_%s\n", prefix); /* pointer to the wired dfa */
   else
     fprintf(outfile, " , NULL\n"); /* pointer to a possible dfa */
+  fprintf(outfile, " , 0x%08x\n", helper_signature());
 
   fprintf(outfile, "};\n");
 }
 
 
+/* Pad a section of `size' bytes in the binary database. */
+static void
+binary_pad(FILE *outfile, int size)
+{
+  static const char zeros[4] = {0, 0, 0, 0};
+  fwrite(zeros, 1, PATFILE_ALIGN(size) - size, outfile);
+}
+
+/* Write out the pattern database in the binary format described in
+ * patfile.h. `pdfa' is the DFA of the database, or NULL.
+ */
+static void
+write_binary_db(FILE *outfile, dfa_t *pdfa)
+{
+  struct patfile_header header;
+  int names_size = 0;
+  unsigned int offset;
+  int j, k;
+
+  memset(&header, 0, sizeof(header));
+  header.magic = PATFILE_MAGIC;
+  header.version = PATFILE_VERSION;
+  strncpy(header.name, prefix, PATFILE_NAME_LENGTH - 1);
+  header.helper_signature = helper_signature();
+#if GRID_OPT
+  header.flags |= PATFILE_GRID_OPT;
+#endif
+  header.max_board = MAX_BOARD;
+#ifdef FIXED_BOARD_SIZE
+  header.fixed_for_size = FIXED_BOARD_SIZE;
+#else
+  header.fixed_for_size = -1;
+#endif
+  header.fixed_anchor = fixed_anchor;
+
+  header.num_patterns = patno;
+  header.num_patvals = binary_num_patvals;
+  header.num_attributes = attributes_needed ? num_attributes : 0;
+  if (pdfa) {
+    header.num_states = pdfa->last_state + 1;
+    header.num_indexes = pdfa->last_index + 1;
+  }
+  for (j = 0; j < patno; j++)
+    names_size += strlen(pattern_names[j]) + 1;
+  header.names_size = names_size;
+
+  offset = PATFILE_ALIGN(sizeof(header));
+  header.patterns_offset = offset;
+  offset += patno * sizeof(struct patfile_pattern);
+  header.patvals_offset = offset;
+  offset += binary_num_patvals * sizeof(struct patfile_patval);
+  header.attributes_offset = offset;
+  offset += header.num_attributes * sizeof(struct patfile_attribute);
+  header.states_offset = offset;
+  offset += PATFILE_ALIGN(header.num_states * PATFILE_STATE_SIZE);
+  header.indexes_offset = offset;
+  offset += header.num_indexes * PATFILE_INDEX_SIZE;
+  header.names_offset = offset;
+  offset += PATFILE_ALIGN(names_size);
+  header.chunk_size = offset;
+
+  fwrite(&header, sizeof(header), 1, outfile);
+  binary_pad(outfile, sizeof(header));
+
+  names_size = 0;
+  for (j = 0; j < patno; j++) {
+    struct pattern *p = pattern + j;
+    struct patfile_pattern rec;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.patn = binary_patn[j];
+    rec.patlen = p->patlen;
+    rec.trfno = p->trfno;
+    rec.name = names_size;
+    names_size += strlen(pattern_names[j]) + 1;
+    rec.mini = p->mini;
+    rec.minj = p->minj;
+    rec.maxi = p->maxi;
+    rec.maxj = p->maxj;
+    rec.height = p->maxi - p->mini;
+    rec.width = p->maxj - p->minj;
+    rec.edge_constraints = p->edge_constraints;
+    rec.move_offset = p->move_offset;
+#if GRID_OPT
+    for (k = 0; k < 8; k++) {
+      rec.and_mask[k] = p->and_mask[k];
+      rec.val_mask[k] = p->val_mask[k];
+    }
+#endif
+    rec.class = p->class;
+    rec.value = p->value;
+    if (attributes_needed)
+      rec.attributes = p->attributes ? p->attributes - attributes : 0;
+    else
+      rec.attributes = -1;
+    rec.autohelper_flag = p->autohelper_flag;
+    if (p->autohelper || strcmp(helper_fn_names[j], "NULL") != 0)
+      rec.helper = j;
+    else
+      rec.helper = -1;
+    rec.anchored_at_X = p->anchored_at_X;
+    rec.constraint_cost = p->constraint_cost;
+
+    fwrite(&rec, sizeof(rec), 1, outfile);
+  }
+
+  fwrite(binary_patvals, sizeof(struct patfile_patval), binary_num_patvals,
+	 outfile);
+
+  for (k = 0; k < header.num_attributes; k++) {
+    struct patfile_attribute rec;
+
+    rec.type = attributes[k].type;
+    rec.value = attributes[k].value;
+    rec.offset = attributes[k].offset;
+    fwrite(&rec, sizeof(rec), 1, outfile);
+  }
+
+  /* The DFA, converted to the run time format like in print_c_dfa(). */
+  assert(sizeof(state_rt_t) == PATFILE_STATE_SIZE);
+  assert(sizeof(attrib_rt_t) == PATFILE_INDEX_SIZE);
+  for (j = 0; j < header.num_states; j++) {
+    state_rt_t state;
+
+    for (k = 0; k < 4; k++) {
+      int n = pdfa->states[j].next[k];
+      state.next[k] = n ? n - j : 0;
+    }
+    state.att = pdfa->states[j].att;
+    fwrite(&state, sizeof(state), 1, outfile);
+  }
+  binary_pad(outfile, header.num_states * PATFILE_STATE_SIZE);
+
+  for (j = 0; j < header.num_indexes; j++) {
+    attrib_rt_t index;
+
+    index.val = pdfa->indexes[j].val;
+    index.next = pdfa->indexes[j].next;
+    fwrite(&index, sizeof(index), 1, outfile);
+  }
+
+  for (j = 0; j < patno; j++)
+    fwrite(pattern_names[j], 1, strlen(pattern_names[j]) + 1, outfile);
+  binary_pad(outfile, names_size);
+}
+
+
+/* Join the DFAs saved by `mkpat -D -s' into a single DFA and write
+ * out a joint_pattern_db referring to the original databases. The
+ * n:th input file becomes database number n of the joint DFA.
+ *
+ * If an input file is missing (databases compiled without DFA), the
+ * database name is taken from the file name and no joint DFA is
+ * written. matchpat_joint() then matches the databases one by one.
+ */
+static int
+write_joint_dfa(FILE *outfile, int num_files, char *file_names[])
+{
+  dfa_t joint;
+  dfa_t *pdfa = NULL;
+  char db_names[MAX_JOINT_DBS][MAXNAME];
+  int have_dfa = 1;
+  int k;
+
+  if (num_files > MAX_JOINT_DBS || num_files > DFA_MAX_JOINT) {
+    fprintf(stderr, "Error : Too many databases to join (maximum %d)\n",
+	    gg_min(MAX_JOINT_DBS, DFA_MAX_JOINT));
+    return 1;
+  }
+
+  dfa_init();
+  new_dfa(&joint, "joint dfa");
+
+  for (k = 0; k < num_files; k++) {
+    if (have_dfa && load_dfa(NULL, file_names[k], &pdfa) != NULL) {
+      strcpy(db_names[k], pdfa->name);
+      dfa_join(&joint, pdfa, k);
+    }
+    else {
+      const char *base = strrchr(file_names[k], '/');
+      char *dot;
+
+      base = base ? base + 1 : file_names[k];
+      strncpy(db_names[k], base, MAXNAME - 1);
+      db_names[k][MAXNAME - 1] = 0;
+      dot = strrchr(db_names[k], '.');
+      if (dot)
+	*dot = 0;
+
+      if (have_dfa)
+	fprintf(stderr, "Warning : Cannot read DFA from file %s, joint DFA disabled\n",
+		file_names[k]);
+      have_dfa = 0;
+    }
+  }
+
+  if (pdfa) {
+    kill_dfa(pdfa);
+    free(pdfa);
+  }
+
+  if (have_dfa) {
+    fprintf(stderr, "---------------------------\n");
+
+    dfa_shuffle(&joint);
+
+    fprintf(stderr, "joint DFA for %s\n", prefix);
+    fprintf(stderr, "size: %d kB for %d databases", dfa_size(&joint),
+	    num_files);
+    fprintf(stderr, " (%d states)\n", joint.last_state);
+
+    print_c_dfa(outfile, prefix, &joint);
+    fprintf(stderr, "---------------------------\n");
+
+    if (DFA_MAX_MATCHED/8 < dfa_calculate_max_matched_patterns(&joint))
+      fprintf(stderr, "Warning: Increase DFA_MAX_MATCHED in 'dfa.h'.\n");
+  }
+
+  fprintf(outfile, "\n");
+  fprintf(outfile, "struct joint_pattern_db %s_db = {\n", prefix);
+  fprintf(outfile, "  %d,\n", num_files);
+  fprintf(outfile, "  {");
+  for (k = 0; k < num_files; k++)
+    fprintf(outfile, "%s&%s_db", k ? ", " : "", db_names[k]);
+  fprintf(outfile, "},\n");
+  if (have_dfa)
+    fprintf(outfile, "  & dfa_%s\n", prefix);
+  else
+    fprintf(outfile, "  NULL\n");
+  fprintf(outfile, "};\n");
+
+  kill_dfa(&joint);
+  dfa_end();
+
+  return 0;
+}
+
+
 int
 main(int argc, char *argv[])
 {
@@ -2461,7 +2773,10 @@ main(int argc, char *argv[])
   char *input_file_names[MAX_INPUT_FILE_NAMES];
   char *output_file_name = NULL;
   char *transformations_file_name = NULL;
+  char *dfa_file_name = NULL;
+  char *binary_file_name = NULL;
   FILE *input_FILE = stdin;
+  FILE *binary_FILE = NULL;
   FILE *output_FILE = stdout;
   FILE *transformations_FILE = NULL;
   int state = 0;
@@ -2475,7 +2790,7 @@ main(int argc, char *argv[])
     int multiple_anchor_options = 0;
 
     /* Parse command-line options */
-    while ((i = gg_getopt(argc, argv, "i:o:t:vV:pcfCDd:A:OXbma")) != EOF) {
+    while ((i = gg_getopt(argc, argv, "i:o:t:s:B:vV:pcfCDJd:A:OXbma")) != EOF) {
       switch (i) {
       case 'i': 
 	if (input_files == MAX_INPUT_FILE_NAMES) {
@@ -2488,6 +2803,8 @@ main(int argc, char *argv[])
 
       case 'o': output_file_name = gg_optarg; break;
       case 't': transformations_file_name = gg_optarg; break;
+      case 's': dfa_file_name = gg_optarg; break;
+      case 'B': binary_file_name = gg_optarg; break;
       case 'v': verbose = 1; break;
       case 'V': dfa_verbose = strtol(gg_optarg, NULL, 10); break;
 
@@ -2496,6 +2813,7 @@ main(int argc, char *argv[])
       case 'f':
       case 'C':
       case 'D':
+      case 'J':
       case 'd':
 	if (database_type) {
 	  fprintf(stderr, "Error : More than one database type specified (-%c and -%c)\n",
@@ -2558,6 +2876,19 @@ main(int argc, char *argv[])
 	return 1;
       }
     }
+    if (binary_file_name) {
+      if (database_type == DB_GENERAL || database_type == DB_CONNECTIONS
+	  || database_type == DB_DFA) {
+	binary_FILE = fopen(binary_file_name, "wb");
+	if (binary_FILE == NULL) {
+	  fprintf(stderr, "Error : Cannot write to file %s\n", binary_file_name);
+	  return 1;
+	}
+	binary_output = 1;
+      }
+      else
+	fprintf(stderr, "Warning : -B is not supported for this database type\n");
+    }
     if (transformations_file_name
 	&& (database_type == DB_DFA || database_type == OPTIMIZE_DFA)) {
       transformations_FILE = fopen(transformations_file_name, "r");
@@ -2583,6 +2914,11 @@ main(int argc, char *argv[])
 
   prefix = argv[gg_optind];
 
+  if (database_type == DB_JOINT) {
+    fprintf(output_FILE, PREAMBLE);
+    return write_joint_dfa(output_FILE, input_files, input_file_names);
+  }
+
   if (database_type == DB_DFA) {
     dfa_init();
     new_dfa(&dfa, "mkpat's dfa");
@@ -3005,13 +3341,12 @@ main(int argc, char *argv[])
 
       strcpy(dfa.name, prefix);
       print_c_dfa(output_FILE, prefix, &dfa);
+      if (dfa_file_name)
+	save_dfa(dfa_file_name, &dfa);
       fprintf(stderr, "---------------------------\n");
 
       if (DFA_MAX_MATCHED/8 < dfa_calculate_max_matched_patterns(&dfa))
         fprintf(stderr, "Warning: Increase DFA_MAX_MATCHED in 'dfa.h'.\n");
-
-      kill_dfa(&dfa);
-      dfa_end();
     }
 
     if (database_type == DB_CORNER) {
@@ -3030,6 +3365,16 @@ main(int argc, char *argv[])
 
     write_pattern_db(output_FILE);
 
+    if (binary_FILE) {
+      write_binary_db(binary_FILE, database_type == DB_DFA ? &dfa : NULL);
+      fclose(binary_FILE);
+    }
+
+    if (database_type == DB_DFA) {
+      kill_dfa(&dfa);
+      dfa_end();
+    }
+
     if (fatal_errors) {
       fprintf(output_FILE, "\n#error: One or more fatal errors compiling %s\n",
 	      current_file);
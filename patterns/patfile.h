@@ -0,0 +1,127 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ * This is GNU Go, a Go program. Contact gnugo@gnu.org, or see       *
+ * http://www.gnu.org/software/gnugo/ for more information.          *
+ *                                                                   *
+ * Copyright 1999, 2000, 2001, 2002, 2003, 2004, 2005, 2006, 2007,   *
+ * 2008 and 2009  by the Free Software Foundation.                   *
+ *                                                                   *
+ * This program is free software; you can redistribute it and/or     *
+ * modify it under the terms of the GNU General Public License as    *
+ * published by the Free Software Foundation - version 3 or          *
+ * (at your option) any later version.                               *
+ *                                                                   *
+ * This program is distributed in the hope that it will be useful,   *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of    *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the     *
+ * GNU General Public License in file COPYING for more details.      *
+ *                                                                   *
+ * You should have received a copy of the GNU General Public         *
+ * License along with this program; if not, write to the Free        *
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,       *
+ * Boston, MA 02111, USA.                                            *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Binary pattern database format, written by `mkpat -B' and read by
+ * load_pattern_image() in engine/patfile.c.
+ *
+ * A pattern file is a sequence of chunks, one per database, so that
+ * the files of several databases can simply be concatenated. Each
+ * chunk starts with a patfile_header, followed by the sections listed
+ * in the header. All offsets are relative to the start of the chunk
+ * and all sections are aligned to 4 bytes, so that a chunk can be
+ * used in place wherever it is mapped into memory.
+ *
+ * Numbers are stored in the byte order of the machine that ran mkpat.
+ * A file with the other byte order is recognized by its magic number
+ * and rejected.
+ *
+ * The autohelper and helper functions cannot be stored in the file.
+ * The patterns refer to them by index into the compiled in copy of
+ * the same database, and the helper signature makes sure that the
+ * compiled in functions are those the file was generated with.
+ */
+
+#ifndef _PATFILE_H_
+#define _PATFILE_H_
+
+#define PATFILE_MAGIC		0x44504747	/* "GGPD" little endian */
+#define PATFILE_MAGIC_SWAPPED	0x47475044
+#define PATFILE_VERSION		1
+#define PATFILE_NAME_LENGTH	16
+
+/* Flags describing the build the file was generated for. */
+#define PATFILE_GRID_OPT	1
+
+#define PATFILE_ALIGN(size)	(((size) + 3) & ~3)
+
+struct patfile_header {
+  unsigned int magic;
+  unsigned int version;
+  unsigned int chunk_size;	/* Total size of the chunk, header included. */
+  char name[PATFILE_NAME_LENGTH]; /* Database prefix, e.g. "owl_attackpat". */
+  unsigned int helper_signature;
+  unsigned int flags;
+  int max_board;		/* MAX_BOARD the offsets are computed for. */
+  int fixed_for_size;
+  int fixed_anchor;
+
+  int num_patterns;		/* Not counting the terminating entry. */
+  int num_patvals;
+  int num_attributes;
+  int num_states;		/* Zero if the database has no DFA. */
+  int num_indexes;
+  int names_size;
+
+  unsigned int patterns_offset;
+  unsigned int patvals_offset;
+  unsigned int attributes_offset;
+  unsigned int states_offset;
+  unsigned int indexes_offset;
+  unsigned int names_offset;
+};
+
+/* A pattern, see struct pattern in patterns.h. Pointers are replaced
+ * by indices into the sections of the chunk, or -1 for NULL.
+ */
+struct patfile_pattern {
+  int patn;			/* First element in the patval section. */
+  int patlen;
+  int trfno;
+  int name;			/* Offset into the names section. */
+  int mini, minj;
+  int maxi, maxj;
+  int height, width;
+  unsigned int edge_constraints;
+  int move_offset;
+  unsigned int and_mask[8];
+  unsigned int val_mask[8];
+  unsigned int class;
+  float value;
+  int attributes;		/* First attribute, or -1. */
+  int autohelper_flag;
+  int helper;			/* Compiled pattern with the helpers, or -1. */
+  int anchored_at_X;
+  float constraint_cost;
+};
+
+/* Layout of a struct patval, used in place. */
+struct patfile_patval {
+  short offset;
+  unsigned char att;
+  unsigned char pad;
+};
+
+struct patfile_attribute {
+  int type;
+  float value;
+  int offset;
+};
+
+/* The DFA sections hold the state_rt_t and attrib_rt_t arrays of
+ * dfa.h as they are, each entry made of 16 bit numbers.
+ */
+#define PATFILE_STATE_SIZE	10
+#define PATFILE_INDEX_SIZE	4
+
+
+#endif /* _PATFILE_H_ */
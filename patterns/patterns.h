@@ -281,6 +281,20 @@ struct pattern_db {
   const int fixed_anchor;
   _CONST_DECL struct pattern *patterns;
   _CONST_DECL struct dfa_rt *pdfa;
+  const unsigned int helper_signature; /* see patfile.h */
+};
+
+
+/* Several DFA databases matched in a single board scan by
+ * matchpat_joint(). Built by `mkpat -J' from the DFAs of the
+ * individual databases.
+ */
+#define MAX_JOINT_DBS 8
+
+struct joint_pattern_db {
+  int num_dbs;
+  struct pattern_db *dbs[MAX_JOINT_DBS];
+  _CONST_DECL struct dfa_rt *pdfa;
 };
 
 
@@ -351,6 +365,8 @@ extern struct pattern_db fusekipat_db;
 extern struct pattern_db handipat_db;
 extern struct pattern_db oracle_db;
 
+extern struct joint_pattern_db owl_shapes_db;
+
 extern struct corner_db joseki_db;
 
 #ifndef CONFIG_DISABLE_MONTE_CARLO
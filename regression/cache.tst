@@ -0,0 +1,46 @@
+# Tests of the reading caches and of the pruning based on them. A
+# cached result must be the same as that of a new search, also after
+# moves far away which change it.
+
+# White can be captured in a ladder until the ladder breaker at P16
+# is played, and again when it is taken back. The ladder is read by
+# the fast ladder code, whose result must not outlive the breaker in
+# the persistent reading cache.
+boardsize 19
+clear_board
+play black C5
+play black C4
+play black E4
+play black D3
+play white D5
+play white D4
+1 attack D4
+#? [1 D6]
+2 defend D4
+#? [1 D6]
+play white P16
+3 attack D4
+#? [0]
+4 defend D4
+#? [1 D6]
+undo
+5 attack D4
+#? [1 D6]
+
+# The connection of C4 and E4 depends on the same ladder.
+6 connect C4 E4
+#? [1 D6]
+play white P16
+7 connect C4 E4
+#? [1 E3]
+8 disconnect C4 E4
+#? [1 E3]
+
+# The refutation of an attack on the E7 dragon ends in a fast
+# defense at J8. Moves next to it must not be pruned from the owl
+# reading as irrelevant (see also 9x9.tst 590).
+loadsgf games/kgs/tournament8/firstgo-GNU.sgf 19
+9 owl_attack E7
+#? [0]
+10 dragon_status E7
+#? [alive]
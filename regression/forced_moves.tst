@@ -0,0 +1,70 @@
+# Tests of the forced moves which --forced-moves answers without the
+# full move generation. Run with --forced-moves.
+
+# White's last move left four stones in atari, but they cannot escape,
+# so the capture is not forced. F4 also captures them.
+boardsize 9
+clear_board
+play black A5
+play black B5
+play black C5
+play black D5
+play black E5
+play black A3
+play black B3
+play black C3
+play black D3
+play black E3
+play white A4
+play white B4
+play white C4
+play white D4
+1 reg_genmove black
+#? [F4]
+
+# White's last move put six black stones into atari, but is in atari
+# itself.
+clear_board
+play black A1
+play black A2
+play black B2
+play black C2
+play black D2
+play black E2
+play white A3
+play white B3
+play white C3
+play white D3
+play white E3
+play white B1
+play white C1
+play white D1
+play white E1
+2 reg_genmove black
+#? [F1]
+
+# Both sides are unconditionally alive and there is nothing left to
+# play for.
+loadsgf games/forced_moves1.sgf
+3 reg_genmove black
+#? [PASS]
+4 reg_genmove white
+#? [PASS]
+
+# The same four stones in atari, but now they can escape at E4.
+boardsize 9
+clear_board
+play black A5
+play black B5
+play black C5
+play black D5
+play black A3
+play black B3
+play black C3
+play black D3
+play white A4
+play white B4
+play white C4
+play white D4
+5 reg_genmove black
+#? [E4]
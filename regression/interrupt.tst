@@ -0,0 +1,39 @@
+# Tests of interrupted move generation. An interrupted command fails,
+# leaves the board unchanged and must not change the answers of the
+# commands after it. The interrupts are raised with interrupt_after.
+
+loadsgf games/strategy11.sgf 87
+1 reg_genmove black
+#? [A5]
+
+# Interrupted at the first trial move.
+interrupt_after 0
+2 reg_genmove black
+#? [interrupted]
+3 reg_genmove black
+#? [A5]
+
+# Interrupted in the middle of the search.
+interrupt_after 10
+4 genmove black
+#? [interrupted]
+5 last_move
+#? [white G2]
+6 reg_genmove black
+#? [A5]
+interrupt_after 50
+7 kgs-genmove_cleanup black
+#? [interrupted]
+8 last_move
+#? [white G2]
+9 genmove black
+#? [A5]
+10 last_move
+#? [black A5]
+
+# The interrupt is only for the next command.
+interrupt_after 100000
+11 reg_genmove white
+#? [J4]
+12 reg_genmove white
+#? [J4]
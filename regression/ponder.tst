@@ -0,0 +1,63 @@
+# Tests of pondering, see the ponder command. When the opponent plays
+# a predicted move, genmove must give the same answer as without
+# pondering.
+
+# Black prepares answers to White's likely moves.
+loadsgf games/strategy1.sgf
+1 ponder white 4
+#? [Q13 R13 L3]
+play white Q13
+2 genmove black
+#? [R15]
+3 genmove_trace
+#? [black R15 at move 2, .*, pondered]
+
+# The same without the prepared answer.
+undo
+4 ponder white 0
+#? []
+5 genmove black
+#? [R15]
+6 genmove_trace
+#? [!.*pondered]
+
+# Pondering interrupted before any answer has been prepared.
+loadsgf games/strategy1.sgf
+interrupt_after 0
+7 ponder white 4
+#? []
+play white Q13
+8 genmove black
+#? [R15]
+9 genmove_trace
+#? [!.*pondered]
+
+# White plays a move which was not predicted.
+loadsgf games/strategy1.sgf
+10 ponder white 4
+#? [Q13 R13 L3]
+play white C3
+11 genmove black
+#? [R13]
+12 genmove_trace
+#? [!.*pondered]
+
+# The prepared answer is for genmove. kgs-genmove_cleanup must not use
+# it, since it also removes the dead stones.
+loadsgf games/9x9-2.sgf
+13 ponder white 4
+#? [C4]
+play white C4
+14 kgs-genmove_cleanup black
+#? [C9]
+15 genmove_trace
+#? [!.*pondered]
+undo
+undo
+16 ponder white 4
+#? [C4]
+play white C4
+17 genmove black
+#? [PASS]
+18 genmove_trace
+#? [black PASS at move .*, pondered]
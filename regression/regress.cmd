@@ -16,7 +16,7 @@ rem     ..\interface\gnugo.exe
 
 rem The 5 test batches, based on the main gnugo tests, regress/Makefile*
 rem XXX Need to track the main regress/Makefile for changes to these lists!
-set b1=reading owl ld_owl optics filllib atari_atari connection break_in blunder unconditional trevora nngs1 strategy 
+set b1=reading owl ld_owl optics filllib atari_atari connection break_in blunder unconditional trevora nngs1 strategy cache interrupt ponder 
 set b2=endgame heikki neurogo arb rosebud golife arion viking ego dniwog lazarus trevorb strategy2 
 set b3=nicklas1 nicklas2 nicklas3 nicklas4 nicklas5 manyfaces niki trevor tactics buzco nngs trevorc strategy3 
 set b4=capture connect global vie arend 13x13 semeai STS-RV_0 STS-RV_1 STS-RV_e STS-RV_Misc trevord strategy4 
@@ -34,6 +34,7 @@ if not exist %gnugo% goto done
 
 rem Finally, do the actual testing.
 for %%t in (%b1%) do %gnugo% --quiet --mode gtp < %%t.tst | awk -f regress.awk tst=%%t.tst
+%gnugo% --quiet --forced-moves --mode gtp < forced_moves.tst | awk -f regress.awk tst=forced_moves.tst
 for %%t in (%b2%) do %gnugo% --quiet --mode gtp < %%t.tst | awk -f regress.awk tst=%%t.tst
 for %%t in (%b3%) do %gnugo% --quiet --mode gtp < %%t.tst | awk -f regress.awk tst=%%t.tst
 for %%t in (%b4%) do %gnugo% --quiet --mode gtp < %%t.tst | awk -f regress.awk tst=%%t.tst
@@ -0,0 +1,137 @@
+#! /usr/bin/env python3
+
+# # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # #
+# This program is distributed with GNU Go, a Go program.        #
+#                                                               #
+# Write gnugo@gnu.org or see http://www.gnu.org/software/gnugo/ #
+# for more information.                                         #
+#                                                               #
+# Copyright 1999, 2000, 2001, 2002, 2003, 2004, 2005, 2006,     #
+# 2007, 2008 and 2009 by the Free Software Foundation.          #
+#                                                               #
+# This program is free software; you can redistribute it and/or #
+# modify it under the terms of the GNU General Public License   #
+# as published by the Free Software Foundation - version 3      #
+# or (at your option) any later version.                        #
+#                                                               #
+# This program is distributed in the hope that it will be       #
+# useful, but WITHOUT ANY WARRANTY; without even the implied    #
+# warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR       #
+# PURPOSE.  See the GNU General Public License in file COPYING  #
+# for more details.                                             #
+#                                                               #
+# You should have received a copy of the GNU General Public     #
+# License along with this program; if not, write to the Free    #
+# Software Foundation, Inc., 51 Franklin Street, Fifth Floor,   #
+# Boston, MA 02111, USA.                                        #
+# # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # #
+
+# sessions.py GNUGO TSTFILE [OPTIONS ...]
+#
+# Run a test suite through concurrent GTP sessions: start GNUGO with
+# --gtp-listen and --gtp-sessions, and let several clients send the
+# commands of TSTFILE at the same time. Each session must give the
+# same responses. These are written to stdout, for regress.awk:
+#
+#   ./sessions.py ../interface/gnugo reading.tst \
+#     | awk -f regress.awk tst=reading.tst
+
+import re
+import socket
+import subprocess
+import sys
+import threading
+import time
+
+SESSIONS = 2
+TIMEOUT = 600
+
+
+def free_port():
+    s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    s.bind(("127.0.0.1", 0))
+    port = s.getsockname()[1]
+    s.close()
+    return port
+
+
+def connect(server, port):
+    """Connect to the server once it listens, or return None if it has
+    exited."""
+    deadline = time.time() + 30
+    while server.poll() is None and time.time() < deadline:
+        try:
+            return socket.create_connection(("127.0.0.1", port))
+        except socket.error:
+            time.sleep(0.1)
+    return None
+
+
+def run_client(server, port, commands, responses, k):
+    s = connect(server, port)
+    if s is None:
+        return
+    s.settimeout(TIMEOUT)
+    s.sendall(commands)
+    s.shutdown(socket.SHUT_WR)
+    data = []
+    while True:
+        chunk = s.recv(65536)
+        if not chunk:
+            break
+        data.append(chunk)
+    s.close()
+    responses[k] = b"".join(data)
+
+
+def results(response):
+    """The first lines of the numbered responses, as regress.awk sees
+    them. The rest may contain timings."""
+    return [line for line in response.splitlines()
+            if re.match(br"[=?][0-9]+ ", line)]
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.stderr.write("usage: sessions.py GNUGO TSTFILE [OPTIONS ...]\n")
+        return 2
+
+    gnugo, tstfile = sys.argv[1:3]
+    options = sys.argv[3:]
+    commands = open(tstfile, "rb").read()
+    port = free_port()
+
+    server = subprocess.Popen([gnugo, "--quiet"] + options
+                              + ["--mode", "gtp",
+                                 "--gtp-listen", "127.0.0.1:%d" % port,
+                                 "--gtp-sessions", str(SESSIONS),
+                                 "--gtp-clients", str(SESSIONS)])
+    responses = [None] * SESSIONS
+    clients = [threading.Thread(target=run_client,
+                                args=(server, port, commands, responses, k))
+               for k in range(SESSIONS)]
+    try:
+        for client in clients:
+            client.start()
+        for client in clients:
+            client.join()
+        server.wait()
+    finally:
+        if server.poll() is None:
+            server.kill()
+
+    if None in responses:
+        sys.stderr.write("%s: a session failed\n" % tstfile)
+        return 1
+
+    sys.stdout.write(responses[0].decode("latin-1"))
+    for k in range(1, SESSIONS):
+        if results(responses[k]) != results(responses[0]):
+            sys.stderr.write("%s: session %d differs from session 1\n"
+                             % (tstfile, k + 1))
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
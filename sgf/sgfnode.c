@@ -59,13 +59,14 @@
 /* ================================================================ */
 
 /*
- * Utility: a checking, initializing malloc
+ * Utility: a checking, initializing malloc. Memory for sgf trees
+ * comes from its own pool (see utils/mempool.c).
  */
 
 void *
 xalloc(unsigned int size)
 {
-  void *pt = malloc(size);
+  void *pt = pool_malloc(POOL_SGF, size);
 
   if (!pt) {
     fprintf(stderr, "xalloc: Out of memory!\n");
@@ -79,7 +80,7 @@ xalloc(unsigned int size)
 void *
 xrealloc(void *pt, unsigned int size)
 {
-  void *ptnew = realloc(pt, size);
+  void *ptnew = pool_realloc(POOL_SGF, pt, size);
 
   if (!ptnew) {
     fprintf(stderr, "xrealloc: Out of memory!\n");
@@ -101,12 +102,14 @@ xrealloc(void *pt, unsigned int size)
 SGFNode *
 sgfNewNode()
 {
+  static unsigned int serial = 0;
   SGFNode *newnode;
   newnode = xalloc(sizeof(SGFNode));
   newnode->next = NULL;
   newnode->props = NULL;
   newnode->parent = NULL;
   newnode->child = NULL;
+  newnode->serial = ++serial;
   return newnode;
 }
 
@@ -122,7 +125,7 @@ sgfFreeNode(SGFNode *node)
   sgfFreeNode(node->next);
   sgfFreeNode(node->child);
   sgfFreeProperty(node->props);
-  free(node);
+  pool_free(node);
 }
 
 
@@ -452,8 +455,8 @@ sgfFreeProperty(SGFProperty *prop)
   if (prop == NULL)
     return;
   sgfFreeProperty(prop->next);
-  free(prop->value);
-  free(prop);
+  pool_free(prop->value);
+  pool_free(prop);
 }
 
 
@@ -570,7 +573,7 @@ sgfBoardText(SGFNode *node, int i, int j, const char *text)
 
   sprintf(str, "%c%c:%s", j+'a', i+'a', text);
   sgfAddProperty(node, "LB", str);
-  free(str);
+  pool_free(str);
 
   return node;
 }
@@ -1536,6 +1539,121 @@ writesgf(SGFNode *root, const char *filename)
   return 1;
 }
 
+
+/* ================================================================ */
+/*                  Incremental writing                             */
+/* ================================================================ */
+
+/* An SGFWriter writes the main line of a game to a file as it grows.
+ * Each call to sgfwriter_sync() only appends the nodes added since the
+ * last call, instead of writing the whole game again like writesgf_fd().
+ * If moves have been taken back, the output is truncated to the nodes
+ * which are still in the game before the new ones are appended. Nodes
+ * are told apart by their serial number, since a node created after
+ * an undo may get the memory of a freed one.
+ * sgfwriter_finalize() completes the game record; further nodes may be
+ * added afterwards.
+ *
+ * Properties added to a node after it has been written are not seen.
+ * Variations are not written.
+ *
+ * The file must support seeking, typically it is a memory stream. The
+ * writer doesn't open or close it.
+ */
+
+void
+sgfwriter_init(SGFWriter *writer, FILE *file)
+{
+  writer->file = file;
+  writer->nodes = NULL;
+  writer->num_nodes = 0;
+  writer->max_nodes = 0;
+  writer->finalized = 0;
+}
+
+
+void
+sgfwriter_clear(SGFWriter *writer)
+{
+  pool_free(writer->nodes);
+  sgfwriter_init(writer, NULL);
+}
+
+
+/* Keep only the first num_nodes nodes of the output. */
+void
+sgfwriter_truncate(SGFWriter *writer, int num_nodes)
+{
+  if (num_nodes < writer->num_nodes)
+    writer->num_nodes = num_nodes;
+  if (writer->num_nodes == 0)
+    fseek(writer->file, 0, SEEK_SET);
+  else
+    fseek(writer->file, writer->nodes[writer->num_nodes - 1].end, SEEK_SET);
+  writer->finalized = 0;
+}
+
+
+/* Write the main line of the game at root, reusing the output for the
+ * nodes which are unchanged since the last call.
+ */
+int
+sgfwriter_sync(SGFWriter *writer, SGFNode *root)
+{
+  SGFNode *node = root;
+  int k = 0;
+
+  while (node && k < writer->num_nodes && writer->nodes[k].node == node
+	 && writer->nodes[k].serial == node->serial) {
+    node = node->child;
+    k++;
+  }
+  if (k < writer->num_nodes || writer->finalized)
+    sgfwriter_truncate(writer, k);
+
+  for (; node; node = node->child, k++) {
+    if (k == writer->max_nodes) {
+      writer->max_nodes = 2 * writer->max_nodes + 16;
+      writer->nodes = xrealloc(writer->nodes,
+			       writer->max_nodes * sizeof(writer->nodes[0]));
+    }
+
+    if (k == 0) {
+      sgf_write_header_reduced(root, 0);
+      sgf_column = 0;
+      sgf_putc('(', writer->file);
+      unparse_root(writer->file, root);
+    }
+    else {
+      sgf_column = writer->nodes[k - 1].column;
+      unparse_node(writer->file, node);
+    }
+    restore_property(node->props);
+
+    writer->nodes[k].node = node;
+    writer->nodes[k].serial = node->serial;
+    writer->nodes[k].end = ftell(writer->file);
+    writer->nodes[k].column = sgf_column;
+    writer->num_nodes = k + 1;
+  }
+
+  return !ferror(writer->file);
+}
+
+
+/* Close the game record. The output is complete after this call. */
+int
+sgfwriter_finalize(SGFWriter *writer)
+{
+  if (!writer->finalized && writer->num_nodes > 0) {
+    fputs(")\n", writer->file);
+    writer->finalized = 1;
+  }
+  fflush(writer->file);
+  return !ferror(writer->file);
+}
+
+
 #ifdef TEST_SGFPARSER
 int
 main()
@@ -64,6 +64,7 @@ typedef struct SGFNode_t {
   struct SGFNode_t *parent;
   struct SGFNode_t *child;
   struct SGFNode_t *next;
+  unsigned int serial;  /* tells apart nodes at the same address */
 } SGFNode;
 
 
@@ -120,6 +121,26 @@ SGFNode *readsgffilefuseki(const char *filename, int moves_per_game);
 int writesgf_fd(SGFNode *root, FILE* fd);
 int writesgf(SGFNode *root, const char *filename);
 
+/* Write the main line of a game incrementally. */
+typedef struct SGFWriter_t {
+  FILE *file;
+  struct {
+    SGFNode *node;
+    unsigned int serial;
+    long end;         /* file position after the node */
+    int column;       /* output column after the node */
+  } *nodes;
+  int num_nodes;
+  int max_nodes;
+  int finalized;
+} SGFWriter;
+
+void sgfwriter_init(SGFWriter *writer, FILE *file);
+void sgfwriter_clear(SGFWriter *writer);
+int sgfwriter_sync(SGFWriter *writer, SGFNode *root);
+void sgfwriter_truncate(SGFWriter *writer, int num_nodes);
+int sgfwriter_finalize(SGFWriter *writer);
+
 
 /* ---------------------------------------------------------------- */
 /* ---                          SGFTree                         --- */
@@ -0,0 +1,135 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ * This is GNU Go, a Go program. Contact gnugo@gnu.org, or see       *
+ * http://www.gnu.org/software/gnugo/ for more information.          *
+ *                                                                   *
+ * Copyright 1999, 2000, 2001, 2002, 2003, 2004, 2005, 2006, 2007,   *
+ * 2008 and 2009 by the Free Software Foundation.                    *
+ *                                                                   *
+ * This program is free software; you can redistribute it and/or     *
+ * modify it under the terms of the GNU General Public License as    *
+ * published by the Free Software Foundation - version 3 or          *
+ * (at your option) any later version.                               *
+ *                                                                   *
+ * This program is distributed in the hope that it will be useful,   *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of    *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the     *
+ * GNU General Public License in file COPYING for more details.      *
+ *                                                                   *
+ * You should have received a copy of the GNU General Public         *
+ * License along with this program; if not, write to the Free        *
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,       *
+ * Boston, MA 02111, USA.                                            *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Test of the incremental game record writer. After every change of
+ * the game the output of sgfwriter_sync() must be the same as that of
+ * writesgf_fd() for the whole game, also when moves are taken back
+ * and the nodes of the new moves reuse the memory of the old ones.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sgftree.h"
+
+static SGFTree tree;
+static SGFWriter writer;
+static int failures = 0;
+
+
+/* Read the first length bytes of file into buffer. */
+static int
+read_output(FILE *file, long length, char *buffer, int size)
+{
+  if (length >= size)
+    return 0;
+  fflush(file);
+  if (fseek(file, 0, SEEK_SET) != 0
+      || fread(buffer, 1, length, file) != (size_t) length)
+    return 0;
+  buffer[length] = 0;
+  return 1;
+}
+
+
+/* Compare the output of the writer with the whole game written anew. */
+static void
+check_output(const char *step)
+{
+  static char expected[10000];
+  static char written[10000];
+  FILE *file = tmpfile();
+  long length;
+
+  sgfwriter_sync(&writer, tree.root);
+  sgfwriter_finalize(&writer);
+  length = ftell(writer.file);
+
+  writesgf_fd(tree.root, file);
+  if (!read_output(file, ftell(file), expected, sizeof(expected))
+      || !read_output(writer.file, length, written, sizeof(written))
+      || strcmp(expected, written) != 0) {
+    fprintf(stderr, "%s: got\n%s\nexpected\n%s\n", step, written, expected);
+    failures++;
+  }
+  fseek(writer.file, length, SEEK_SET);
+  fclose(file);
+}
+
+
+/* Take back the last move, as a game record does on undo. */
+static void
+undo_last_move(void)
+{
+  SGFNode *last = tree.lastnode;
+
+  tree.lastnode = last->parent;
+  tree.lastnode->child = NULL;
+  sgfFreeNode(last);
+}
+
+
+int
+main(void)
+{
+  sgftree_clear(&tree);
+  sgftreeCreateHeaderNode(&tree, 19, 6.5, 0);
+  sgfwriter_init(&writer, tmpfile());
+
+  sgftreeAddPlay(&tree, BLACK, 3, 3);
+  sgftreeAddPlay(&tree, WHITE, 15, 15);
+  check_output("two moves");
+
+  sgftreeAddPlay(&tree, BLACK, 3, 15);
+  sgftreeAddComment(&tree, "a comment");
+  check_output("three moves");
+
+  undo_last_move();
+  sgftreeAddPlay(&tree, BLACK, 15, 3);
+  check_output("undo and new move");
+
+  undo_last_move();
+  undo_last_move();
+  sgftreeAddPlay(&tree, WHITE, 16, 16);
+  sgftreeAddPlay(&tree, BLACK, 2, 16);
+  check_output("two undos and new moves");
+
+  undo_last_move();
+  check_output("undo only");
+
+  sgfFreeNode(tree.root);
+  sgfwriter_clear(&writer);
+
+  if (failures > 0)
+    return EXIT_FAILURE;
+  return EXIT_SUCCESS;
+}
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * c-basic-offset: 2
+ * End:
+ */
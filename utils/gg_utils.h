@@ -25,6 +25,8 @@
 #define _GG_UTILS_H_
 
 #include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
 
 #ifdef HAVE_CONFIG_H
 #include <config.h>
@@ -92,6 +94,35 @@ void set_random_seed(unsigned int seed);
 unsigned int get_random_seed(void);
 void reuse_random_seed(void);
 
+/* Memory pools (mempool.c). With CONFIG_FIXED_MEMORY all engine and
+ * sgf allocations come from pools carved out of a single budget at
+ * startup. Otherwise the pool functions are plain malloc() and free().
+ */
+enum mempool_id {
+  POOL_READING_CACHE,
+  POOL_OWL,
+  POOL_ENGINE,
+  POOL_MONTE_CARLO,
+  POOL_SGF,
+  NUM_MEMPOOLS
+};
+
+#ifdef CONFIG_FIXED_MEMORY
+void mempool_init(void *memory, size_t size);
+size_t mempool_largest_block(int pool);
+void mempool_report(FILE *outfile);
+size_t mempool_peak(void);
+void *pool_malloc(int pool, size_t size);
+void *pool_calloc(int pool, size_t num, size_t size);
+void *pool_realloc(int pool, void *ptr, size_t size);
+void pool_free(void *ptr);
+#else
+#define pool_malloc(pool, size) malloc(size)
+#define pool_calloc(pool, num, size) calloc(num, size)
+#define pool_realloc(pool, ptr, size) realloc(ptr, size)
+#define pool_free(ptr) free(ptr)
+#endif
+
 
 #endif /* _GG_UTILS_H_ */
 
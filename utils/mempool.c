@@ -0,0 +1,362 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ * This is GNU Go, a Go program. Contact gnugo@gnu.org, or see       *
+ * http://www.gnu.org/software/gnugo/ for more information.          *
+ *                                                                   *
+ * Copyright 1999, 2000, 2001, 2002, 2003, 2004, 2005, 2006, 2007,   *
+ * 2008 and 2009  by the Free Software Foundation.                   *
+ *                                                                   *
+ * This program is free software; you can redistribute it and/or     *
+ * modify it under the terms of the GNU General Public License as    *
+ * published by the Free Software Foundation - version 3 or          *
+ * (at your option) any later version.                               *
+ *                                                                   *
+ * This program is distributed in the hope that it will be useful,   *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of    *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the     *
+ * GNU General Public License in file COPYING for more details.      *
+ *                                                                   *
+ * You should have received a copy of the GNU General Public         *
+ * License along with this program; if not, write to the Free        *
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,       *
+ * Boston, MA 02111, USA.                                            *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Memory pools of fixed capacity.
+ *
+ * On embedded targets a long game slowly fragments the heap, until
+ * some allocation fails. With CONFIG_FIXED_MEMORY the engine instead
+ * takes a single block of memory at startup and divides it into one
+ * pool per subsystem. The transposition table gets whatever is left
+ * over by the others.
+ *
+ * Small blocks are rounded up to a power of two and freed blocks are
+ * kept on a free list per size, so they are reused by the next
+ * allocation of that size. Large blocks, which are few and mostly of
+ * the same sizes again and again, are reused by best fit. Blocks are
+ * never split or merged, so an allocation takes bounded time and a
+ * pool which has once held a working set holds it again.
+ *
+ * A pool which runs out returns NULL, like malloc(), and counts the
+ * failure. mempool_report() shows how much of each pool has been
+ * needed, to help choosing the budget.
+ *
+ * Until mempool_init() is called blocks come from malloc(), so that
+ * the pattern compilers and other tools which never initialize the
+ * engine work as before.
+ */
+
+#include "gg_utils.h"
+
+#include <string.h>
+
+#ifdef CONFIG_FIXED_MEMORY
+
+/* Blocks up to 2^MEMPOOL_MAX_SMALL_CLASS bytes, including the header,
+ * are small.
+ */
+#define MEMPOOL_MIN_SMALL_CLASS  4
+#define MEMPOOL_MAX_SMALL_CLASS 16
+#define MEMPOOL_ALIGN(size)	(((size) + 7) & ~((size_t) 7))
+
+/* The pool of a block from malloc(). */
+#define NO_MEMPOOL -1
+
+/* The share of the budget in percent for each pool. The reading
+ * cache takes the rest.
+ */
+static const struct {
+  const char *name;
+  int percent;
+} pool_shares[NUM_MEMPOOLS] = {
+  {"reading cache", 0},
+  {"owl",           35},
+  {"engine",        10},
+#ifdef CONFIG_DISABLE_MONTE_CARLO
+  {"monte carlo",    0},
+#else
+  {"monte carlo",   10},
+#endif
+  {"sgf",            5}
+};
+
+/* Every block starts with a header. */
+union mempool_header {
+  struct {
+    size_t size;	/* Size of the block, including the header. */
+    int pool;
+    union mempool_header *next_free;
+  } info;
+  double align;
+};
+
+struct mempool {
+  char *base;
+  size_t size;
+  size_t top;		/* Memory above top has never been used. */
+  size_t in_use;
+  size_t high_water;
+  int failures;
+  union mempool_header *free_small[MEMPOOL_MAX_SMALL_CLASS + 1];
+  union mempool_header *free_large;
+};
+
+static struct mempool pools[NUM_MEMPOOLS];
+static int mempools_initialized = 0;
+
+
+/* Divide the given memory, or a block of the given size obtained from
+ * malloc() if memory is NULL, into the pools. Calls after the first
+ * do nothing, the budget is fixed once it has been set.
+ */
+void
+mempool_init(void *memory, size_t size)
+{
+  char *base = memory;
+  size_t offset = 0;
+  size_t rest = size;
+  int k;
+
+  if (mempools_initialized)
+    return;
+
+  if (base == NULL) {
+    base = malloc(size);
+    if (base == NULL) {
+      fprintf(stderr, "mempool_init: cannot allocate %lu bytes\n",
+	      (unsigned long) size);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  for (k = 0; k < NUM_MEMPOOLS; k++) {
+    size_t pool_size = MEMPOOL_ALIGN(size / 100 * pool_shares[k].percent);
+    if (k != POOL_READING_CACHE)
+      rest -= pool_size;
+    pools[k].size = pool_size;
+  }
+  pools[POOL_READING_CACHE].size = rest & ~((size_t) 7);
+
+  for (k = 0; k < NUM_MEMPOOLS; k++) {
+    pools[k].base = base + offset;
+    offset += pools[k].size;
+  }
+
+  mempools_initialized = 1;
+}
+
+
+/* The largest block that can be allocated from the pool right now. */
+size_t
+mempool_largest_block(int pool)
+{
+  struct mempool *p = &pools[pool];
+  size_t largest = p->size - p->top;
+  union mempool_header *block;
+
+  for (block = p->free_large; block; block = block->info.next_free)
+    if (block->info.size > largest)
+      largest = block->info.size;
+
+  if (largest <= sizeof(union mempool_header))
+    return 0;
+  return largest - sizeof(union mempool_header);
+}
+
+
+/* Print the size, the high-water mark and the number of failed
+ * allocations of each pool.
+ */
+void
+mempool_report(FILE *outfile)
+{
+  int k;
+
+  fprintf(outfile, "%-14s %10s %10s %10s %8s\n",
+	  "pool", "size", "in use", "peak", "failed");
+  for (k = 0; k < NUM_MEMPOOLS; k++)
+    fprintf(outfile, "%-14s %10lu %10lu %10lu %8d\n",
+	    pool_shares[k].name, (unsigned long) pools[k].size,
+	    (unsigned long) pools[k].in_use,
+	    (unsigned long) pools[k].high_water, pools[k].failures);
+}
+
+
+/* The sum of the high-water marks of the pools. */
+size_t
+mempool_peak(void)
+{
+  size_t peak = 0;
+  int k;
+
+  for (k = 0; k < NUM_MEMPOOLS; k++)
+    peak += pools[k].high_water;
+  return peak;
+}
+
+
+/* The size class of a small block, or -1 for a large block. */
+static int
+size_class(size_t size)
+{
+  int k;
+
+  for (k = MEMPOOL_MIN_SMALL_CLASS; k <= MEMPOOL_MAX_SMALL_CLASS; k++)
+    if (size <= ((size_t) 1 << k))
+      return k;
+
+  return -1;
+}
+
+
+void *
+pool_malloc(int pool, size_t size)
+{
+  struct mempool *p = &pools[pool];
+  union mempool_header *block = NULL;
+  size_t block_size = MEMPOOL_ALIGN(size + sizeof(union mempool_header));
+  int k = size_class(block_size);
+
+  if (!mempools_initialized) {
+    block = malloc(block_size);
+    if (!block)
+      return NULL;
+    block->info.size = block_size;
+    block->info.pool = NO_MEMPOOL;
+    return block + 1;
+  }
+
+  if (k >= 0) {
+    block_size = (size_t) 1 << k;
+    if (p->free_small[k]) {
+      block = p->free_small[k];
+      p->free_small[k] = block->info.next_free;
+    }
+  }
+  else {
+    /* Best fit among the free large blocks. */
+    union mempool_header **best = NULL;
+    union mempool_header **link;
+
+    for (link = &p->free_large; *link; link = &(*link)->info.next_free)
+      if ((*link)->info.size >= block_size
+	  && (!best || (*link)->info.size < (*best)->info.size))
+	best = link;
+
+    if (best) {
+      block = *best;
+      *best = block->info.next_free;
+      block_size = block->info.size;
+    }
+  }
+
+  if (!block) {
+    if (block_size > p->size - p->top) {
+      p->failures++;
+      return NULL;
+    }
+    block = (union mempool_header *) (p->base + p->top);
+    p->top += block_size;
+  }
+
+  block->info.size = block_size;
+  block->info.pool = pool;
+  block->info.next_free = NULL;
+
+  p->in_use += block_size;
+  if (p->in_use > p->high_water)
+    p->high_water = p->in_use;
+
+  return block + 1;
+}
+
+
+void *
+pool_calloc(int pool, size_t num, size_t size)
+{
+  void *ptr = pool_malloc(pool, num * size);
+
+  if (ptr)
+    memset(ptr, 0, num * size);
+  return ptr;
+}
+
+
+void *
+pool_realloc(int pool, void *ptr, size_t size)
+{
+  union mempool_header *block;
+  void *new_ptr;
+  size_t old_size;
+
+  if (!ptr)
+    return pool_malloc(pool, size);
+
+  block = (union mempool_header *) ptr - 1;
+  old_size = block->info.size - sizeof(union mempool_header);
+  if (size <= old_size)
+    return ptr;
+
+  /* Blocks from before the pools were set up stay on the heap. */
+  if (block->info.pool == NO_MEMPOOL) {
+    size_t block_size = MEMPOOL_ALIGN(size + sizeof(union mempool_header));
+    block = realloc(block, block_size);
+    if (!block)
+      return NULL;
+    block->info.size = block_size;
+    return block + 1;
+  }
+
+  new_ptr = pool_malloc(block->info.pool, size);
+  if (new_ptr) {
+    memcpy(new_ptr, ptr, old_size);
+    pool_free(ptr);
+  }
+  return new_ptr;
+}
+
+
+void
+pool_free(void *ptr)
+{
+  union mempool_header *block;
+  struct mempool *p;
+  int k;
+
+  if (!ptr)
+    return;
+
+  block = (union mempool_header *) ptr - 1;
+  if (block->info.pool == NO_MEMPOOL) {
+    free(block);
+    return;
+  }
+
+  p = &pools[block->info.pool];
+  p->in_use -= block->info.size;
+
+  /* The topmost block goes back to the unused memory. */
+  if ((char *) block + block->info.size == p->base + p->top) {
+    p->top -= block->info.size;
+    return;
+  }
+
+  k = size_class(block->info.size);
+  if (k >= 0) {
+    block->info.next_free = p->free_small[k];
+    p->free_small[k] = block;
+  }
+  else {
+    block->info.next_free = p->free_large;
+    p->free_large = block;
+  }
+}
+
+#endif	/* CONFIG_FIXED_MEMORY */
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * c-basic-offset: 2
+ * End:
+ */